@@ -22,6 +22,7 @@
 */
 
 #include "csoundCore.h"     /*                              CORFILES.C      */
+#include "corfile.h"
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
@@ -243,6 +244,103 @@ void corfile_preputs(const char *s, CORFIL *f)
     free(body);
 }
 
+static void *scorebin_grow(void *p, int *size, int need, int elsize)
+{
+    if (need > *size) {
+      *size = (need > 2 * *size ? need : 2 * *size);
+      p = realloc(p, (size_t) *size * elsize);
+      if (p == NULL) {
+        fprintf(stderr, "Out of Memory\n");
+        exit(7);
+      }
+    }
+    return p;
+}
+
+SCOREBIN *scorebin_create(void)
+{
+    SCOREBIN *ans = (SCOREBIN*) calloc(1, sizeof(SCOREBIN));
+    ans->size = 4096;
+    ans->body = (char*) malloc(ans->size);
+    ans->valsize = 16;
+    ans->vals = (MYFLT*) malloc(ans->valsize * sizeof(MYFLT));
+    ans->strsize = 256;
+    ans->strs = (char*) malloc(ans->strsize);
+    return ans;
+}
+
+void scorebin_begin(SCOREBIN *b, int opcod)
+{
+    b->opcod = opcod;
+    b->nvals = b->slen = b->nstrs = 0;
+}
+
+void scorebin_flt(SCOREBIN *b, MYFLT x)
+{
+    b->vals = scorebin_grow(b->vals, &b->valsize, b->nvals + 1, sizeof(MYFLT));
+    b->vals[b->nvals++] = x;
+}
+
+/* a string p-field, coded as rdscor() codes quoted strings */
+void scorebin_str(SCOREBIN *b, const char *s, int n)
+{
+    union {
+      MYFLT d;
+      int32 i;
+    } ch;
+    b->strs = scorebin_grow(b->strs, &b->strsize, b->slen + n + 1, 1);
+    memcpy(b->strs + b->slen, s, n);
+    b->slen += n;
+    b->strs[b->slen++] = '\0';
+    ch.d = SSTRCOD; ch.i += b->nstrs++;
+    scorebin_flt(b, ch.d);
+}
+
+void scorebin_end(SCOREBIN *b)
+{
+    SCOREBIN_REC r;
+    size_t  n = SCOREBIN_HDRSIZE + b->nvals * sizeof(MYFLT);
+
+    r.size = (int32) SCOREBIN_ALIGN(n + b->slen);
+    r.nvals = b->nvals;
+    r.slen = b->slen;
+    r.nstrs = (int16) b->nstrs;
+    r.opcod = b->opcod;
+    if (b->len + r.size > b->size) {
+      while (b->len + r.size > b->size)
+        b->size *= 2;
+      b->body = (char*) realloc(b->body, b->size);
+      if (b->body == NULL) {
+        fprintf(stderr, "Out of Memory\n");
+        exit(7);
+      }
+    }
+    memset(b->body + b->len, 0, r.size);
+    memcpy(b->body + b->len, &r, sizeof(SCOREBIN_REC));
+    memcpy(b->body + b->len + SCOREBIN_HDRSIZE, b->vals,
+           b->nvals * sizeof(MYFLT));
+    memcpy(b->body + b->len + n, b->strs, b->slen);
+    b->len += r.size;
+}
+
+#undef scorebin_rewind
+void scorebin_rewind(SCOREBIN *b)
+{
+    b->p = 0;
+}
+
+void scorebin_rm(SCOREBIN **bb)
+{
+    SCOREBIN *b = *bb;
+    if (b != NULL) {
+      free(b->body);
+      free(b->vals);
+      free(b->strs);
+      free(b);
+      *bb = NULL;
+    }
+}
+
 #ifdef HAVE_CURL
 
 #include <curl/curl.h>
@@ -99,10 +99,15 @@ static void dag_print_state(CSOUND *csound)
         break;
       case WAITING:
         {
-          char *tt = csound->dag_task_dep[i];
-          int j;
+          DAG_GROUP *g = &csound->dag_groups[csound->dag_task_grp[i]];
+          int j, k;
           printf("status=WAITING for tasks [");
-          for (j=0; j<i; j++) if (tt[j]) printf("%d ", j);
+          for (k=0; k<g->ndeps; k++) {
+            DAG_GROUP *d = &csound->dag_groups[csound->dag_grp_deps[g->deps+k]];
+            for (j=d->first; j<d->last; j++) printf("%d ", j);
+          }
+          if (g->self)
+            for (j=g->first; j<i; j++) printf("%d ", j);
           printf("]\n");
         }
         break;
@@ -120,7 +125,7 @@ void create_dag(CSOUND *csound)
     csound->dag_task_status = csound->Calloc(csound, sizeof(enum state)*max);
     csound->dag_task_watch  = csound->Calloc(csound, sizeof(watchList*)*max);
     csound->dag_task_map    = csound->Calloc(csound, sizeof(INSDS*)*max);
-    csound->dag_task_dep    = (char **)csound->Calloc(csound, sizeof(char*)*max);
+    csound->dag_task_grp    = (int *)csound->Calloc(csound, sizeof(int)*max);
     csound->dag_wlmm = (watchList *)csound->Calloc(csound, sizeof(watchList)*max);
 }
 
@@ -136,12 +141,16 @@ void recreate_dag(CSOUND *csound)
                sizeof(watchList*)*max);
     csound->dag_task_map    =
       csound->ReAlloc(csound, (INSDS *)csound->dag_task_map, sizeof(INSDS*)*max);
-    csound->dag_task_dep    =
-      (char **)csound->ReAlloc(csound, csound->dag_task_dep, sizeof(char*)*max);
+    csound->dag_task_grp    =
+      (int *)csound->ReAlloc(csound, csound->dag_task_grp, sizeof(int)*max);
     csound->dag_wlmm        =
       (watchList *)csound->ReAlloc(csound, csound->dag_wlmm, sizeof(watchList)*max);
 }
 
+void dag_reinit(CSOUND *csound);
+static void dag_ws_seed(CSOUND *csound);
+static void dag_ws_push(CSOUND *csound, int index, taskID t);
+
 static INSTR_SEMANTICS *dag_get_info(CSOUND* csound, int insno)
 {
     INSTR_SEMANTICS *current_instr =
@@ -159,29 +168,60 @@ static INSTR_SEMANTICS *dag_get_info(CSOUND* csound, int insno)
     return current_instr;
 }
 
-static int dag_intersect(CSOUND *csound, struct set_t *current,
-                         struct set_t *later, int cnt)
+static void dag_dep_cache_grow(CSOUND *csound, INSTR_SEMANTICS *s, int id)
 {
-    struct set_t *ans;
-    int res = 0;
-    struct set_element_t *ele;
-    csp_set_intersection(csound, current, later, &ans);
-    res = ans->count;
-    ele = ans->head;
-    while (ele != NULL) {
-      struct set_element_t *next = ele->next;
-      csound->Free(csound, ele);
-      ele = next; res++;
+    int words = id/32+1, old = s->dep_words;
+    if (words <= old) return;
+    words += 4;                 /* room for a few more instruments */
+    s->dep_known = (uint32_t*)csound->ReAlloc(csound, s->dep_known,
+                                              sizeof(uint32_t)*words);
+    s->dep_conflict = (uint32_t*)csound->ReAlloc(csound, s->dep_conflict,
+                                                 sizeof(uint32_t)*words);
+    memset(s->dep_known+old, 0, sizeof(uint32_t)*(words-old));
+    memset(s->dep_conflict+old, 0, sizeof(uint32_t)*(words-old));
+    s->dep_words = words;
+}
+
+/* Does an instance of instrument b have to wait for an earlier instance of
+   a?  The relation is symmetric and only depends on the globals each one
+   reads and writes, so it is worked out once per pair and remembered on
+   both INSTR_SEMANTICS. */
+static int dag_conflict(CSOUND *csound, INSTR_SEMANTICS *a, INSTR_SEMANTICS *b)
+{
+    int ida = a->dep_id, idb = b->dep_id, res;
+    uint32_t bit = 1u<<(idb&31);
+    if (idb/32 < a->dep_words && (a->dep_known[idb/32] & bit)) {
+      return (a->dep_conflict[idb/32] & bit) != 0;
+    }
+    res = (csp_bitset_intersects(&a->write, &b->read)       ||
+           csp_bitset_intersects(&a->read_write, &b->read)  ||
+           csp_bitset_intersects(&a->read, &b->write)       ||
+           csp_bitset_intersects(&a->write, &b->write)      ||
+           csp_bitset_intersects(&a->read_write, &b->write) ||
+           csp_bitset_intersects(&a->read, &b->read_write)  ||
+           csp_bitset_intersects(&a->write, &b->read_write));
+    dag_dep_cache_grow(csound, a, idb);
+    dag_dep_cache_grow(csound, b, ida);
+    a->dep_known[idb/32] |= bit;
+    b->dep_known[ida/32] |= 1u<<(ida&31);
+    if (res) {
+      a->dep_conflict[idb/32] |= bit;
+      b->dep_conflict[ida/32] |= 1u<<(ida&31);
     }
-    csound->Free(csound, ans);
     return res;
 }
 
+/* Make the task list from the active chain.  Consecutive instances of
+   one instrument form a group and dependencies are recorded between
+   groups, so the cost is linear in the number of notes plus quadratic
+   only in the number of distinct active instruments, each pair of which
+   is a cached bit test after its first appearance. */
 void dag_build(CSOUND *csound, INSDS *chain)
 {
     INSDS *save = chain;
     INSDS **task_map;
-    int i;
+    DAG_GROUP *groups;
+    int i, g, h, ng, ndeps;
 
     //printf("DAG BUILD***************************************\n");
     csound->dag_num_active = 0;
@@ -192,77 +232,58 @@ void dag_build(CSOUND *csound, INSDS *chain)
     if (csound->dag_num_active>csound->dag_task_max_size) {
       //printf("**************need to extend task vector\n");
       csound->dag_task_max_size = csound->dag_num_active+INIT_SIZE;
-      recreate_dag(csound);
+      if (csound->dag_task_status != NULL) recreate_dag(csound);
     }
     if (csound->dag_task_status == NULL)
       create_dag(csound); /* Should move elsewhere */
-    else {
-      memset((void*)csound->dag_task_watch, '\0',
-             sizeof(watchList*)*csound->dag_task_max_size);
-      for (i=0; i<csound->dag_task_max_size; i++) {
-        if (csound->dag_task_dep[i]) {
-          csound->dag_task_dep[i]= NULL;
-        }
-        csound->dag_wlmm[i].id = INVALID;
-      }
-    }
-    task_map = csound->dag_task_map;
-    for (i=0; i<csound->dag_num_active; i++) {
-      csound->dag_task_status[i] = AVAILABLE;
-      csound->dag_wlmm[i].id=i;
+    if (csound->dag_groups_max < csound->dag_task_max_size) {
+      csound->dag_groups_max = csound->dag_task_max_size;
+      csound->dag_groups =
+        (DAG_GROUP *)csound->ReAlloc(csound, csound->dag_groups,
+                                     sizeof(DAG_GROUP)*csound->dag_groups_max);
     }
     csound->dag_changed = 0;
     if (UNLIKELY(csound->oparms->odebug))
       printf("dag_num_active = %d\n", csound->dag_num_active);
-    i = 0; chain = save;
-    while (chain != NULL) {     /* for each instance check against later */
-      int j = i+1;              /* count of instance */
-      if (UNLIKELY(csound->oparms->odebug))
-        printf("\nWho depends on %d (instr %d)?\n", i, chain->insno);
-      INSDS *next = chain->nxtact;
-      INSTR_SEMANTICS *current_instr = dag_get_info(csound, chain->insno);
-      //csp_set_print(csound, current_instr->read);
-      //csp_set_print(csound, current_instr->write);
-      while (next) {
-        INSTR_SEMANTICS *later_instr = dag_get_info(csound, next->insno);
-        int cnt = 0;
-        if (UNLIKELY(csound->oparms->odebug)) printf("%d ", j);
-        //csp_set_print(csound, later_instr->read);
-        //csp_set_print(csound, later_instr->write);
-        //csp_set_print(csound, later_instr->read_write);
-        if (dag_intersect(csound, current_instr->write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->read_write, cnt++) ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->read_write, cnt++)) {
-          char *tt = csound->dag_task_dep[j];
-          if (tt==NULL) {
-            /* get dep vector if missing and set watch first time */
-            tt = csound->dag_task_dep[j] =
-              (char*)csound->Calloc(csound, sizeof(char)*(j+1));
-            csound->dag_task_status[j] = WAITING;
-            csound->dag_wlmm[j].next = csound->dag_task_watch[i];
-            csound->dag_wlmm[j].id = j;
-            csound->dag_task_watch[i] = &(csound->dag_wlmm[j]);
-            //printf("set watch %d to %d\n", j, i);
-          }
-          tt[i] = 1;
-          //printf("-yes ");
-        }
-        j++; next = next->nxtact;
+
+    /* split the chain into runs of the same instrument */
+    task_map = csound->dag_task_map;
+    groups = csound->dag_groups;
+    ng = 0;
+    for (i = 0, chain = save; chain != NULL; i++, chain = chain->nxtact) {
+      if (ng == 0 || chain->insno != task_map[i-1]->insno) {
+        groups[ng].first = i;
+        groups[ng].sem = dag_get_info(csound, chain->insno);
+        ng++;
       }
+      groups[ng-1].last = i+1;
+      csound->dag_task_grp[i] = ng-1;
       task_map[i] = chain;
-      i++; chain = chain->nxtact;
     }
+    csound->dag_num_groups = ng;
+
+    /* dependencies between groups, earliest first */
+    ndeps = 0;
+    for (h = 0; h < ng; h++) {
+      if (csound->dag_grp_deps_max < ndeps+h) {
+        csound->dag_grp_deps_max = 2*(ndeps+h)+INIT_SIZE;
+        csound->dag_grp_deps =
+          (int *)csound->ReAlloc(csound, csound->dag_grp_deps,
+                                 sizeof(int)*csound->dag_grp_deps_max);
+      }
+      groups[h].deps = ndeps;
+      for (g = 0; g < h; g++)
+        if (dag_conflict(csound, groups[g].sem, groups[h].sem))
+          csound->dag_grp_deps[ndeps++] = g;
+      groups[h].ndeps = ndeps-groups[h].deps;
+      groups[h].self = dag_conflict(csound, groups[h].sem, groups[h].sem);
+      if (UNLIKELY(csound->oparms->odebug))
+        printf("group %d (instr %d): %d tasks, %d earlier groups%s\n",
+               h, task_map[groups[h].first]->insno,
+               groups[h].last-groups[h].first, groups[h].ndeps,
+               groups[h].self ? ", serial" : "");
+    }
+    dag_reinit(csound);
     if (UNLIKELY(csound->oparms->odebug)) dag_print_state(csound);
 }
 
@@ -277,23 +298,26 @@ void dag_reinit(CSOUND *csound)
       printf("DAG REINIT************************\n");
     for (i=csound->dag_num_active; i<max; i++)
       task_status[i] = DONE;
-    task_status[0] = AVAILABLE;
-    task_watch[0] = NULL;
-    for (i=1; i<csound->dag_num_active; i++) {
-      int j;
+    for (i=0; i<csound->dag_num_active; i++) {
+      DAG_GROUP *g = &csound->dag_groups[csound->dag_task_grp[i]];
+      int j = -1;
       task_status[i] = AVAILABLE;
       task_watch[i] = NULL;
-      if (csound->dag_task_dep[i]==NULL) continue;
-      for (j=0; j<i; j++)
-        if (csound->dag_task_dep[i][j]) {
-          task_status[i] = WAITING;
-          wlmm[i].id = i;
-          wlmm[i].next = task_watch[j];
-          task_watch[j] = &wlmm[i];
-          break;
-        }
+      /* watch the earliest task this one depends on */
+      if (g->ndeps)
+        j = csound->dag_groups[csound->dag_grp_deps[g->deps]].first;
+      else if (g->self && i > g->first)
+        j = g->first;
+      if (j >= 0) {
+        task_status[i] = WAITING;
+        wlmm[i].id = i;
+        wlmm[i].next = task_watch[j];
+        task_watch[j] = &wlmm[i];
+      }
     }
     //dag_print_state(csound);
+    if (csound->oparmsExt.dagScheduler == DAG_SCHED_WORKSTEAL)
+      dag_ws_seed(csound);
 }
 
 #define ATOMIC_READ(x) __sync_fetch_and_or(&(x), 0)
@@ -349,11 +373,49 @@ inline static int moveWatch(CSOUND *csound, watchList * volatile *w,
     return 1;
 }
 
-void dag_end_task(CSOUND *csound, taskID i)
+/* Find an unfinished task that task j depends on and move watch w on to
+   it; returns 1 if there is none, so that j can run now. */
+static int dag_watch_next(CSOUND *csound, taskID j, watchList *w)
+{
+    watchList * volatile *task_watch = csound->dag_task_watch;
+    DAG_GROUP *groups = csound->dag_groups;
+    DAG_GROUP *g = &groups[csound->dag_task_grp[j]];
+    int d, k;
+    for (d=0; d<=g->ndeps; d++) {  /* seek next watch */
+      int first, last;
+      if (d < g->ndeps) {
+        DAG_GROUP *dg = &groups[csound->dag_grp_deps[g->deps+d]];
+        first = dg->first; last = dg->last;
+      }
+      else if (g->self) {
+        first = g->first; last = j;
+      }
+      else break;
+      for (k=first; k<last; k++) {
+        //printf("investigating task %d (%d)\n", k, csound->dag_task_status[k]);
+        if (ATOMIC_READ(csound->dag_task_status[k]) != DONE) {
+          //printf("found task %d to watch %d status %d\n",
+          //       k, j, csound->dag_task_status[k]);
+          if (moveWatch(csound, &task_watch[k], w)) {
+            //printf("task %d now watches %d\n", j, k);
+            return 0;
+          }
+          /* else csound->dag_task_status[k] == DONE and we are in race */
+        }
+      }
+    }
+    return 1;
+}
+
+/* Walk the watchers of finished task i, moving each one on to its next
+   unfinished prerequisite or, if it has none, making it runnable.  With
+   the work-stealing scheduler a runnable task goes to the bottom of the
+   finishing thread's own deque. */
+static void dag_release_watchers(CSOUND *csound, taskID i, int index)
 {
     watchList *to_notify, *next;
     int canQueue;
-    int j, k;
+    int j;
     watchList * volatile *task_watch = csound->dag_task_watch;
     ATOMIC_WRITE(csound->dag_task_status[i], DONE); /* as DONE is zero */
     {                                      /* ATOMIC_SWAP */
@@ -367,35 +429,217 @@ void dag_end_task(CSOUND *csound, taskID i)
       next = to_notify->next;
       j = to_notify->id;
       //printf("%d notifying task %d it finished\n", i, j);
-      canQueue = 1;
-      for (k=0; k<j; k++) {     /* seek next watch */
-        if (csound->dag_task_dep[j][k]==0) continue;
-        //printf("investigating task %d (%d)\n", k, csound->dag_task_status[k]);
-        if (ATOMIC_READ(csound->dag_task_status[k]) != DONE) {
-          //printf("found task %d to watch %d status %d\n",
-          //       k, j, csound->dag_task_status[k]);
-          if (moveWatch(csound, &task_watch[k], to_notify)) {
-            //printf("task %d now watches %d\n", j, k);
-            canQueue = 0;
-            break;
-          }
-          else {
-            /* assert csound->dag_task_status[j] == DONE and we are in race */
-            //printf("Racing status %d %d %d %d\n",
-            //       csound->dag_task_status[j], i, j, k);
-          }
-        }
-        //else { printf("not %d\n", k); }
-      }
+      canQueue = dag_watch_next(csound, j, to_notify);
       if (canQueue) {           /*  could use monitor here */
         csound->dag_task_status[j] = AVAILABLE;
+        if (index >= 0) dag_ws_push(csound, index, j);
       }
       to_notify = next;
     }
     //dag_print_state(csound);
-    return;
 }
 
+void dag_end_task(CSOUND *csound, taskID i)
+{
+    dag_release_watchers(csound, i, -1);
+}
+
+/* Work-stealing dispatch (--sched=worksteal)
+ *
+ * Each performance thread owns a Chase-Lev deque of runnable tasks.  The
+ * owner pushes and pops at the bottom; idle threads steal from the top of
+ * somebody else's deque.  Initially runnable tasks are dealt round-robin
+ * to the deques before the threads are released, and a finishing task
+ * pushes the dependents it makes runnable on to its own thread's deque,
+ * so they are normally run by the same thread while its caches are warm.
+ * A thread that finds nothing to run or steal after a short spin parks on
+ * a condition variable rather than rescanning the status array.
+ *
+ * Every task is pushed at most once per k-cycle, so the deques are reset
+ * to empty at each cycle and never need to wrap.
+ */
+
+#define WS_EMPTY      (-1)
+#define WS_ABORT      (-2)
+#define WS_SPINS      (64)
+
+typedef struct dag_deque_t {
+    volatile int  top;          /* thieves take from here */
+    char          pad1[64-sizeof(int)];
+    volatile int  bottom;       /* owner pushes and pops here */
+    char          pad2[64-sizeof(int)];
+    taskID        *buf;
+} DAG_DEQUE;
+
+struct dag_sched_t {
+    int             nthreads;
+    int             size;       /* capacity of each deque */
+    DAG_DEQUE       *deques;
+    volatile int    remaining;  /* tasks not yet DONE this k-cycle */
+    volatile int    parked;     /* threads waiting on park_cond */
+    pthread_mutex_t park_lock;
+    pthread_cond_t  park_cond;
+};
+
+static void dag_ws_wake(struct dag_sched_t *ws)
+{
+    __sync_synchronize();
+    if (ws->parked) {
+      pthread_mutex_lock(&ws->park_lock);
+      pthread_cond_broadcast(&ws->park_cond);
+      pthread_mutex_unlock(&ws->park_lock);
+    }
+}
+
+static void dag_ws_push(CSOUND *csound, int index, taskID t)
+{
+    struct dag_sched_t *ws = csound->dag_sched;
+    DAG_DEQUE *d = &ws->deques[index];
+    int b = d->bottom;
+    d->buf[b] = t;
+    __sync_synchronize();       /* publish the entry before the index */
+    d->bottom = b+1;
+    dag_ws_wake(ws);
+}
+
+static taskID dag_ws_pop(DAG_DEQUE *d)
+{
+    int t, b = d->bottom-1;
+    taskID x;
+    d->bottom = b;
+    __sync_synchronize();
+    t = d->top;
+    if (t > b) {                /* was empty */
+      d->bottom = b+1;
+      return WS_EMPTY;
+    }
+    x = d->buf[b];
+    if (t == b) {               /* last entry: race any thief for it */
+      if (!ATOMIC_CAS(&d->top, t, t+1)) x = WS_EMPTY;
+      d->bottom = b+1;
+    }
+    return x;
+}
+
+static taskID dag_ws_steal(DAG_DEQUE *d)
+{
+    int t = d->top, b;
+    taskID x;
+    __sync_synchronize();
+    b = d->bottom;
+    if (t >= b) return WS_EMPTY;
+    x = d->buf[t];
+    if (!ATOMIC_CAS(&d->top, t, t+1)) return WS_ABORT;
+    return x;
+}
+
+/* Try each other deque once, starting with the next thread along */
+static taskID dag_ws_steal_any(struct dag_sched_t *ws, int index)
+{
+    int n = ws->nthreads, k;
+    taskID x;
+    for (k=1; k<n; k++) {
+      DAG_DEQUE *d = &ws->deques[(index+k)%n];
+      while ((x = dag_ws_steal(d)) == WS_ABORT);
+      if (x != WS_EMPTY) return x;
+    }
+    return WS_EMPTY;
+}
+
+static int dag_ws_has_work(struct dag_sched_t *ws)
+{
+    int k;
+    for (k=0; k<ws->nthreads; k++)
+      if (ws->deques[k].top < ws->deques[k].bottom) return 1;
+    return 0;
+}
+
+/* Called single-threaded, before the workers pass barrier1 */
+static void dag_ws_seed(CSOUND *csound)
+{
+    struct dag_sched_t *ws = csound->dag_sched;
+    int n = csound->oparms->numThreads, i, k;
+    if (n < 1) n = 1;
+    if (ws == NULL) {
+      ws = csound->dag_sched =
+        (struct dag_sched_t *)csound->Calloc(csound, sizeof(struct dag_sched_t));
+      ws->nthreads = n;
+      ws->deques =
+        (DAG_DEQUE *)csound->Calloc(csound, sizeof(DAG_DEQUE)*n);
+      pthread_mutex_init(&ws->park_lock, NULL);
+      pthread_cond_init(&ws->park_cond, NULL);
+    }
+    if (ws->size < csound->dag_task_max_size) {
+      ws->size = csound->dag_task_max_size;
+      for (k=0; k<n; k++)
+        ws->deques[k].buf =
+          (taskID *)csound->ReAlloc(csound, ws->deques[k].buf,
+                                    sizeof(taskID)*ws->size);
+    }
+    for (k=0; k<n; k++)
+      ws->deques[k].top = ws->deques[k].bottom = 0;
+    for (i=0, k=0; i<csound->dag_num_active; i++) {
+      if (csound->dag_task_status[i] != AVAILABLE) continue;
+      ws->deques[k].buf[ws->deques[k].bottom++] = i;
+      if (++k == n) k = 0;
+    }
+    ws->remaining = csound->dag_num_active;
+    __sync_synchronize();
+}
+
+/* Called from reset(), before memRESET() frees the deques with the rest
+   of the DAG */
+void dag_ws_free(CSOUND *csound)
+{
+    struct dag_sched_t *ws = csound->dag_sched;
+    int k;
+    if (ws == NULL) return;
+    pthread_mutex_destroy(&ws->park_lock);
+    pthread_cond_destroy(&ws->park_cond);
+    for (k=0; k<ws->nthreads; k++)
+      csound->Free(csound, ws->deques[k].buf);
+    csound->Free(csound, ws->deques);
+    csound->Free(csound, ws);
+    csound->dag_sched = NULL;
+}
+
+taskID dag_ws_get_task(CSOUND *csound, int index)
+{
+    struct dag_sched_t *ws = csound->dag_sched;
+    DAG_DEQUE *own = &ws->deques[index];
+    volatile enum state *task_status = csound->dag_task_status;
+    taskID x;
+    int spins = 0;
+
+    while (1) {
+      x = dag_ws_pop(own);
+      if (x == WS_EMPTY) x = dag_ws_steal_any(ws, index);
+      if (x != WS_EMPTY) {
+        if (ATOMIC_CAS(&(task_status[x]), AVAILABLE, INPROGRESS))
+          return x;
+        continue;
+      }
+      if (ATOMIC_READ(ws->remaining) == 0) return (taskID)INVALID;
+      if (++spins < WS_SPINS) continue;
+      /* Nothing to do until another thread finishes a task: park */
+      pthread_mutex_lock(&ws->park_lock);
+      __sync_fetch_and_add(&ws->parked, 1);
+      __sync_synchronize();
+      if (!dag_ws_has_work(ws) && ATOMIC_READ(ws->remaining) != 0)
+        pthread_cond_wait(&ws->park_cond, &ws->park_lock);
+      __sync_fetch_and_sub(&ws->parked, 1);
+      pthread_mutex_unlock(&ws->park_lock);
+      spins = 0;
+    }
+}
+
+void dag_ws_end_task(CSOUND *csound, int index, taskID i)
+{
+    struct dag_sched_t *ws = csound->dag_sched;
+    dag_release_watchers(csound, i, index);
+    if (__sync_sub_and_fetch(&ws->remaining, 1) == 0)
+      dag_ws_wake(ws);
+}
 
 /* INV : Acyclic */
 /* INV : Each entry is read by a single thread,
@@ -28,6 +28,10 @@
 
 #include "cs_par_base.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 int csp_thread_index_get(CSOUND *csound)
 {
     void *threadId = csound->GetCurrentThreadID();
@@ -474,7 +478,10 @@ int csp_set_add(CSOUND *csound, struct set_t *set, void *data)
     }
     set->count++;
 
-    set_update_cache(csound, set);
+    /* append to the cache rather than rebuilding it */
+    set->cache = csound->ReAlloc(csound, set->cache,
+                                 sizeof(struct set_element_t *) * set->count);
+    set->cache[set->count-1] = ele;
 
     return CSOUND_SUCCESS;
 }
@@ -681,3 +688,125 @@ int csp_set_intersection(CSOUND *csound, struct set_t *first,
 
     return CSOUND_SUCCESS;
 }
+
+/***********************************************************************
+ * bitsets over interned global names
+ */
+
+int csp_global_intern(CSOUND *csound, char *name)
+{
+    void *id;
+    char *key;
+    if (csound->globalIds == NULL)
+      csound->globalIds = cs_hash_table_create(csound);
+    id = cs_hash_table_get(csound, csound->globalIds, name);
+    if (id != NULL)
+      return (int)((intptr_t)id - 1);   /* stored off by one: NULL is absent */
+    if (csound->globalCount == csound->globalNamesMax) {
+      csound->globalNamesMax = 2*csound->globalNamesMax + 64;
+      csound->globalNames =
+        csound->ReAlloc(csound, csound->globalNames,
+                        sizeof(char*)*csound->globalNamesMax);
+    }
+    key = cs_hash_table_put_key(csound, csound->globalIds, name);
+    cs_hash_table_put(csound, csound->globalIds, key,
+                      (void*)(intptr_t)(csound->globalCount + 1));
+    csound->globalNames[csound->globalCount] = key;
+    return csound->globalCount++;
+}
+
+char *csp_global_name(CSOUND *csound, int id)
+{
+    return (id >= 0 && id < csound->globalCount) ? csound->globalNames[id] : NULL;
+}
+
+static void bitset_grow(CSOUND *csound, struct bitset_t *bs, int nwords)
+{
+    int n = (nwords + 1) & ~1;  /* even, so SSE2 can take pairs of words */
+    if (n <= bs->nwords) return;
+    bs->words = csound->ReAlloc(csound, bs->words, sizeof(uint64_t)*n);
+    memset(bs->words + bs->nwords, 0, sizeof(uint64_t)*(n - bs->nwords));
+    bs->nwords = n;
+}
+
+void csp_bitset_add(CSOUND *csound, struct bitset_t *bs, int id)
+{
+    bitset_grow(csound, bs, (id >> 6) + 1);
+    bs->words[id >> 6] |= ((uint64_t)1) << (id & 63);
+}
+
+void csp_bitset_add_set(CSOUND *csound, struct bitset_t *bs, struct set_t *set)
+{
+    int i, n = csp_set_count(set);
+    for (i = 0; i < n; i++) {
+      void *data = NULL;
+      csp_set_get_num(set, i, &data);
+      csp_bitset_add(csound, bs, csp_global_intern(csound, (char *)data));
+    }
+}
+
+void csp_bitset_union(CSOUND *csound, struct bitset_t *bs,
+                      struct bitset_t *other)
+{
+    int i = 0, n = other->nwords;
+    bitset_grow(csound, bs, n);
+    {
+      uint64_t *d = bs->words, *s = other->words;
+#if defined(__SSE2__)
+      for (; i < (n & ~1); i += 2)
+        _mm_storeu_si128((__m128i *)(d+i),
+                         _mm_or_si128(_mm_loadu_si128((__m128i *)(d+i)),
+                                      _mm_loadu_si128((__m128i *)(s+i))));
+#endif
+      for (; i < n; i++) d[i] |= s[i];
+    }
+}
+
+int csp_bitset_intersects(struct bitset_t *first, struct bitset_t *second)
+{
+    int i = 0;
+    int n = first->nwords < second->nwords ? first->nwords : second->nwords;
+    uint64_t *a = first->words, *b = second->words;
+#if defined(__SSE2__)
+    for (; i < (n & ~1); i += 2) {
+      __m128i x = _mm_and_si128(_mm_loadu_si128((__m128i *)(a+i)),
+                                _mm_loadu_si128((__m128i *)(b+i)));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128())) != 0xFFFF)
+        return 1;
+    }
+#endif
+    for (; i < n; i++)
+      if (a[i] & b[i]) return 1;
+    return 0;
+}
+
+int csp_bitset_count(struct bitset_t *bs)
+{
+    int i, cnt = 0;
+    for (i = 0; i < bs->nwords; i++) {
+      uint64_t w = bs->words[i];
+      while (w) { w &= w - 1; cnt++; }
+    }
+    return cnt;
+}
+
+int csp_bitset_print(CSOUND *csound, struct bitset_t *bs)
+{
+    int i, first = 1;
+    csound->Message(csound, "{ ");
+    for (i = 0; i < bs->nwords*64; i++) {
+      if (!(bs->words[i>>6] & (((uint64_t)1) << (i & 63)))) continue;
+      if (!first) csound->Message(csound, ", ");
+      csound->Message(csound, "%s", csp_global_name(csound, i));
+      first = 0;
+    }
+    csound->Message(csound, " }\n");
+    return CSOUND_SUCCESS;
+}
+
+void csp_bitset_dealloc(CSOUND *csound, struct bitset_t *bs)
+{
+    if (bs->words != NULL) csound->Free(csound, bs->words);
+    bs->words = NULL;
+    bs->nwords = 0;
+}
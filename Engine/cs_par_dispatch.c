@@ -159,9 +159,9 @@ TREE *csp_locks_insert(CSOUND *csound, TREE *root)
           instr = csp_orc_sa_instr_get_by_name(csound,
                                                current->left->value->lexeme);
         }
-        if (instr->read_write->count > 0 &&
-            instr->read->count == 0 &&
-            instr->write->count == 0) {
+        if (csp_bitset_count(&instr->read_write) > 0 &&
+            csp_bitset_count(&instr->read) == 0 &&
+            csp_bitset_count(&instr->write) == 0) {
           csound->Message(csound, Str("Instr %d needs locks"), instr->insno);
           //print_tree(csound, "before locks", root);
           current->right = csp_locks_insert(csound, current->right);
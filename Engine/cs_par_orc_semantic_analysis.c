@@ -55,9 +55,7 @@ static INSTR_SEMANTICS *instr_semantics_alloc(CSOUND *csound, char *name)
     /* always check for greater than 0 in optimisation
        so this is a good default
      */
-    csp_set_alloc_string(csound, &(instr->read_write));
-    csp_set_alloc_string(csound, &(instr->write));
-    csp_set_alloc_string(csound, &(instr->read));
+    /* read, write and read_write start as empty bitsets */
 
     return instr;
 }
@@ -74,9 +72,13 @@ void csp_orc_sa_cleanup(CSOUND *csound)
     INSTR_SEMANTICS *current = csound->instRoot, *h = NULL;
     while (current != NULL) {
 
-      csp_set_dealloc(csound, &(current->read));
-      csp_set_dealloc(csound, &(current->write));
-      csp_set_dealloc(csound, &(current->read_write));
+      csp_bitset_dealloc(csound, &(current->read));
+      csp_bitset_dealloc(csound, &(current->write));
+      csp_bitset_dealloc(csound, &(current->read_write));
+      if (current->dep_known != NULL) {
+        csound->Free(csound, current->dep_known);
+        csound->Free(csound, current->dep_conflict);
+      }
 
       h = current;
       current = current->next;
@@ -94,13 +96,13 @@ void csp_orc_sa_print_list(CSOUND *csound)
     while (current != NULL) {
       csound->Message(csound, "Instr: %s\n", current->name);
       csound->Message(csound, "  read: ");
-      csp_set_print(csound, current->read);
+      csp_bitset_print(csound, &current->read);
 
       csound->Message(csound, "  write: ");
-      csp_set_print(csound, current->write);
+      csp_bitset_print(csound, &current->write);
 
       csound->Message(csound, "  read_write: ");
-      csp_set_print(csound, current->read_write);
+      csp_bitset_print(csound, &current->read_write);
 
       current = current->next;
     }
@@ -145,11 +147,9 @@ void csp_orc_sa_global_read_write_add_list1(CSOUND *csound,
       csp_set_union(csound, write, read, &new);
       if (write->count == 1 && read->count == 1 && new->count == 1) {
         /* this is a read_write list thing */
-        struct set_t *new_read_write = NULL;
-        csp_set_union(csound, csound->instCurr->read_write,
-                      new, &new_read_write);
-        csp_set_dealloc(csound, &csound->instCurr->read_write);
-        csound->instCurr->read_write = new_read_write;
+        csp_bitset_add_set(csound, &csound->instCurr->read_write, new);
+        csp_set_dealloc(csound, &write);
+        csp_set_dealloc(csound, &read);
       }
       else {
         csp_orc_sa_global_write_add_list(csound, write);
@@ -172,13 +172,8 @@ void csp_orc_sa_global_write_add_list(CSOUND *csound, struct set_t *set)
                       "global write_list\n"));
     }
     else {
-      struct set_t *new = NULL;
-      csp_set_union(csound, csound->instCurr->write, set, &new);
-
-      csp_set_dealloc(csound, &csound->instCurr->write);
+      csp_bitset_add_set(csound, &csound->instCurr->write, set);
       csp_set_dealloc(csound, &set);
-
-      csound->instCurr->write = new;
     }
 }
 
@@ -195,13 +190,8 @@ void csp_orc_sa_global_read_add_list(CSOUND *csound, struct set_t *set)
                       "global read_list\n"));
     }
     else {
-      struct set_t *new = NULL;
-      csp_set_union(csound, csound->instCurr->read, set, &new);
-
-      csp_set_dealloc(csound, &csound->instCurr->read);
+      csp_bitset_add_set(csound, &csound->instCurr->read, set);
       csp_set_dealloc(csound, &set);
-
-      csound->instCurr->read = new;
     }
 }
 
@@ -250,10 +240,12 @@ void csp_orc_sa_instr_add(CSOUND *csound, char *name)
         csound->instCurr = csound->instCurr->next;
       }
       prev->next = instr_semantics_alloc(csound, name);
+      prev->next->dep_id = prev->dep_id + 1;
       csound->instCurr = prev->next;
     }
     else {
       csound->instCurr->next = instr_semantics_alloc(csound, name);
+      csound->instCurr->next->dep_id = csound->instCurr->dep_id + 1;
       csound->instCurr = csound->instCurr->next;
     }
     // csound->instCurr->insno = named_instr_find(name);
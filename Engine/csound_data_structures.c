@@ -94,155 +94,251 @@ PUBLIC void cs_cons_free_complete(CSOUND* csound, CONS_CELL* head) {
 
 /* FUNCTION FOR HASH SET */
 
+/* Lookups may run on host threads while the performance thread adds
+   entries.  Growing publishes the new slot array before the new size,
+   and keeps the old array until the table is freed.  A lookup reads
+   the size before the array, so its mask always fits the array it
+   probes, and it retries a miss if either changed meanwhile. */
+#ifdef HAVE_ATOMIC_BUILTIN
+#define HT_BARRIER()    __sync_synchronize()
+#else
+#define HT_BARRIER()
+#endif
+
+static CS_HASH_TABLE* cs_hash_table_alloc(CSOUND* csound, int interned) {
+    CS_HASH_TABLE* hashTable = csound->Calloc(csound, sizeof(CS_HASH_TABLE));
+    hashTable->items = csound->Calloc(csound,
+                                      HASH_SIZE * sizeof(CS_HASH_TABLE_ITEM));
+    hashTable->size = HASH_SIZE;
+    hashTable->interned = interned;
+    return hashTable;
+}
+
 PUBLIC CS_HASH_TABLE* cs_hash_table_create(CSOUND* csound) {
-    return (CS_HASH_TABLE*) csound->Calloc(csound, sizeof(CS_HASH_TABLE));
+    return cs_hash_table_alloc(csound, 0);
 }
 
-static unsigned int cs_name_hash(char *s)
+PUBLIC CS_HASH_TABLE* cs_hash_table_create_interned(CSOUND* csound) {
+    return cs_hash_table_alloc(csound, 1);
+}
+
+/* 64-bit multiply-xorshift string hash (MurmurHash64A), reading the key
+   eight bytes at a time */
+static uint32_t cs_name_hash(const char *s)
 {
-    unsigned int h = 0;
-    while (*s != '\0') {
-        h = (h<<4) ^ *s++;
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const unsigned char *p = (const unsigned char *) s;
+    size_t   len = strlen(s);
+    uint64_t h = 0x8445d61a4e774912ULL ^ (len * m);
+    uint64_t k;
+
+    for ( ; len >= 8; len -= 8, p += 8) {
+        memcpy(&k, p, 8);
+        k *= m;
+        k ^= k >> 47;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    switch (len) {
+    case 7: h ^= (uint64_t) p[6] << 48; /* fall through */
+    case 6: h ^= (uint64_t) p[5] << 40; /* fall through */
+    case 5: h ^= (uint64_t) p[4] << 32; /* fall through */
+    case 4: h ^= (uint64_t) p[3] << 24; /* fall through */
+    case 3: h ^= (uint64_t) p[2] << 16; /* fall through */
+    case 2: h ^= (uint64_t) p[1] << 8; /* fall through */
+    case 1: h ^= (uint64_t) p[0];
+            h *= m;
+    }
+    h ^= h >> 47;
+    h *= m;
+    h ^= h >> 47;
+    return (uint32_t) (h ^ (h >> 32));
+}
+
+static inline uint32_t cs_key_hash(CS_HASH_TABLE* hashTable, const char* key) {
+    if (hashTable->interned) {
+        uint64_t h = (uint64_t) (uintptr_t) key * 0x9e3779b97f4a7c15ULL;
+        return (uint32_t) (h >> 32);
+    }
+    return cs_name_hash(key);
+}
+
+/* Returns the slot holding key, or the empty slot where it would go */
+static CS_HASH_TABLE_ITEM* cs_hash_table_find(CS_HASH_TABLE* hashTable,
+                                              const char* key, uint32_t hash) {
+    uint32_t size, index;
+    CS_HASH_TABLE_ITEM *items, *item;
+
+    do {
+        size = *(volatile uint32_t*) &hashTable->size;
+        HT_BARRIER();
+        items = *(CS_HASH_TABLE_ITEM* volatile*) &hashTable->items;
+        index = hash & (size - 1);
+        while ((item = &items[index])->key != NULL) {
+            if (item->key == key ||
+                (item->hash == hash && !hashTable->interned &&
+                 strcmp(key, item->key) == 0)) {
+                return item;
+            }
+            index = (index + 1) & (size - 1);
+        }
+        HT_BARRIER();
+    } while (size != *(volatile uint32_t*) &hashTable->size ||
+             items != *(CS_HASH_TABLE_ITEM* volatile*) &hashTable->items);
+    return item;
+}
+
+static void cs_hash_table_grow(CSOUND* csound, CS_HASH_TABLE* hashTable) {
+    CS_HASH_TABLE_ITEM* old = hashTable->items;
+    CS_HASH_TABLE_ITEM* items;
+    uint32_t i, oldSize = hashTable->size;
+    uint32_t mask = oldSize * 2 - 1;
+
+    items = csound->Calloc(csound, oldSize * 2 * sizeof(CS_HASH_TABLE_ITEM));
+    for (i = 0; i < oldSize; i++) {
+        if (old[i].key != NULL) {
+            uint32_t index = old[i].hash & mask;
+            while (items[index].key != NULL) {
+                index = (index + 1) & mask;
+            }
+            items[index] = old[i];
+        }
     }
-    return (h%HASH_SIZE);
+    HT_BARRIER();
+    hashTable->items = items;
+    HT_BARRIER();
+    hashTable->size = oldSize * 2;
+    hashTable->retired = cs_cons(csound, old, hashTable->retired);
 }
 
 PUBLIC void* cs_hash_table_get(CSOUND* csound,
                                CS_HASH_TABLE* hashTable, char* key) {
-    unsigned int index;
     CS_HASH_TABLE_ITEM* item;
 
     if (key == NULL) {
         return NULL;
     }
 
-    index = cs_name_hash(key);
-    item = hashTable->buckets[index];
-
-    while (item != NULL) {
-        if (strcmp(key, item->key) == 0) {
-            return item->value;
-        }
-        item = item->next;
-    }
-
-    return NULL;
+    item = cs_hash_table_find(hashTable, key, cs_key_hash(hashTable, key));
+    return item->key != NULL ? item->value : NULL;
 }
 
 PUBLIC char* cs_hash_table_get_key(CSOUND* csound,
                                    CS_HASH_TABLE* hashTable, char* key) {
-    unsigned int index;
     CS_HASH_TABLE_ITEM* item;
 
     if (key == NULL) {
         return NULL;
     }
 
-    index = cs_name_hash(key);
-    item = hashTable->buckets[index];
-
-    while (item != NULL) {
-        if (strcmp(key, item->key) == 0) {
-            return item->key;
-        }
-        item = item->next;
-    }
-
-    return NULL;
+    item = cs_hash_table_find(hashTable, key, cs_key_hash(hashTable, key));
+    return item->key;
 }
 
-char* cs_hash_table_put_no_key_copy(CSOUND* csound,
-                                   CS_HASH_TABLE* hashTable,
-                                    char* key, void* value) {
+/* Stores value under key, taking ownership of key if it is new; if the
+   key is already present, key is freed unless keyOwned is 0 */
+static char* cs_hash_table_insert(CSOUND* csound, CS_HASH_TABLE* hashTable,
+                                  char* key, void* value, int keyOwned) {
+    uint32_t hash;
+    CS_HASH_TABLE_ITEM* item;
+
     if (key == NULL) {
         return NULL;
     }
 
-    unsigned int index = cs_name_hash(key);
-
-    CS_HASH_TABLE_ITEM* item = hashTable->buckets[index];
-
-    if (item == NULL) {
-        CS_HASH_TABLE_ITEM* newItem = csound->Malloc(csound,
-                                                     sizeof(CS_HASH_TABLE_ITEM));
-        newItem->key = key;
-        newItem->value = value;
-        newItem->next = NULL;
-        hashTable->buckets[index] = newItem;
-        return newItem->key;
-    } else {
-        while (item != NULL) {
-            if (strcmp(key, item->key) == 0) {
-                item->value = value;
-                return item->key;
-            } else if(item->next == NULL) {
-                CS_HASH_TABLE_ITEM* newItem = csound->Malloc(csound,
-                                                      sizeof(CS_HASH_TABLE_ITEM));
-                newItem->key = key;
-                newItem->value = value;
-                newItem->next = NULL;
-                item->next = newItem;
-                return newItem->key;
-            }
-            item = item->next;
+    hash = cs_key_hash(hashTable, key);
+    item = cs_hash_table_find(hashTable, key, hash);
+    if (item->key != NULL) {
+        if (keyOwned && item->key != key) {
+            csound->Free(csound, key);
         }
+        item->value = value;
+        return item->key;
     }
-    return NULL;
+    if ((hashTable->count + 1) * 4 > hashTable->size * 3) {
+        cs_hash_table_grow(csound, hashTable);
+        item = cs_hash_table_find(hashTable, key, hash);
+    }
+    item->key = key;
+    item->value = value;
+    item->hash = hash;
+    hashTable->count++;
+    return key;
+}
+
+char* cs_hash_table_put_no_key_copy(CSOUND* csound,
+                                   CS_HASH_TABLE* hashTable,
+                                    char* key, void* value) {
+    return cs_hash_table_insert(csound, hashTable, key, value, 0);
 }
 
 PUBLIC void cs_hash_table_put(CSOUND* csound,
                               CS_HASH_TABLE* hashTable, char* key, void* value) {
-    cs_hash_table_put_no_key_copy(csound, hashTable,
-                                  cs_strdup(csound, key), value);
+    if (hashTable->interned || key == NULL) {
+        cs_hash_table_insert(csound, hashTable, key, value, 0);
+    } else {
+        cs_hash_table_insert(csound, hashTable,
+                             cs_strdup(csound, key), value, 1);
+    }
 }
 
 PUBLIC char* cs_hash_table_put_key(CSOUND* csound,
                                    CS_HASH_TABLE* hashTable, char* key) {
-    return cs_hash_table_put_no_key_copy(csound, hashTable,
-                                         cs_strdup(csound, key), NULL);
+    if (hashTable->interned || key == NULL) {
+        return cs_hash_table_insert(csound, hashTable, key, NULL, 0);
+    }
+    return cs_hash_table_insert(csound, hashTable,
+                                cs_strdup(csound, key), NULL, 1);
 }
 
 PUBLIC void cs_hash_table_remove(CSOUND* csound,
                                  CS_HASH_TABLE* hashTable, char* key) {
-    CS_HASH_TABLE_ITEM *previous, *item;
-    unsigned int index;
+    CS_HASH_TABLE_ITEM* items = hashTable->items;
+    CS_HASH_TABLE_ITEM* item;
+    uint32_t mask = hashTable->size - 1;
+    uint32_t i, j, home;
 
     if (key == NULL) {
         return;
     }
 
-    index = cs_name_hash(key);
-
-    previous = NULL;
-    item = hashTable->buckets[index];
+    item = cs_hash_table_find(hashTable, key, cs_key_hash(hashTable, key));
+    if (item->key == NULL) {
+        return;
+    }
+    if (!hashTable->interned) {
+        csound->Free(csound, item->key);
+    }
 
-    while (item != NULL) {
-        if (strcmp(key, item->key) == 0) {
-            if (previous == NULL) {
-                hashTable->buckets[index] = NULL;
-                csound->Free(csound, item);
-                return;
-            } else {
-                previous->next = item->next;
-                csound->Free(csound, item);
-            }
+    /* backward-shift deletion: move later entries of the probe run
+       into the hole unless that would put them before their home slot */
+    i = j = (uint32_t) (item - items);
+    for (;;) {
+        j = (j + 1) & mask;
+        if (items[j].key == NULL) {
+            break;
+        }
+        home = items[j].hash & mask;
+        if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) {
+            continue;
         }
-        previous = item;
-        item = item->next;
+        items[i] = items[j];
+        i = j;
     }
+    items[i].key = NULL;
+    items[i].value = NULL;
+    hashTable->count--;
 }
 
 PUBLIC CONS_CELL* cs_hash_table_keys(CSOUND* csound, CS_HASH_TABLE* hashTable) {
     CONS_CELL* head = NULL;
 
-    int i = 0;
+    uint32_t i = 0;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
-
-        while (item != NULL) {
-            head = cs_cons(csound, item->key, head);
-            item = item->next;
+    for (i = 0; i < hashTable->size; i++) {
+        if (hashTable->items[i].key != NULL) {
+            head = cs_cons(csound, hashTable->items[i].key, head);
         }
     }
     return head;
@@ -251,14 +347,11 @@ PUBLIC CONS_CELL* cs_hash_table_keys(CSOUND* csound, CS_HASH_TABLE* hashTable) {
 PUBLIC CONS_CELL* cs_hash_table_values(CSOUND* csound, CS_HASH_TABLE* hashTable) {
     CONS_CELL* head = NULL;
 
-    int i = 0;
-
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+    uint32_t i = 0;
 
-        while (item != NULL) {
-            head = cs_cons(csound, item->value, head);
-            item = item->next;
+    for (i = 0; i < hashTable->size; i++) {
+        if (hashTable->items[i].key != NULL) {
+            head = cs_cons(csound, hashTable->items[i].value, head);
         }
     }
     return head;
@@ -267,77 +360,76 @@ PUBLIC CONS_CELL* cs_hash_table_values(CSOUND* csound, CS_HASH_TABLE* hashTable)
 PUBLIC void cs_hash_table_merge(CSOUND* csound,
                                 CS_HASH_TABLE* target, CS_HASH_TABLE* source) {
     // TODO - check if this is the best strategy for merging
-    int i = 0;
+    uint32_t i = 0;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = source->buckets[i];
+    for (i = 0; i < source->size; i++) {
+        CS_HASH_TABLE_ITEM* item = &source->items[i];
 
-        while (item != NULL) {
+        if (item->key != NULL) {
             cs_hash_table_put_no_key_copy(csound, target, item->key, item->value);
-            item = item->next;
         }
     }
 
 }
 
 PUBLIC void cs_hash_table_free(CSOUND* csound, CS_HASH_TABLE* hashTable) {
-    int i;
+    uint32_t i;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+    for (i = 0; i < hashTable->size; i++) {
+        CS_HASH_TABLE_ITEM* item = &hashTable->items[i];
 
-        while(item != NULL) {
-            CS_HASH_TABLE_ITEM* next = item->next;
+        if (item->key != NULL && !hashTable->interned) {
             csound->Free(csound, item->key);
-            csound->Free(csound, item);
-            item = next;
         }
     }
+    cs_cons_free_complete(csound, hashTable->retired);
+    csound->Free(csound, hashTable->items);
     csound->Free(csound, hashTable);
 }
 
 PUBLIC void cs_hash_table_mfree_complete(CSOUND* csound, CS_HASH_TABLE* hashTable) {
 
-    int i;
+    uint32_t i;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+    for (i = 0; i < hashTable->size; i++) {
+        CS_HASH_TABLE_ITEM* item = &hashTable->items[i];
 
-        while(item != NULL) {
-            CS_HASH_TABLE_ITEM* next = item->next;
-            csound->Free(csound, item->key);
+        if (item->key != NULL) {
+            if (!hashTable->interned) {
+                csound->Free(csound, item->key);
+            }
             csound->Free(csound, item->value);
-            csound->Free(csound, item);
-            item = next;
         }
     }
+    cs_cons_free_complete(csound, hashTable->retired);
+    csound->Free(csound, hashTable->items);
     csound->Free(csound, hashTable);
 }
 
 PUBLIC void cs_hash_table_free_complete(CSOUND* csound, CS_HASH_TABLE* hashTable) {
 
-    int i;
+    uint32_t i;
 
-    for (i = 0; i < HASH_SIZE; i++) {
-        CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+    for (i = 0; i < hashTable->size; i++) {
+        CS_HASH_TABLE_ITEM* item = &hashTable->items[i];
 
-        while(item != NULL) {
-            CS_HASH_TABLE_ITEM* next = item->next;
-            csound->Free(csound, item->key);
+        if (item->key != NULL) {
+            if (!hashTable->interned) {
+                csound->Free(csound, item->key);
+            }
 
             /* NOTE: This needs to be free, not csound->Free.
                To use mfree on keys, use cs_hash_table_mfree_complete
                TODO: Check if this is even necessary anymore... */
             free(item->value);
-            csound->Free(csound, item);
-            item = next;
         }
     }
+    cs_cons_free_complete(csound, hashTable->retired);
+    csound->Free(csound, hashTable->items);
     csound->Free(csound, hashTable);
 }
 
 
-
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -46,6 +46,9 @@ static  void    lgbuild(CSOUND *, INSTRTXT *, char *,
 int     pnum(char *s) ;
 static void     unquote_string(char *, const char *);
 extern void     print_tree(CSOUND *, char *, TREE *);
+extern void     instance_slabs_free(CSOUND *, INSTRTXT *);
+extern void     instance_prefault(CSOUND *, INSTRTXT *, int);
+extern void     init_queue_purge(CSOUND *);
 void close_instrument(CSOUND *csound, ENGINE_STATE *engineState, INSTRTXT * ip);
 char argtyp2(char *s);
 void debugPrintCsound(CSOUND* csound);
@@ -853,15 +856,16 @@ void free_instrtxt(CSOUND *csound, INSTRTXT *instrtxt)
 {
     INSTRTXT *ip = instrtxt;
     INSDS *active = ip->instance;
+    init_queue_purge(csound);
     while (active != NULL) {   /* remove instance memory */
       INSDS   *nxt = active->nxtinstance;
       if (active->fdchp != NULL)
         fdchclose(csound, active);
       if (active->auxchp != NULL)
         auxchfree(csound, active);
-      csound->Free(csound, active);
       active = nxt;
     }
+    instance_slabs_free(csound, ip);
     OPTXT *t = ip->nxtop;
     while (t) {
           OPTXT *s = t->nxtop;
@@ -1272,6 +1276,7 @@ int engineState_merge(CSOUND *csound, ENGINE_STATE *engineState)
       insprep(csound, current, current_state);/* run insprep() to connect ARGS */
       recalculateVarPoolMemory(csound,
                                current->varPool); /* recalculate var pool */
+      instance_prefault(csound, current, csound->oparmsExt.prefaultInstances);
     }
     /* now we need to patch up instr order */
     end = current_state->maxinsno;
@@ -1587,6 +1592,7 @@ PUBLIC int csoundCompileTree(CSOUND *csound, TREE *root)
       while ((ip = ip->nxtinstxt) != NULL) {        /* add all other entries */
         insprep(csound, ip, engineState);           /*   as combined offsets */
         recalculateVarPoolMemory(csound, ip->varPool);
+        instance_prefault(csound, ip, csound->oparmsExt.prefaultInstances);
       }
 
       CS_VARIABLE *var;
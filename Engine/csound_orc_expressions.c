@@ -28,12 +28,15 @@
 #include "csound_orc_expressions.h"
 #include "csound_type_system.h"
 #include "csound_orc_semantics.h"
+#include "aops.h"
 
 extern char argtyp2(char *);
 extern void print_tree(CSOUND *, char *, TREE *);
 extern void handle_optional_args(CSOUND *, TREE *);
 extern ORCTOKEN *make_token(CSOUND *, char *);
 extern ORCTOKEN *make_label(CSOUND *, char *);
+extern ORCTOKEN *make_string(CSOUND *, char *);
+extern TREE* make_leaf(CSOUND *, int, int, int, ORCTOKEN *);
 extern OENTRIES* find_opcode2(CSOUND *, char*);
 extern char* resolve_opcode_get_outarg(CSOUND* , OENTRIES* , char*);
 extern TREE* appendToTree(CSOUND * csound, TREE *first, TREE *newlast);
@@ -50,6 +53,7 @@ extern char* convert_external_to_internal(CSOUND* csound, char* arg);
 
 TREE* create_boolean_expression(CSOUND*, TREE*, int, int, TYPE_TABLE*);
 TREE * create_expression(CSOUND *, TREE *, int, int, TYPE_TABLE*);
+void handle_negative_number(CSOUND*, TREE*);
 char *check_annotated_type(CSOUND* csound, OENTRIES* entries,
                            char* outArgTypes);
 
@@ -380,6 +384,158 @@ char* create_out_arg_for_expression(CSOUND* csound, char* op, TREE* left,
     return create_out_arg(csound, outType, typeTable);
 }
 
+/* A-RATE EXPRESSION FUSION
+ *
+ * A tree of +, - , * and unary minus that yields an a-rate result is
+ * compiled to a single ##fuse opcode, which evaluates the whole tree
+ * per sample block instead of running one opcode (and writing one a-rate
+ * temporary) per operator.  Operands that are not a-rate arithmetic
+ * (variables, constants, function calls, k-rate subexpressions...) are
+ * computed as before and passed in as arguments.  See fuse_init() in
+ * OOps/aops.c for the program format.
+ */
+
+typedef struct {
+    TREE    *anchor;        /* statements computing the operands */
+    TREE    *args;          /* operands, in argument order */
+    int     nargs, len;
+    char    prog[FUSE_MAXCODE + 1];
+} FUSE_STATE;
+
+static int is_fusable_op(TREE *node)
+{
+    return (node->type == '+' || node->type == '-' || node->type == '*' ||
+            node->type == S_UMINUS);
+}
+
+/* 'a' for an a-rate operand, 'k' for a scalar one, 0 for anything else */
+static char fuse_arg_class(CSOUND *csound, TREE *node, TYPE_TABLE *typeTable)
+{
+    char *type = get_arg_type2(csound, node, typeTable);
+
+    if (type == NULL || type[0] == '\0' || type[1] != '\0')
+      return 0;
+    if (*type == 'a')
+      return 'a';
+    return strchr("kicrp", *type) != NULL ? 'k' : 0;
+}
+
+/* Returns the stack depth needed to evaluate node, or -1 if it can not
+   be fused; counts operators and operands in *ops and *leaves */
+static int fuse_scan(CSOUND *csound, TREE *node, TYPE_TABLE *typeTable,
+                     int *ops, int *leaves)
+{
+    char c = fuse_arg_class(csound, node, typeTable);
+    int  d1, d2;
+
+    if (c == 0)
+      return -1;
+    if (c == 'a' && is_fusable_op(node)) {
+      (*ops)++;
+      if (node->type == S_UMINUS)
+        return fuse_scan(csound, node->right, typeTable, ops, leaves);
+      d1 = fuse_scan(csound, node->left, typeTable, ops, leaves);
+      d2 = fuse_scan(csound, node->right, typeTable, ops, leaves);
+      if (d1 < 0 || d2 < 0)
+        return -1;
+      return (d1 > d2 + 1 ? d1 : d2 + 1);
+    }
+    (*leaves)++;
+    return 1;
+}
+
+static int is_fusable_expression(CSOUND *csound, TREE *root,
+                                 TYPE_TABLE *typeTable)
+{
+    int ops = 0, leaves = 0, depth;
+
+    if (!is_fusable_op(root))
+      return 0;
+    depth = fuse_scan(csound, root, typeTable, &ops, &leaves);
+    return (depth > 0 && depth <= FUSE_STACK && ops >= 2 &&
+            leaves <= FUSE_MAXARGS && ops + leaves <= FUSE_MAXCODE);
+}
+
+/* index of a variable already passed as an operand, or -1 */
+static int fuse_find_arg(FUSE_STATE *st, char *name)
+{
+    TREE *arg;
+    int  i;
+
+    for (arg = st->args, i = 0; arg != NULL; arg = arg->next, i++) {
+      if (arg->type == T_IDENT && strcmp(arg->value->lexeme, name) == 0)
+        return i;
+    }
+    return -1;
+}
+
+static int fuse_emit(CSOUND *csound, TREE *node, FUSE_STATE *st,
+                     int line, int locn, TYPE_TABLE *typeTable)
+{
+    char c = fuse_arg_class(csound, node, typeTable);
+    TREE *arg;
+    int  i;
+
+    if (c == 'a' && is_fusable_op(node)) {
+      if (node->type == S_UMINUS) {
+        if (fuse_emit(csound, node->right, st, line, locn, typeTable) != OK)
+          return NOTOK;
+        st->prog[st->len++] = '~';
+        return OK;
+      }
+      if (fuse_emit(csound, node->left, st, line, locn, typeTable) != OK ||
+          fuse_emit(csound, node->right, st, line, locn, typeTable) != OK)
+        return NOTOK;
+      st->prog[st->len++] = (char) node->type;
+      return OK;
+    }
+
+    handle_negative_number(csound, node);
+    if (is_expression_node(node)) {
+      TREE *expr = create_expression(csound, node, line, locn, typeTable);
+      if (expr == NULL)
+        return NOTOK;
+      st->anchor = appendToTree(csound, st->anchor, expr);
+      arg = create_ans_token(csound, tree_tail(expr)->left->value->lexeme);
+    }
+    else if (node->type == T_IDENT &&
+             (i = fuse_find_arg(st, node->value->lexeme)) >= 0) {
+      st->prog[st->len++] = (char) ((c == 'a' ? 'A' : 'a') + i);
+      return OK;
+    }
+    else {
+      arg = node;
+      arg->next = NULL;
+    }
+    st->args = appendToTree(csound, st->args, arg);
+    st->prog[st->len++] = (char) ((c == 'a' ? 'A' : 'a') + st->nargs++);
+    return OK;
+}
+
+static TREE *create_fused_expression(CSOUND *csound, TREE *root,
+                                     int line, int locn,
+                                     TYPE_TABLE *typeTable)
+{
+    FUSE_STATE st;
+    TREE       *opTree;
+    char       prog[FUSE_MAXCODE + 3];
+
+    memset(&st, 0, sizeof(FUSE_STATE));
+    if (fuse_emit(csound, root, &st, line, locn, typeTable) != OK)
+      return NULL;
+    snprintf(prog, FUSE_MAXCODE + 3, "\"%s\"", st.prog);
+
+    opTree = create_opcode_token(csound, "##fuse");
+    opTree->left = create_ans_token(csound,
+                                    create_out_arg(csound, "a", typeTable));
+    opTree->right = make_leaf(csound, line, locn, STRING_TOKEN,
+                              make_string(csound, prog));
+    opTree->right->next = st.args;
+    opTree->line = line;
+    opTree->locn = locn;
+    return appendToTree(csound, st.anchor, opTree);
+}
+
 /**
  * Create a chain of Opcode (OPTXT) text from the AST node given. Called from
  * create_opcode when an expression node has been found as an argument
@@ -396,6 +552,10 @@ TREE * create_expression(CSOUND *csound, TREE *root, int line, int locn,
     if (root->type=='?') return create_cond_expression(csound, root, line,
                                                        locn, typeTable);
 
+    if (csound->oparmsExt.optLevel > 0 &&
+        is_fusable_expression(csound, root, typeTable))
+      return create_fused_expression(csound, root, line, locn, typeTable);
+
     current = root->left;
     newArgList = NULL;
     while(current != NULL) {
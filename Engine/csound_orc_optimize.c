@@ -24,6 +24,11 @@
 
 #include "csoundCore.h"
 #include "csound_orc.h"
+#include "csound_type_system.h"
+
+extern OENTRIES* find_opcode2(CSOUND *, char*);
+extern OENTRY* resolve_opcode(CSOUND*, OENTRIES*, char*, char*);
+extern char *create_out_arg(CSOUND *, char*, TYPE_TABLE*);
 
 static TREE * create_fun_token(CSOUND *csound, TREE *right, char *fname)
 {
@@ -216,10 +221,517 @@ static TREE * verify_tree1(CSOUND *csound, TREE *root)
     return root;
 }
 
+/* OPTIMISATION OF INSTRUMENT BODIES
+ *
+ * After semantic analysis an instrument or UDO body is a flat list of
+ * statements whose arguments are names or constants, and the value of
+ * each (sub)expression is held in a '#' temporary written by exactly one
+ * statement.  The passes below work on these lists:
+ *
+ *   level 1: constant folding of arithmetic on two constants and removal
+ *            of pure statements whose temporary result is never read
+ *   level 2: common subexpression elimination between two labels,
+ *            k-rate operations on init-time values moved to the init
+ *            pass, and removal of local variables that are never read
+ *
+ * Only the opcodes in pure_opcodes[] are moved, merged or removed; every
+ * other statement is a barrier for the names it reads and writes, and
+ * for globals and p-fields.
+ */
+
+static const char *pure_opcodes[] = {
+    "=", "init",
+    "##add", "##sub", "##mul", "##div", "##mod", "##pow", "##fuse",
+    "abs", "int", "frac", "round", "floor", "ceil",
+    "exp", "log", "log10", "log2", "sqrt", "powoftwo", "logbtwo",
+    "sin", "cos", "tan", "sininv", "cosinv", "taninv",
+    "sinh", "cosh", "tanh",
+    "ampdb", "dbamp", "ampdbfs", "dbfsamp",
+    "cpspch", "pchoct", "octpch", "cpsoct", "octcps",
+    "cpsmidinn", "octmidinn", "pchmidinn",
+    NULL
+};
+
+typedef struct opt_use {
+    int     defs;           /* statements writing the name */
+    int     reads;          /* arguments reading it */
+    int     exprs;          /* live subexpressions reading it */
+    int     seen;           /* forward pass has met a definition */
+    char    *subst;         /* name or constant that replaces reads */
+} OPT_USE;
+
+typedef struct opt_expr {
+    char    *key;           /* opcode, output type and arguments */
+    TREE    *stmt;          /* statement computing it, NULL once killed */
+    int     shared;         /* reads globals, p-fields or unknown names */
+    struct opt_expr *next;
+} OPT_EXPR;
+
+typedef struct {
+    int         level;
+    TYPE_TABLE  *typeTable;
+    CS_VAR_POOL *pool;      /* locals of the body being optimised */
+    CS_HASH_TABLE *uses;    /* name -> OPT_USE */
+    CS_HASH_TABLE *cse;     /* key -> OPT_EXPR */
+    OPT_EXPR    *exprs;     /* expressions of the current block */
+    int         nshared;
+    int         hoist;      /* no init jumps or reinit in the body */
+    int         folded, merged, dead, hoisted;
+} OPT_STATE;
+
+static int is_constant_arg(char *s)
+{
+    char c = *s;
+    /* as in lgbuild(); 0dbfs is a name */
+    return ((c >= '1' && c <= '9') || c == '.' || c == '-' || c == '+' ||
+            (c == '0' && strcmp(s, "0dbfs") != 0));
+}
+
+static int is_name_arg(char *s)
+{
+    return (*s != '\0' && *s != '"' && !is_constant_arg(s));
+}
+
+static int is_pfield_arg(char *s)
+{
+    if (*s++ != 'p' || *s == '\0') return 0;
+    while (*s >= '0' && *s <= '9') s++;
+    return (*s == '\0');
+}
+
+static int is_leaf_list(TREE *arg)
+{
+    for (; arg != NULL; arg = arg->next)
+      if (arg->left != NULL || arg->right != NULL ||
+          arg->value == NULL || arg->value->lexeme == NULL)
+        return 0;
+    return 1;
+}
+
+static int is_statement(TREE *s)
+{
+    return (s->type == T_OPCODE || s->type == T_OPCODE0 || s->type == '=');
+}
+
+static OPT_USE *get_use(CSOUND *csound, OPT_STATE *st, char *name, int create)
+{
+    OPT_USE *u = cs_hash_table_get(csound, st->uses, name);
+    if (u == NULL && create) {
+      u = mzone_alloc(csound, mzone_compile(csound), sizeof(OPT_USE));
+      cs_hash_table_put(csound, st->uses, name, u);
+    }
+    return u;
+}
+
+/* type letter of a local variable, 0 for anything else */
+static char local_type(CSOUND *csound, OPT_STATE *st, char *name)
+{
+    CS_VARIABLE *var = cs_hash_table_get(csound, st->pool->table, name);
+    return (var == NULL) ? 0 : var->varType->varTypeName[0];
+}
+
+static void count_args(CSOUND *csound, OPT_STATE *st, TREE *arg,
+                       int def, int delta)
+{
+    for (; arg != NULL; arg = arg->next) {
+      if (arg->value != NULL && arg->value->lexeme != NULL &&
+          is_name_arg(arg->value->lexeme)) {
+        OPT_USE *u = get_use(csound, st, arg->value->lexeme, 1);
+        if (def) u->defs += delta;
+        else u->reads += delta;
+      }
+      count_args(csound, st, arg->left, 0, delta);
+      count_args(csound, st, arg->right, 0, delta);
+    }
+}
+
+/* opcodes that write their first input in place: it counts as a
+   definition, so nothing reading it is taken for single-assignment */
+static int modifies_input(TREE *s)
+{
+    char *op;
+
+    if (!is_statement(s) || s->value == NULL || s->value->lexeme == NULL)
+      return 0;
+    op = s->value->lexeme;
+    return (strcmp(op, "loop_lt") == 0 || strcmp(op, "loop_le") == 0 ||
+            strcmp(op, "loop_gt") == 0 || strcmp(op, "loop_ge") == 0 ||
+            strcmp(op, "vincr") == 0);
+}
+
+/* a statement that may be merged or removed: one of pure_opcodes[]
+   writing a single scalar local variable from plain arguments */
+static int is_pure(CSOUND *csound, OPT_STATE *st, TREE *s)
+{
+    char *out, t;
+    int i;
+
+    if (!is_statement(s) || s->value == NULL || s->markup == NULL ||
+        s->left == NULL || s->left->next != NULL ||
+        !is_leaf_list(s->left) || !is_leaf_list(s->right))
+      return 0;
+    for (i = 0; pure_opcodes[i] != NULL; i++)
+      if (strcmp(s->value->lexeme, pure_opcodes[i]) == 0) break;
+    if (pure_opcodes[i] == NULL) return 0;
+    out = s->left->value->lexeme;
+    if (is_pfield_arg(out)) return 0;
+    t = local_type(csound, st, out);
+    return (t == 'i' || t == 'k' || t == 'a');
+}
+
+static char *fold_constant(CSOUND *csound, TREE *s)
+{
+    char    *op = s->value->lexeme, buf[32];
+    TREE    *a = s->right, *b;
+    MYFLT   x, y, r;
+
+    if (a == NULL || (b = a->next) == NULL || b->next != NULL ||
+        !is_constant_arg(a->value->lexeme) ||
+        !is_constant_arg(b->value->lexeme))
+      return NULL;
+    /* round as the constant pool does */
+    x = (MYFLT) cs_strtod(a->value->lexeme, NULL);
+    y = (MYFLT) cs_strtod(b->value->lexeme, NULL);
+    if (strcmp(op, "##add") == 0) r = x + y;
+    else if (strcmp(op, "##sub") == 0) r = x - y;
+    else if (strcmp(op, "##mul") == 0) r = x * y;
+    else if (strcmp(op, "##div") == 0 && y != FL(0.0)) r = x / y;
+    else return NULL;
+    if (!isfinite(r)) return NULL;
+    snprintf(buf, 32, "%.17g", (double) r);
+    return cs_strdup(csound, buf);
+}
+
+static void substitute_args(CSOUND *csound, OPT_STATE *st, TREE *arg)
+{
+    for (; arg != NULL; arg = arg->next) {
+      OPT_USE *u;
+      char *s;
+
+      if (arg->left != NULL || arg->right != NULL || arg->value == NULL ||
+          (s = arg->value->lexeme) == NULL || !is_name_arg(s) ||
+          (u = get_use(csound, st, s, 0)) == NULL || u->subst == NULL)
+        continue;
+      u->reads--;
+      if (is_constant_arg(u->subst)) {
+        arg->type = NUMBER_TOKEN;
+        arg->value = make_num(csound, u->subst);
+      }
+      else {
+        arg->type = T_IDENT;
+        arg->value = make_token(csound, u->subst);
+        arg->value->type = T_IDENT;
+        get_use(csound, st, u->subst, 1)->reads++;
+      }
+    }
+}
+
+static char *cse_key(CSOUND *csound, OPT_STATE *st, TREE *s)
+{
+    char    *key, *out = s->left->value->lexeme;
+    size_t  len = strlen(s->value->lexeme) + 4;
+    TREE    *arg;
+
+    for (arg = s->right; arg != NULL; arg = arg->next)
+      len += strlen(arg->value->lexeme) + 1;
+    key = mzone_alloc(csound, mzone_compile(csound), len);
+    snprintf(key, len, "%s:%c", s->value->lexeme, local_type(csound, st, out));
+    for (arg = s->right; arg != NULL; arg = arg->next) {
+      strcat(key, ",");
+      strcat(key, arg->value->lexeme);
+    }
+    return key;
+}
+
+static void cse_kill(CSOUND *csound, OPT_STATE *st, OPT_EXPR *e)
+{
+    TREE *arg;
+
+    for (arg = e->stmt->right; arg != NULL; arg = arg->next)
+      if (is_name_arg(arg->value->lexeme))
+        get_use(csound, st, arg->value->lexeme, 0)->exprs--;
+    if (e->shared) st->nshared--;
+    cs_hash_table_remove(csound, st->cse, e->key);
+    e->stmt = NULL;
+}
+
+static void cse_add(CSOUND *csound, OPT_STATE *st, TREE *s, char *key)
+{
+    OPT_EXPR *e = mzone_alloc(csound, mzone_compile(csound),
+                              sizeof(OPT_EXPR));
+    TREE *arg;
+
+    e->key = key;
+    e->stmt = s;
+    for (arg = s->right; arg != NULL; arg = arg->next) {
+      char *name = arg->value->lexeme;
+      if (!is_name_arg(name)) continue;
+      get_use(csound, st, name, 0)->exprs++;
+      if (is_pfield_arg(name) || !local_type(csound, st, name))
+        e->shared = 1;
+    }
+    if (e->shared) st->nshared++;
+    e->next = st->exprs;
+    st->exprs = e;
+    cs_hash_table_put(csound, st->cse, key, e);
+}
+
+/* start a new block: no expression computed so far is available */
+static void cse_reset(CSOUND *csound, OPT_STATE *st)
+{
+    OPT_EXPR *e = st->exprs, *next;
+
+    while (e != NULL) {
+      next = e->next;
+      if (e->stmt != NULL) cse_kill(csound, st, e);
+      e = next;
+    }
+    st->exprs = NULL;
+}
+
+/* forget expressions reading name (or any shared name if name is NULL) */
+static void cse_invalidate(CSOUND *csound, OPT_STATE *st, char *name)
+{
+    OPT_EXPR *e;
+
+    if (name != NULL) {
+      OPT_USE *u = get_use(csound, st, name, 0);
+      if (u == NULL || u->exprs == 0) return;
+    }
+    else if (st->nshared == 0) return;
+    for (e = st->exprs; e != NULL; e = e->next) {
+      TREE *arg;
+      if (e->stmt == NULL) continue;
+      if (name == NULL) {
+        if (e->shared) cse_kill(csound, st, e);
+        continue;
+      }
+      for (arg = e->stmt->right; arg != NULL; arg = arg->next)
+        if (strcmp(arg->value->lexeme, name) == 0) {
+          cse_kill(csound, st, e);
+          break;
+        }
+    }
+}
+
+static void invalidate_args(CSOUND *csound, OPT_STATE *st, TREE *arg,
+                            int temps)
+{
+    for (; arg != NULL; arg = arg->next) {
+      if (arg->value != NULL && arg->value->lexeme != NULL &&
+          is_name_arg(arg->value->lexeme) &&
+          (temps || arg->value->lexeme[0] != '#'))
+        cse_invalidate(csound, st, arg->value->lexeme);
+      invalidate_args(csound, st, arg->left, temps);
+      invalidate_args(csound, st, arg->right, temps);
+    }
+}
+
+/* Jumps taken in the init pass only: a k-rate statement they skip still
+   runs at performance time, so it cannot be moved to the init pass. */
+static int is_init_jump(char *op)
+{
+    return (strcmp(op, "igoto") == 0 || strcmp(op, "cigoto") == 0 ||
+            strcmp(op, "cingoto") == 0 || strcmp(op, "tigoto") == 0 ||
+            strcmp(op, "rigoto") == 0 || strcmp(op, "reinit") == 0 ||
+            strcmp(op, "rireturn") == 0 || strcmp(op, "loop_lt") == 0 ||
+            strcmp(op, "loop_le") == 0 || strcmp(op, "loop_gt") == 0 ||
+            strcmp(op, "loop_ge") == 0);
+}
+
+/* an init-time jump or reinit anywhere in the body, including inside
+   if/while blocks, means an i-rate value may be recomputed or skipped
+   while a hoisted statement keeps its first value */
+static int has_init_jump(TREE *s)
+{
+    for ( ; s != NULL; s = s->next) {
+      if (is_statement(s)) {
+        if (s->value != NULL && s->value->lexeme != NULL &&
+            is_init_jump(s->value->lexeme))
+          return 1;
+      }
+      else if (has_init_jump(s->left) || has_init_jump(s->right))
+        return 1;
+    }
+    return 0;
+}
+
+/* Move a k-rate computation on values that are fixed after the init pass
+   to the init pass, writing a new i-rate temporary instead. p3 is left
+   alone as xtratim and friends may still change it at init time. */
+static void hoist_statement(CSOUND *csound, OPT_STATE *st, TREE *s)
+{
+    char        types[64], *out = s->left->value->lexeme, *name;
+    int         n = 0;
+    TREE        *arg;
+    OENTRY      *oentry;
+    OPT_USE     *u;
+    TYPE_TABLE  typeTable;
+
+    if (out[0] != '#' || local_type(csound, st, out) != 'k' ||
+        strcmp(s->value->lexeme, "##fuse") == 0)
+      return;
+    for (arg = s->right; arg != NULL; arg = arg->next) {
+      char *a = arg->value->lexeme;
+      if (n == 63) return;
+      if (is_constant_arg(a)) types[n++] = 'c';
+      else if (is_pfield_arg(a) && strcmp(a, "p3") != 0) types[n++] = 'p';
+      else if (local_type(csound, st, a) == 'i' &&
+               (u = get_use(csound, st, a, 0))->seen && u->defs == 1)
+        types[n++] = 'i';
+      else return;
+    }
+    types[n] = '\0';
+    oentry = resolve_opcode(csound, find_opcode2(csound, s->value->lexeme),
+                            "i", types);
+    if (oentry == NULL) return;
+
+    typeTable = *st->typeTable;
+    typeTable.localPool = st->pool;
+    name = create_out_arg(csound, "i", &typeTable);
+    u = get_use(csound, st, out, 0);
+    u->defs--;
+    u->subst = name;
+    get_use(csound, st, name, 1)->defs++;
+    s->left->value = make_token(csound, name);
+    s->left->value->type = T_IDENT;
+    s->markup = oentry;
+    st->hoisted++;
+}
+
+static TREE *forward_pass(CSOUND *csound, OPT_STATE *st, TREE *body)
+{
+    TREE *s, *prev = NULL, *next, *arg;
+
+    for (s = body; s != NULL; s = next) {
+      int pure;
+      next = s->next;
+      if (!is_statement(s)) {           /* labels start a new block */
+        cse_reset(csound, st);
+        prev = s;
+        continue;
+      }
+      substitute_args(csound, st, s->right);
+      pure = is_pure(csound, st, s);
+      if (pure && s->left->value->lexeme[0] == '#' &&
+          get_use(csound, st, s->left->value->lexeme, 0)->defs == 1) {
+        OPT_USE *u = get_use(csound, st, s->left->value->lexeme, 0);
+        OPT_USE *orig = u;
+        char *val = fold_constant(csound, s);
+        OPT_EXPR *e = NULL;
+        char *key = NULL;
+
+        if (val == NULL && st->level >= 2) {
+          if (st->hoist) hoist_statement(csound, st, s);
+          u = get_use(csound, st, s->left->value->lexeme, 0);
+          key = cse_key(csound, st, s);
+          e = cs_hash_table_get(csound, st->cse, key);
+          if (e != NULL) val = cs_strdup(csound, e->stmt->left->value->lexeme);
+        }
+        if (val != NULL) {
+          if (e != NULL) st->merged++;
+          else st->folded++;
+          u->subst = orig->subst = val;
+          count_args(csound, st, s->left, 1, -1);
+          count_args(csound, st, s->right, 0, -1);
+          if (prev != NULL) prev->next = next;
+          else body = next;
+          continue;
+        }
+        if (key != NULL) cse_add(csound, st, s, key);
+      }
+      /* values read by the expressions still available */
+      invalidate_args(csound, st, s->left, 1);
+      if (!pure) {
+        invalidate_args(csound, st, s->right, 0);
+        cse_invalidate(csound, st, NULL);
+      }
+      for (arg = s->left; arg != NULL; arg = arg->next)
+        if (arg->value != NULL && arg->value->lexeme != NULL &&
+            is_name_arg(arg->value->lexeme))
+          get_use(csound, st, arg->value->lexeme, 1)->seen = 1;
+      prev = s;
+    }
+    cse_reset(csound, st);
+    return body;
+}
+
+static TREE *dead_code_pass(CSOUND *csound, OPT_STATE *st, TREE *body)
+{
+    TREE    *s, *prev, *next;
+    int     changed;
+
+    do {
+      changed = 0;
+      prev = NULL;
+      for (s = body; s != NULL; s = next) {
+        next = s->next;
+        if (is_pure(csound, st, s)) {
+          char *out = s->left->value->lexeme;
+          if (get_use(csound, st, out, 0)->reads == 0 &&
+              (out[0] == '#' || st->level >= 2)) {
+            count_args(csound, st, s->left, 1, -1);
+            count_args(csound, st, s->right, 0, -1);
+            if (prev != NULL) prev->next = next;
+            else body = next;
+            st->dead++;
+            changed = 1;
+            continue;
+          }
+        }
+        prev = s;
+      }
+    } while (changed);
+    return body;
+}
+
+/* drop locals that no statement mentions any more */
+static void remove_unused_vars(CSOUND *csound, OPT_STATE *st)
+{
+    CONS_CELL *keys = cs_hash_table_keys(csound, st->uses), *c;
+
+    for (c = keys; c != NULL; c = c->next) {
+      char *name = (char *) c->value;
+      OPT_USE *u = get_use(csound, st, name, 0);
+      CS_VARIABLE *var;
+      if (u->reads == 0 && u->defs == 0 &&
+          (var = cs_hash_table_get(csound, st->pool->table, name)) != NULL)
+        csoundRemoveVariable(csound, st->pool, var);
+    }
+    cs_cons_free(csound, keys);
+}
+
+static TREE *optimize_body(CSOUND *csound, OPT_STATE *st, TREE *body,
+                           CS_VAR_POOL *pool)
+{
+    TREE *s;
+
+    st->pool = pool;
+    st->uses = cs_hash_table_create(csound);
+    st->cse = cs_hash_table_create(csound);
+    st->hoist = !has_init_jump(body);
+    for (s = body; s != NULL; s = s->next) {
+      count_args(csound, st, s->left, is_statement(s), 1);
+      count_args(csound, st, s->right, 0, 1);
+      if (modifies_input(s) && s->right != NULL &&
+          s->right->value != NULL && s->right->value->lexeme != NULL &&
+          is_name_arg(s->right->value->lexeme))
+        get_use(csound, st, s->right->value->lexeme, 1)->defs++;
+    }
+    body = forward_pass(csound, st, body);
+    body = dead_code_pass(csound, st, body);
+    remove_unused_vars(csound, st);
+    cs_hash_table_free(csound, st->cse);
+    cs_hash_table_free(csound, st->uses);
+    return body;
+}
+
 /* Optimizes tree (expressions, etc.) */
-TREE * csound_orc_optimize(CSOUND *csound, TREE *root)
+TREE * csound_orc_optimize(CSOUND *csound, TREE *root, TYPE_TABLE *typeTable)
 {
     TREE *original=root, *last = NULL;
+    OPT_STATE st;
+
     while (root) {
         TREE *xx = verify_tree1(csound, root);
         if (xx != root) {
@@ -230,5 +742,25 @@ TREE * csound_orc_optimize(CSOUND *csound, TREE *root)
         last = root;
         root = root->next;
     }
+
+    if (csound->oparmsExt.optLevel <= 0) return original;
+    memset(&st, 0, sizeof(OPT_STATE));
+    st.level = csound->oparmsExt.optLevel;
+    st.typeTable = typeTable;
+    for (root = original; root != NULL; root = root->next) {
+      if ((root->type == INSTR_TOKEN || root->type == UDO_TOKEN) &&
+          root->markup != NULL)
+        root->right = optimize_body(csound, &st, root->right,
+                                    (CS_VAR_POOL *) root->markup);
+    }
+    /* use counts and expression keys are not needed past this point */
+    mzone_reset(csound, mzone_compile(csound));
+    if (st.folded + st.merged + st.dead + st.hoisted > 0)
+      csound->Message(csound,
+                      Str("optimiser (level %d): %d opcodes eliminated "
+                          "(%d folded, %d common subexpressions, %d unused), "
+                          "%d moved to init time\n"),
+                      st.level, st.folded + st.merged + st.dead,
+                      st.folded, st.merged, st.dead, st.hoisted);
     return original;
 }
@@ -230,6 +230,28 @@ int csoundAddVariable(CSOUND* csound, CS_VAR_POOL* pool, CS_VARIABLE* var) {
   } else return -1;
 }
 
+int csoundRemoveVariable(CSOUND* csound, CS_VAR_POOL* pool, CS_VARIABLE* var) {
+    CS_VARIABLE* current = pool->head;
+    CS_VARIABLE* previous = NULL;
+
+    while (current != NULL && current != var) {
+      previous = current;
+      current = current->next;
+    }
+    if (current == NULL) return -1;
+
+    if (previous == NULL) pool->head = var->next;
+    else previous->next = var->next;
+    if (pool->tail == var) pool->tail = previous;
+    cs_hash_table_remove(csound, pool->table, var->varName);
+    // memory indices are reassigned by recalculateVarPoolMemory
+    pool->poolSize -= var->memBlockSize;
+    pool->varCount -= 1;
+    csound->Free(csound, var->varName);
+    csound->Free(csound, var);
+    return 0;
+}
+
 void recalculateVarPoolMemory(void* csound, CS_VAR_POOL* pool)
 {
     CS_VARIABLE* current = pool->head;
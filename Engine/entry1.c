@@ -219,6 +219,7 @@ OENTRY opcodlst_1[] = {
   { "##mul.aa",  S(AOP),0,    4,      "a",    "aa",   NULL,   NULL,   mulaa   },
   { "##div.aa",  S(AOP),0,    4,      "a",    "aa",   NULL,   NULL,   divaa   },
   { "##mod.aa",  S(AOP),0,    4,      "a",    "aa",   NULL,   NULL,   modaa   },
+  { "##fuse",    S(FUSEOP),0, 5,      "a",    "SM",   fuse_init, NULL, fuse_perf },
   { "divz",   0xfffc                                                      },
   { "divz.ii", S(DIVZ),0,   1,      "i",    "iii",  divzkk, NULL,   NULL    },
   { "divz.kk", S(DIVZ),0,   2,      "k",    "kkk",  NULL,   divzkk, NULL    },
@@ -33,6 +33,11 @@
 
 #include "namedins.h"
 
+/* the chain of open files; a score sorted ahead (--score-stream) opens
+   its #include files on a thread of its own */
+#define FILES_SPINLOCK csoundSpinLock(&csound->spinlock1);
+#define FILES_SPINUNLOCK csoundSpinUnLock(&csound->spinlock1);
+
 /* list of environment variables used by Csound */
 
 static const char *envVar_list[] = {
@@ -1041,7 +1046,7 @@ void *csoundFileOpenWithType(CSOUND *csound, void *fd, int type,
     p = (CSFILE*) csound->Malloc(csound, (size_t) nbytes);
     if (UNLIKELY(p == NULL))
       goto err_return;
-    p->nxt = (CSFILE*) csound->open_files;
+    p->nxt = (CSFILE*) NULL;
     p->prv = (CSFILE*) NULL;
     p->type = type;
     p->fd = tmp_fd;
@@ -1108,9 +1113,12 @@ void *csoundFileOpenWithType(CSOUND *csound, void *fd, int type,
         *((int*) fd) = tmp_fd;
     }
     /* link into chain of open files */
+    FILES_SPINLOCK
+    p->nxt = (CSFILE*) csound->open_files;
     if (csound->open_files != NULL)
       ((CSFILE*) csound->open_files)->prv = p;
     csound->open_files = (void*) p;
+    FILES_SPINUNLOCK
     /* notify the host if it asked */
     if (csound->FileOpenCallback_ != NULL) {
       int writing = (type == CSFILE_SND_W || type == CSFILE_FD_W ||
@@ -1172,7 +1180,7 @@ void *csoundCreateFileHandle(CSOUND *csound,
     p = (CSFILE*) csound->Malloc(csound, (size_t) nbytes);
     if (p == NULL)
       return NULL;
-    p->nxt = (CSFILE*) csound->open_files;
+    p->nxt = (CSFILE*) NULL;
     p->prv = (CSFILE*) NULL;
     p->type = type;
     p->fd = -1;
@@ -1200,9 +1208,12 @@ void *csoundCreateFileHandle(CSOUND *csound,
         return NULL;
     }
     /* link into chain of open files */
+    FILES_SPINLOCK
+    p->nxt = (CSFILE*) csound->open_files;
     if (csound->open_files != NULL)
       ((CSFILE*) csound->open_files)->prv = p;
     csound->open_files = (void*) p;
+    FILES_SPINUNLOCK
     /* return with opaque file handle */
     p->cb = NULL;
     return (void*) p;
@@ -1246,12 +1257,14 @@ int csoundFileClose(CSOUND *csound, void *fd)
         break;
     }
     /* unlink from chain of open files */
+    FILES_SPINLOCK
     if (p->prv == NULL)
       csound->open_files = (void*) p->nxt;
     else
       p->prv->nxt = p->nxt;
     if (p->nxt != NULL)
       p->nxt->prv = p->prv;
+    FILES_SPINUNLOCK
     if(p->buf != NULL) csound->Free(csound, p->buf);
     p->bufsize = 0;
     csound->DestroyCircularBuffer(csound, p->cb);
@@ -1274,12 +1287,14 @@ int csoundFileClose(CSOUND *csound, void *fd)
         break;
     }
    /* unlink from chain of open files */
+    FILES_SPINLOCK
     if (p->prv == NULL)
       csound->open_files = (void*) p->nxt;
     else
       p->prv->nxt = p->nxt;
     if (p->nxt != NULL)
       p->nxt->prv = p->prv;
+    FILES_SPINUNLOCK
    }
     /* free allocated memory */
     csound->Free(csound, fd);
@@ -2726,9 +2726,14 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
         ftp->end1 = ftp->flenfrms;      /* Greg Sullivan */
       }
     }
-    /* read sound with opt gain */
+    /* read sound with opt gain, from the sample cache if there is one */
 
-    if (UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable, table_length, p)) < 0)) {
+    if (csound->oparmsExt.sampleCache != NULL)
+      inlocs = getsndin_cached(csound, ftp->ftable, table_length, p);
+    else
+      inlocs = -1;
+    if (inlocs < 0 &&
+        UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable, table_length, p)) < 0)) {
       return fterror(ff, Str("GEN1 read error"));
     }
 
@@ -40,6 +40,10 @@ static  void    schedofftim(CSOUND *, INSDS *);
 void    beatexpire(CSOUND *, double);
 void    timexpire(CSOUND *, double);
 static  void    instance(CSOUND *, int);
+static  void    instance_release(INSTRTXT *, INSDS *);
+void    init_queue_push(CSOUND *, INSDS *);
+void    init_queue_purge(CSOUND *);
+void    instance_slabs_free(CSOUND *, INSTRTXT *);
 extern int argsRequired(char* argString);
 
 int init0(CSOUND *csound)
@@ -184,6 +188,7 @@ int insert(CSOUND *csound, int insno, EVTBLK *newevtp)
     tp->act_instance = ip->nxtact;
     ip->insno = (int16) insno;
     ip->ksmps = csound->ksmps;
+    ip->perfadr = O->sampleAccurate ? instr_perf_sa : instr_perf;
     ip->ekr = csound->ekr;
     ip->kcounter = csound->kcounter;
     ip->onedksmps = csound->onedksmps;
@@ -305,6 +310,7 @@ int insert(CSOUND *csound, int insno, EVTBLK *newevtp)
       ip->reinitflag = 0;
       csound->tieflag = csound->reinitflag = 0;
     }
+    else init_queue_push(csound, ip);
 
     if (UNLIKELY(csound->inerrcnt || ip->p3.value == FL(0.0))) {
       xturnoff_now(csound, ip);
@@ -492,6 +498,7 @@ int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
     ip->p2.value     = (MYFLT) (csound->icurTime/csound->esr - csound->timeOffs);
     ip->p3.value     = FL(-1.0);
     ip->ksmps = csound->ksmps;
+    ip->perfadr = O->sampleAccurate ? instr_perf_sa : instr_perf;
     ip->ekr = csound->ekr;
     ip->kcounter = csound->kcounter;
     ip->onedksmps = csound->onedksmps;
@@ -608,6 +615,7 @@ int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
       ip->tieflag = ip->reinitflag = 0;
       csound->tieflag = csound->reinitflag = 0;
     }
+    else init_queue_push(csound, ip);
 
     if (UNLIKELY(csound->inerrcnt)) {
       xturnoff_now(csound, ip);
@@ -827,6 +835,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
     INSTRTXT  *txtp;
     INSDS     *ip, *nxtip, *prvip, **prvnxtloc;
     int       cnt = 0;
+    init_queue_purge(csound);
     for (txtp = &(csound->engineState.instxtanchor);
          txtp != NULL;  txtp = txtp->nxtinstxt) {
       // csound->Message(csound, "txp=%p \n", txtp);
@@ -848,7 +857,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
               nxtip->prvinstance = prvip;
             *prvnxtloc = nxtip;
 
-            csound->Free(csound, (char *)ip);
+            instance_release(txtp, ip);
 
           }
           else {
@@ -1415,6 +1424,8 @@ int setksmpsset(CSOUND *csound, SETKSMPS *p)
 
     n = CS_KSMPS / l_ksmps;
     p->h.insdshead->xtratim *= n;
+    if (n > 1)
+      p->h.insdshead->perfadr = instr_perf_local;
     CS_KSMPS = l_ksmps;
     CS_ONEDKSMPS = FL(1.0) / (MYFLT) CS_KSMPS;
     CS_EKR = csound->esr / (MYFLT) CS_KSMPS;
@@ -2029,6 +2040,98 @@ int findLabelMemOffset(CSOUND* csound, INSTRTXT* ip, char* labelName) {
     return offset;
 }
 
+/* Instance memory is carved from a zone owned by the instrument
+   template.  Blocks released by orcompact() go onto the instrument's
+   free list and are handed out again before the zone grows, so note
+   turnover does not go back to the general allocator. */
+
+#define SLAB_ALIGN(n)   (((size_t) (n) + 15) & ~((size_t) 15))
+#define SLAB_MINBLOCKS  8
+
+/* upper bound on the length of an instance's perf chain */
+static int instance_opcount(INSTRTXT *tp)
+{
+    OPTXT   *optxt = (OPTXT*) tp;
+    int     n = 0;
+
+    while ((optxt = optxt->nxtop) != NULL)
+      n++;
+    return n;
+}
+
+static size_t instance_size(CSOUND *csound, INSTRTXT *tp)
+{
+    OPARMS  *O = csound->oparms;
+    int     n = 3, pextra, pextrab;
+
+    if (O->midiKey>n) n = O->midiKey;
+    if (O->midiKeyCps>n) n = O->midiKeyCps;
+    if (O->midiKeyOct>n) n = O->midiKeyOct;
+    if (O->midiKeyPch>n) n = O->midiKeyPch;
+    if (O->midiVelocity>n) n = O->midiVelocity;
+    if (O->midiVelocityAmp>n) n = O->midiVelocityAmp;
+    pextra = n-3;
+    pextrab = (tp->pmax > 3 ? (int) (tp->pmax - 3) * sizeof(CS_VAR_MEM) : 0);
+    return (size_t) sizeof(INSDS) + pextrab + pextra*sizeof(CS_VAR_MEM) +
+           tp->varPool->poolSize +
+           (tp->varPool->varCount * sizeof(MYFLT)) +
+           (tp->varPool->varCount * sizeof(CS_VARIABLE*)) +
+           SLAB_ALIGN(tp->opdstot) +
+           (instance_opcount(tp) + 1) * sizeof(OPDS*);
+}
+
+static void *instance_alloc(CSOUND *csound, INSTRTXT *tp)
+{
+    size_t      size = SLAB_ALIGN(instance_size(csound, tp));
+    void        *p;
+
+    if (UNLIKELY(size != tp->blocksize)) {
+      /* layout changed: blocks on the free list are the wrong size */
+      tp->free_blocks = NULL;
+      tp->blocksize = size;
+    }
+    if ((p = tp->free_blocks) != NULL) {
+      tp->free_blocks = *(void**) p;
+      memset(p, 0, size);
+      return p;
+    }
+    if (tp->zone == NULL)
+      tp->zone = mzone_create(csound, size * SLAB_MINBLOCKS);
+    return mzone_alloc(csound, tp->zone, size);
+}
+
+static void instance_release(INSTRTXT *tp, INSDS *ip)
+{
+    *(void**) ip = tp->free_blocks;
+    tp->free_blocks = (void*) ip;
+}
+
+/* release all instance memory owned by an instr template */
+
+void instance_slabs_free(CSOUND *csound, INSTRTXT *tp)
+{
+    mzone_destroy(csound, tp->zone);
+    tp->zone = NULL;
+    tp->free_blocks = NULL;
+    tp->blocksize = 0;
+}
+
+/* reserve room for n instances and touch every page of it, so that the
+   first notes of an instrument do not fault in fresh memory while
+   performing (--prefault-instances) */
+
+void instance_prefault(CSOUND *csound, INSTRTXT *tp, int n)
+{
+    size_t      size;
+
+    if (n <= 0 || tp->zone != NULL)
+      return;
+    size = SLAB_ALIGN(instance_size(csound, tp));
+    tp->blocksize = size;
+    tp->zone = mzone_create(csound, size * (size_t) n);
+    mzone_prefault(csound, tp->zone, size * (size_t) n);
+}
+
 /* create instance of an instr template */
 /*   allocates and sets up all pntrs    */
 
@@ -2063,11 +2166,7 @@ static void instance(CSOUND *csound, int insno)
     pextrab = ((i = tp->pmax - 3L) > 0 ? (int) i * sizeof(CS_VAR_MEM) : 0);
     /* alloc new space,  */
     pextent = sizeof(INSDS) + pextrab + pextra*sizeof(CS_VAR_MEM);
-    ip = (INSDS*) csound->Calloc(csound,
-                          (size_t) pextent + tp->varPool->poolSize +
-                                 (tp->varPool->varCount * sizeof(MYFLT)) +
-                                 (tp->varPool->varCount * sizeof(CS_VARIABLE*)) +
-                                 tp->opdstot);
+    ip = (INSDS*) instance_alloc(csound, tp);
     ip->csound = csound;
     ip->m_chnbp = (MCHNBLK*) NULL;
     ip->instr = tp;
@@ -2256,6 +2355,13 @@ static void instance(CSOUND *csound, int insno)
     if (UNLIKELY(nxtopds > opdslim))
       csoundDie(csound, Str("inconsistent opds total"));
 
+    /* copy the perf chain into a flat array after the opds, so that
+       kperf can step through it without chasing nxtp */
+    ip->perfops = (OPDS**) (opMemStart + SLAB_ALIGN(tp->opdstot));
+    n = 0;
+    for (opds = ip->nxtp; opds != NULL; opds = opds->nxtp)
+      ip->perfops[n++] = opds;
+    ip->perfops[n] = NULL;
 }
 
 
@@ -2307,6 +2413,7 @@ int delete_instr(CSOUND *csound, DELETEIN *p)
                  csound->engineState.instrtxtp[n] == NULL))
       return OK;                /* Instrument does not exist so noop */
     ip = csound->engineState.instrtxtp[n];
+    init_queue_purge(csound);
     active = ip->instance;
     while (active != NULL) {    /* Check there are no active instances */
       INSDS   *nxt = active->nxtinstance;
@@ -2327,9 +2434,9 @@ int delete_instr(CSOUND *csound, DELETEIN *p)
         fdchclose(csound, active);
       if (active->auxchp != NULL)
         auxchfree(csound, active);
-      csound->Free(csound, active);
       active = nxt;
     }
+    instance_slabs_free(csound, ip);
     csound->engineState.instrtxtp[n] = NULL;
     /* Now patch it out */
     for (txtp = &(csound->engineState.instxtanchor);
@@ -2417,37 +2524,158 @@ PUBLIC int csoundKillInstance(CSOUND *csound, MYFLT instr, char *instrName,
 
 
 
+/* In realtime mode, insert() and reinit hand instances to the init-pass
+   thread through a FIFO linked on INSDS.nxtinit, and wake the thread
+   with init_pass_signal.  An instance is queued at most once; if it is
+   deactivated before its turn it is skipped. */
+
+/* init_pass_signal is a counting wakeup built on a condition variable:
+   csoundNotifyThreadLock() is a plain mutex unlock on some platforms,
+   and the queue is notified from threads that do not hold the lock. */
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    int             pending;
+} INIT_SIGNAL;
+
+void *init_signal_create(void)
+{
+    INIT_SIGNAL *s = (INIT_SIGNAL*) calloc(1, sizeof(INIT_SIGNAL));
+
+    if (s != NULL) {
+      pthread_mutex_init(&s->lock, NULL);
+      pthread_cond_init(&s->cond, NULL);
+    }
+    return (void*) s;
+}
+
+void init_signal_notify(void *p)
+{
+    INIT_SIGNAL *s = (INIT_SIGNAL*) p;
+
+    pthread_mutex_lock(&s->lock);
+    s->pending = 1;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void init_signal_wait(void *p)
+{
+    INIT_SIGNAL *s = (INIT_SIGNAL*) p;
+
+    pthread_mutex_lock(&s->lock);
+    while (!s->pending)
+      pthread_cond_wait(&s->cond, &s->lock);
+    s->pending = 0;
+    pthread_mutex_unlock(&s->lock);
+}
+
+void init_signal_destroy(void *p)
+{
+    INIT_SIGNAL *s = (INIT_SIGNAL*) p;
+
+    if (s == NULL)
+      return;
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+}
+
+void init_queue_push(CSOUND *csound, INSDS *ip)
+{
+    if (csound->init_queue_lock != NULL)
+      csoundLockMutex(csound->init_queue_lock);
+    if (!ip->init_queued) {
+      ip->init_queued = 1;
+      ip->nxtinit = NULL;
+      if (csound->init_queue_tail != NULL)
+        csound->init_queue_tail->nxtinit = ip;
+      else
+        csound->init_queue_head = ip;
+      csound->init_queue_tail = ip;
+    }
+    if (csound->init_queue_lock != NULL)
+      csoundUnlockMutex(csound->init_queue_lock);
+    if (csound->init_pass_signal != NULL)
+      init_signal_notify(csound->init_pass_signal);
+}
+
+static INSDS *init_queue_pop(CSOUND *csound)
+{
+    INSDS *ip;
+
+    csoundLockMutex(csound->init_queue_lock);
+    if ((ip = csound->init_queue_head) != NULL) {
+      if ((csound->init_queue_head = ip->nxtinit) == NULL)
+        csound->init_queue_tail = NULL;
+      ip->nxtinit = NULL;
+      ip->init_queued = 0;
+    }
+    csoundUnlockMutex(csound->init_queue_lock);
+    return ip;
+}
+
+/* drop inactive instances from the queue before their memory is
+   released or reused by orcompact() or delete_instr().  An instance
+   already popped by the init-pass thread stays valid: released blocks
+   remain in their instrument's zone, and instruments are only deleted
+   with init_pass_threadlock held or from the init-pass thread itself. */
+
+void init_queue_purge(CSOUND *csound)
+{
+    INSDS *ip, **prv;
+
+    if (csound->init_queue_head == NULL)
+      return;
+    if (csound->init_queue_lock != NULL)
+      csoundLockMutex(csound->init_queue_lock);
+    prv = &csound->init_queue_head;
+    csound->init_queue_tail = NULL;
+    while ((ip = *prv) != NULL) {
+      if (!ip->actflg) {
+        *prv = ip->nxtinit;
+        ip->nxtinit = NULL;
+        ip->init_queued = 0;
+      }
+      else {
+        csound->init_queue_tail = ip;
+        prv = &ip->nxtinit;
+      }
+    }
+    if (csound->init_queue_lock != NULL)
+      csoundUnlockMutex(csound->init_queue_lock);
+}
+
 /**
    In realtime mode, this function takes care of the init pass in a
    separate thread.
-   Any new instances will have their init-pass code executed here.
+   Any new instances will have their init-pass code executed here,
+   as soon as insert() queues them.
    This thread is started by musmon() and killed by csoundCleanup()
 */
 void *init_pass_thread(void *p){
     CSOUND *csound = (CSOUND *) p;
     INSDS *ip;
     int done;
-    float wakeup = (1000*csound->ksmps/csound->esr);
     while (csound->init_pass_loop) {
-
-#if defined(MACOSX) || defined(LINUX) || defined(HAIKU)
-      usleep(1000*wakeup);
-#else
-      csoundSleep(((int)wakeup > 0) ? wakeup : 1);
-#endif
-      ip = csound->actanchor.nxtact;
-      /* do init pass for this instr */
-      while (ip != NULL){
-        INSDS *nxt = ip->nxtact;
+      init_signal_wait(csound->init_pass_signal);
+      for (;;) {
+        csoundLockMutex(csound->init_pass_threadlock);
+        if ((ip = init_queue_pop(csound)) == NULL) {
+          csoundUnlockMutex(csound->init_pass_threadlock);
+          break;
+        }
 #ifdef HAVE_ATOMIC_BUILTIN
         done = __sync_fetch_and_add((int *) &ip->init_done, 0);
 #else
         done = ip->init_done;
 #endif
-        if (done == 0) {
-          csoundLockMutex(csound->init_pass_threadlock);
+        if (done == 0 && ip->actflg) {
+          /* do init pass for this instr */
           csound->ids = (OPDS *) (ip->nxti);
           csound->curip = ip;
+          csound->reinitflag = ip->reinitflag;
           while (csound->ids != NULL) {
             if (UNLIKELY(csound->oparms->odebug))
               csound->Message(csound, "init %s:\n",
@@ -2464,12 +2692,10 @@ void *init_pass_thread(void *p){
           if (ip->reinitflag==1) {
             ip->reinitflag = 0;
           }
-          csoundUnlockMutex(csound->init_pass_threadlock);
+          csound->reinitflag = 0;
         }
-        ip = nxt;
-
+        csoundUnlockMutex(csound->init_pass_threadlock);
       }
-
     }
     return NULL;
 }
@@ -25,8 +25,9 @@
 #include "csoundCore.h"                 /*              MEMALLOC.C      */
 
 /* This code wraps malloc etc with maintaining a list of allocated memory
-   so it can be freed on a reset.  It would not be necessary with a zoned
-   allocator.
+   so it can be freed on a reset.  Memory that shares a lifetime can
+   instead be taken from a zone (see mzone_create() below), which has no
+   per-block header and does not touch the global list.
 */
 #if defined(BETA) && !defined(MEMDEBUG)
 #define MEMDEBUG  1
@@ -152,10 +153,9 @@ void mfree(CSOUND *csound, void *p)
       else
         MEMALLOC_DB = (void*)nxt;
     }
-    //csound->Message(csound, "free\n");
+    CSOUND_MEM_SPINUNLOCK
     /* free memory */
     free((void*) pp);
-    CSOUND_MEM_SPINUNLOCK
 }
 
 void *mrealloc(CSOUND *csound, void *oldp, size_t size)
@@ -216,9 +216,185 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
     return DATA_PTR(pp);
 }
 
+/* Zones: bump allocators over a list of chunks.  Allocation only moves
+   a pointer and frees nothing individually; the whole zone is released
+   with mzone_reset() or mzone_destroy().  A zone is not locked, so each
+   zone must be used by one thread at a time; the global memlock is only
+   taken when a zone is created or destroyed. */
+
+typedef struct memZoneChunk_s {
+    struct memZoneChunk_s   *nxt;       /* older chunk                  */
+    size_t                  size;       /* usable bytes                 */
+} memZoneChunk_t;
+
+struct memzone_s {
+    struct memzone_s        *prv, *nxt; /* all zones of this instance   */
+    memZoneChunk_t          *chunks;    /* current chunk first          */
+    unsigned char           *ptr, *end; /* free space in current chunk  */
+    size_t                  chunksize;  /* size of the next chunk       */
+};
+
+#define ZONE_ALIGN(n)   (((size_t) (n) + 15) & ~((size_t) 15))
+#define ZONE_HDR_SIZE   ZONE_ALIGN(sizeof(memZoneChunk_t))
+#define ZONE_MIN_CHUNK  ((size_t) 256)
+#define ZONE_MAX_CHUNK  ((size_t) 1 << 20)
+
+#define MEMZONE_DB      (csound->memzone_db)
+
+static void mzone_grow(CSOUND *csound, MEMZONE *z, size_t size)
+{
+    memZoneChunk_t  *c;
+    size_t          n = (size > z->chunksize ? size : z->chunksize);
+
+    if (UNLIKELY((c = (memZoneChunk_t*) malloc(ZONE_HDR_SIZE + n)) == NULL))
+      memdie(csound, n);
+    c->size = n;
+    c->nxt = z->chunks;
+    z->chunks = c;
+    z->ptr = (unsigned char*) c + ZONE_HDR_SIZE;
+    z->end = z->ptr + n;
+    if (z->chunksize < ZONE_MAX_CHUNK)
+      z->chunksize <<= 1;
+}
+
+MEMZONE *mzone_create(CSOUND *csound, size_t chunksize)
+{
+    MEMZONE *z;
+
+    if (UNLIKELY((z = (MEMZONE*) calloc(1, sizeof(MEMZONE))) == NULL))
+      memdie(csound, sizeof(MEMZONE));
+    z->chunksize = ZONE_ALIGN(chunksize < ZONE_MIN_CHUNK ?
+                              ZONE_MIN_CHUNK : chunksize);
+    CSOUND_MEM_SPINLOCK
+    z->nxt = (MEMZONE*) MEMZONE_DB;
+    if (z->nxt != NULL)
+      z->nxt->prv = z;
+    MEMZONE_DB = (void*) z;
+    CSOUND_MEM_SPINUNLOCK
+    return z;
+}
+
+/* returns zeroed memory aligned to 16 bytes */
+
+void *mzone_alloc(CSOUND *csound, MEMZONE *z, size_t size)
+{
+    void  *p;
+
+    size = ZONE_ALIGN(size);
+    if (UNLIKELY((size_t) (z->end - z->ptr) < size))
+      mzone_grow(csound, z, size);
+    p = (void*) z->ptr;
+    z->ptr += size;
+    memset(p, 0, size);
+    return p;
+}
+
+char *mzone_strdup(CSOUND *csound, MEMZONE *z, const char *s)
+{
+    size_t  n = strlen(s) + 1;
+
+    return (char*) memcpy(mzone_alloc(csound, z, n), s, n);
+}
+
+/* make sure the next size bytes can be allocated without a new chunk,
+   and touch them so that their pages are faulted in now */
+
+void mzone_prefault(CSOUND *csound, MEMZONE *z, size_t size)
+{
+    size = ZONE_ALIGN(size);
+    if ((size_t) (z->end - z->ptr) < size)
+      mzone_grow(csound, z, size);
+    memset(z->ptr, 0, size);
+}
+
+/* release everything allocated from a zone, keeping its newest chunk */
+
+void mzone_reset(CSOUND *csound, MEMZONE *z)
+{
+    memZoneChunk_t  *c, *nxt;
+
+    (void) csound;
+    if ((c = z->chunks) == NULL)
+      return;
+    nxt = c->nxt;
+    c->nxt = NULL;
+    z->ptr = (unsigned char*) c + ZONE_HDR_SIZE;
+    z->end = z->ptr + c->size;
+    while ((c = nxt) != NULL) {
+      nxt = c->nxt;
+      free((void*) c);
+    }
+}
+
+static void mzone_free_chunks(MEMZONE *z)
+{
+    memZoneChunk_t  *c, *nxt;
+
+    for (c = z->chunks; c != NULL; c = nxt) {
+      nxt = c->nxt;
+      free((void*) c);
+    }
+}
+
+void mzone_destroy(CSOUND *csound, MEMZONE *z)
+{
+    if (UNLIKELY(z == NULL))
+      return;
+    CSOUND_MEM_SPINLOCK
+    if (z->nxt != NULL)
+      z->nxt->prv = z->prv;
+    if (z->prv != NULL)
+      z->prv->nxt = z->nxt;
+    else
+      MEMZONE_DB = (void*) z->nxt;
+    CSOUND_MEM_SPINUNLOCK
+    mzone_free_chunks(z);
+    free((void*) z);
+}
+
+/* zone for small allocations that live until the next reset */
+
+MEMZONE *mzone_engine(CSOUND *csound)
+{
+    if (csound->engine_zone == NULL)
+      csound->engine_zone = mzone_create(csound, 1024);
+    return csound->engine_zone;
+}
+
+/* zone for temporaries of one orchestra compile, reset when it ends */
+
+MEMZONE *mzone_compile(CSOUND *csound)
+{
+    if (csound->compile_zone == NULL)
+      csound->compile_zone = mzone_create(csound, 4096);
+    return csound->compile_zone;
+}
+
+/* zone for allocations that last until the end of the performance */
+
+MEMZONE *mzone_perf(CSOUND *csound)
+{
+    if (csound->perf_zone == NULL)
+      csound->perf_zone = mzone_create(csound, 4096);
+    return csound->perf_zone;
+}
+
 void memRESET(CSOUND *csound)
 {
     memAllocBlock_t *pp, *nxtp;
+    MEMZONE         *z, *nxtz;
+
+    z = (MEMZONE*) MEMZONE_DB;
+    MEMZONE_DB = NULL;
+    csound->engine_zone = NULL;
+    csound->compile_zone = NULL;
+    csound->perf_zone = NULL;
+    while (z != NULL) {
+      nxtz = z->nxt;
+      mzone_free_chunks(z);
+      free((void*) z);
+      z = nxtz;
+    }
 
     pp = (memAllocBlock_t*) MEMALLOC_DB;
     MEMALLOC_DB = NULL;
@@ -29,6 +29,7 @@
 #include "lpc.h"
 #include "pstream.h"
 #include "namedins.h"
+#include "sndcache.h"
 #include <sndfile.h>
 #include <string.h>
 
@@ -574,6 +575,7 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
     void          *fd;
     SNDMEMFILE    *p = NULL;
     SF_INFO       tmp;
+    float         *mapped;
 
 
     if (UNLIKELY(fileName == NULL || fileName[0] == '\0'))
@@ -611,9 +613,13 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
                        fileName);
       return NULL;
     }
+    /* the decoded frames from the sample cache if there is one */
+    mapped = sndcache_get(csound, csound->GetFileName(fd), sfinfo);
+    /* data[1] holds the zero guard sample */
     p = (SNDMEMFILE*)
             csound->Malloc(csound, sizeof(SNDMEMFILE)
-                           + (size_t)  sfinfo->frames * sizeof(float));
+                           + (size_t) sfinfo->frames
+                             * (size_t) sfinfo->channels * sizeof(float));
     /* set parameters */
     p->name = (char*) csound->Malloc(csound, strlen(fileName) + 1);
     strcpy(p->name, fileName);
@@ -652,8 +658,14 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
         p->scaleFac = pow(10.0, (double) lpd.gain * 0.05);
       }
     }
-    if ((size_t) sf_readf_float(sf, &(p->data[0]), (sf_count_t) p->nFrames)
-        != p->nFrames) {
+    if (mapped != NULL) {
+      /* copied, so that data[] stays inline and writable */
+      memcpy(&(p->data[0]), mapped,
+             p->nFrames * (size_t) p->nChannels * sizeof(float));
+      sndcache_release(csound, mapped);
+    }
+    else if ((size_t) sf_readf_float(sf, &(p->data[0]),
+                                     (sf_count_t) p->nFrames) != p->nFrames) {
       csound->FileClose(csound, fd);
       csound->Free(csound, p->name);
       csound->Free(csound, p->fullName);
@@ -662,13 +674,20 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
                                fileName);
       return NULL;
     }
-    p->data[p->nFrames] = 0.0f;
+    p->data[p->nFrames * p->nChannels] = 0.0f;
     csound->FileClose(csound, fd);
-    csound->Message(csound, Str("File '%s' (sr = %d Hz, %d channel(s), %lu "
-                                "sample frames) loaded into memory\n"),
-                            p->fullName, (int) sfinfo->samplerate,
-                            (int) sfinfo->channels,
-                            (uint32) sfinfo->frames);
+    if (mapped != NULL)
+      csound->Message(csound, Str("File '%s' (sr = %d Hz, %d channel(s), %llu "
+                                  "sample frames) read from sample cache\n"),
+                              p->fullName, (int) sfinfo->samplerate,
+                              (int) sfinfo->channels,
+                              (unsigned long long) sfinfo->frames);
+    else
+      csound->Message(csound, Str("File '%s' (sr = %d Hz, %d channel(s), %lu "
+                                  "sample frames) loaded into memory\n"),
+                              p->fullName, (int) sfinfo->samplerate,
+                              (int) sfinfo->channels,
+                              (uint32) sfinfo->frames);
 
     /* link into database */
     cs_hash_table_put(csound, csound->sndmemfiles, (char*)fileName, p);
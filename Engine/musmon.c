@@ -352,8 +352,11 @@ int musmon(CSOUND *csound)
 #ifndef __EMSCRIPTEN__
     if(csound->realtime_audio_flag && csound->init_pass_loop == 0){
       extern void *init_pass_thread(void *);
+      extern void *init_signal_create(void);
       pthread_attr_t attr;
       csound->init_pass_threadlock = csoundCreateMutex(0);
+      csound->init_queue_lock = csoundCreateMutex(0);
+      csound->init_pass_signal = init_signal_create();
       csoundLockMutex(csound->init_pass_threadlock);
       csound->init_pass_loop = 1;
       csoundUnlockMutex(csound->init_pass_threadlock);
@@ -380,12 +383,66 @@ static void deactivate_all_notes(CSOUND *csound)
     }
 }
 
+/* Pending realtime events are kept in a binary min-heap ordered by
+   start k-cycle, with events due in the same k-cycle ordered by the
+   sequence number they were given on submission. */
+
+static inline int rt_evt_before(const EVTNODE *a, const EVTNODE *b)
+{
+    return (a->start_kcnt < b->start_kcnt ||
+            (a->start_kcnt == b->start_kcnt && a->seq < b->seq));
+}
+
+static void rt_evt_push(CSOUND *csound, EVTNODE *e)
+{
+    EVTNODE **heap;
+    int     i, parent;
+
+    if (UNLIKELY(csound->OrcTrigEvtsCnt >= csound->OrcTrigEvtsMax)) {
+      int n = (csound->OrcTrigEvtsMax ? csound->OrcTrigEvtsMax * 2 : 64);
+      csound->OrcTrigEvts = (EVTNODE**)
+        csound->ReAlloc(csound, csound->OrcTrigEvts, n * sizeof(EVTNODE*));
+      csound->OrcTrigEvtsMax = n;
+    }
+    heap = csound->OrcTrigEvts;
+    e->seq = csound->OrcTrigEvtsSeq++;
+    i = csound->OrcTrigEvtsCnt++;
+    while (i > 0) {                     /* sift up */
+      parent = (i - 1) >> 1;
+      if (!rt_evt_before(e, heap[parent]))
+        break;
+      heap[i] = heap[parent];
+      i = parent;
+    }
+    heap[i] = e;
+}
+
+static EVTNODE *rt_evt_pop(CSOUND *csound)
+{
+    EVTNODE **heap = csound->OrcTrigEvts;
+    EVTNODE *top = heap[0], *last;
+    int     i = 0, child, n;
+
+    n = --csound->OrcTrigEvtsCnt;
+    last = heap[n];
+    while ((child = 2 * i + 1) < n) {   /* sift down */
+      if (child + 1 < n && rt_evt_before(heap[child + 1], heap[child]))
+        child++;
+      if (!rt_evt_before(heap[child], last))
+        break;
+      heap[i] = heap[child];
+      i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
 static void delete_pending_rt_events(CSOUND *csound)
 {
-    EVTNODE *ep = csound->OrcTrigEvts;
+    int     i;
 
-    while (ep != NULL) {
-      EVTNODE *nxt = ep->nxt;
+    for (i = 0; i < csound->OrcTrigEvtsCnt; i++) {
+      EVTNODE *ep = csound->OrcTrigEvts[i];
       if (ep->evt.strarg != NULL) {
         free(ep->evt.strarg);
         ep->evt.strarg = NULL;
@@ -393,9 +450,8 @@ static void delete_pending_rt_events(CSOUND *csound)
       /* push to stack of free event nodes */
       ep->nxt = csound->freeEvtNodes;
       csound->freeEvtNodes = ep;
-      ep = nxt;
     }
-    csound->OrcTrigEvts = NULL;
+    csound->OrcTrigEvtsCnt = 0;
 }
 
 static void cs_beep(CSOUND *csound)
@@ -404,6 +460,8 @@ static void cs_beep(CSOUND *csound)
 }
 
 extern int UDPServerClose(CSOUND *csound);
+extern void init_signal_notify(void *);
+extern void init_signal_destroy(void *);
 PUBLIC int csoundCleanup(CSOUND *csound)
 {
     void    *p;
@@ -440,21 +498,27 @@ PUBLIC int csoundCleanup(CSOUND *csound)
       csoundLockMutex(csound->init_pass_threadlock);
       csound->init_pass_loop = 0;
       csoundUnlockMutex(csound->init_pass_threadlock);
+      init_signal_notify(csound->init_pass_signal);
       pthread_join(csound->init_pass_thread, NULL);
       csoundDestroyMutex(csound->init_pass_threadlock);
       csound->init_pass_threadlock = 0;
+      csoundDestroyMutex(csound->init_queue_lock);
+      csound->init_queue_lock = NULL;
+      init_signal_destroy(csound->init_pass_signal);
+      csound->init_pass_signal = NULL;
+      csound->init_queue_head = csound->init_queue_tail = NULL;
     }
 #endif
 
-    while (csound->freeEvtNodes != NULL) {
-      p = (void*) csound->freeEvtNodes;
-      csound->freeEvtNodes = ((EVTNODE*) p)->nxt;
-      free(p);
-    }
+    /* event nodes live in the performance zone */
+    csound->freeEvtNodes = NULL;
+    if (csound->perf_zone != NULL)
+      mzone_reset(csound, csound->perf_zone);
 
     orcompact(csound);
 
     corfile_rm(&csound->scstr);
+    scsortbin_rm(csound);
 
     /* print stats only if musmon was actually run */
     /* NOT SURE HOW   ************************** */
@@ -844,8 +908,8 @@ static int process_rt_event(CSOUND *csound, int sensType)
       print_amp_values(csound, 0);
     }
     if (sensType == 4) {                  /* RM: Realtime orc event   */
-      EVTNODE *e = csound->OrcTrigEvts;
-      /* RM: Events are sorted on insertion, so just check the first */
+      EVTNODE *e = csound->OrcTrigEvts[0];
+      /* RM: Events are kept in a heap, so just check the first */
       evt = &(e->evt);
       insno = (int)(evt->p[1]);
       if ((rfd = getRemoteInsRfd(csound, insno))) {
@@ -855,8 +919,8 @@ static int process_rt_event(CSOUND *csound, int sensType)
           insSendevt(csound, evt, rfd);  /* RM: or send to single remote Csound */
         return 0;
       }
-      /* pop from the list */
-      csound->OrcTrigEvts = e->nxt;
+      /* pop from the heap */
+      rt_evt_pop(csound);
       retval = process_score_event(csound, evt, 1);
       if (evt->strarg != NULL) {
         free(evt->strarg);
@@ -1035,6 +1099,10 @@ int sensevents(CSOUND *csound)
 
 
 
+    /* collect events queued by host threads */
+    if (csound->evt_queue != NULL)
+      event_queue_drain(csound);
+
     /* handle any real time events now: */
     /* FIXME: the initialisation pass of real time */
     /*   events is not sorted by instrument number */
@@ -1051,8 +1119,8 @@ int sensevents(CSOUND *csound)
         } while (fp != NULL);
       }
       /* check for pending real time events */
-      while (csound->OrcTrigEvts != NULL &&
-             csound->OrcTrigEvts->start_kcnt <=
+      while (csound->OrcTrigEvtsCnt > 0 &&
+             csound->OrcTrigEvts[0]->start_kcnt <=
              (uint32) csound->global_kcounter) {
         if ((retval = process_rt_event(csound, 4)) != 0)
           goto scode;
@@ -1172,7 +1240,7 @@ static inline uint64_t time2kcnt(CSOUND *csound, double tval)
 int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
 {
     double        start_time;
-    EVTNODE       *e, *prv;
+    EVTNODE       *e;
     CSOUND        *st = csound;
     MYFLT         *p;
     uint32        start_kcnt;
@@ -1184,11 +1252,8 @@ int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
       e = csound->freeEvtNodes;                     /*   if available       */
       csound->freeEvtNodes = e->nxt;
     }
-    else {
-      e = (EVTNODE*) calloc((size_t) 1, sizeof(EVTNODE)); /* or alloc new one */
-      if (UNLIKELY(e == NULL))
-        return CSOUND_MEMORY;
-    }
+    else                                  /* or alloc new one */
+      e = (EVTNODE*) mzone_alloc(csound, mzone_perf(csound), sizeof(EVTNODE));
     if (evt->strarg != NULL) {  /* copy string argument if present */
       /* NEED TO COPY WHOLE STRING STRUCTURE */
       int n = evt->scnt;
@@ -1196,7 +1261,8 @@ int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
       while (n--) { p += strlen(p)+1; };
       e->evt.strarg = (char*) malloc((size_t) (p-evt->strarg)+1);
       if (UNLIKELY(e->evt.strarg == NULL)) {
-        free(e);
+        e->nxt = csound->freeEvtNodes;
+        csound->freeEvtNodes = e;
         return CSOUND_MEMORY;
       }
       memcpy(e->evt.strarg, evt->strarg, p-evt->strarg+1 );
@@ -1284,18 +1350,7 @@ int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
     }
     /* queue new event */
     e->start_kcnt = start_kcnt;
-    prv = csound->OrcTrigEvts;
-    /* if list is empty, or at beginning of list: */
-    if (prv == NULL || start_kcnt < prv->start_kcnt) {
-      e->nxt = prv;
-      csound->OrcTrigEvts = e;
-    }
-    else {                                      /* otherwise sort by time */
-      while (prv->nxt != NULL && start_kcnt >= prv->nxt->start_kcnt)
-        prv = prv->nxt;
-      e->nxt = prv->nxt;
-      prv->nxt = e;
-    }
+    rt_evt_push(csound, e);
     /* Make sure sensevents() looks for RT events */
     csound->oparms->RTevents = 1;
     return 0;
@@ -1353,7 +1408,9 @@ void musmon_rewind_score(CSOUND *csound)
     csound->advanceCnt = 0;
     if (csound->csoundScoreOffsetSeconds_ > FL(0.0))
       csoundSetScoreOffsetSeconds(csound, csound->csoundScoreOffsetSeconds_);
-    if(csound->scstr)
+    if(csound->scbin)
+      scsortbin_rewind(csound);
+    else if(csound->scstr)
       corfile_rewind(csound->scstr);
     else csound->Warning(csound, Str("cannot rewind score: no score in memory \n"));
 }
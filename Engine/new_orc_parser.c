@@ -63,7 +63,7 @@ extern void init_symbtab(CSOUND*);
 extern void print_tree(CSOUND *, char *, TREE *);
 extern TREE* verify_tree(CSOUND *, TREE *, TYPE_TABLE*);
 extern TREE *csound_orc_expand_expressions(CSOUND *, TREE *);
-extern TREE* csound_orc_optimize(CSOUND *, TREE *);
+extern TREE* csound_orc_optimize(CSOUND *, TREE *, TYPE_TABLE *);
 extern void csp_orc_analyze_tree(CSOUND* csound, TREE* root);
 
 
@@ -283,7 +283,7 @@ TREE *csoundParseOrc(CSOUND *csound, const char *str)
         return NULL;
       }
 
-      astTree = csound_orc_optimize(csound, astTree);
+      astTree = csound_orc_optimize(csound, astTree, typeTable);
 
       // small hack: use an extra node as head of tree list to hold the
       // typeTable, to be used during compilation
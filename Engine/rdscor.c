@@ -119,6 +119,100 @@ static void dumpline(CSOUND *csound)    /* print the line while flushing it */
     csound->Message(csound, Str("\n\tremainder of line flushed\n"));
 }
 
+/* read the next event of a binary sorted score (see swritebin()); the
+   values are those scanflt() would have read from the text, so the EVTBLK
+   is filled as below */
+static int rdscorbin(CSOUND *csound, EVTBLK *e)
+{
+    SCOREBIN *b = csound->scbin;
+    SCOREBIN_REC *r;
+    MYFLT   *v;
+    int     i, n;
+
+    if (b->p >= b->len && !scsortbin_next(csound)) {
+      scsortbin_rm(csound);
+      return 0;
+    }
+    r = (SCOREBIN_REC*) (b->body + b->p);
+    v = (MYFLT*) (b->body + b->p + SCOREBIN_HDRSIZE);
+    b->p += r->size;
+    n = r->nvals;
+    csound->scnt = 0;
+    e->opcod = r->opcod;
+    switch (r->opcod) {
+    case 'e':
+      e->pcnt = 0;
+      return 1;
+    case 's':
+    case 't':
+    case 'y':
+      csound->warped = 0;
+      goto unwarped;
+    case 'w':
+      csound->warped = 1;       /* w statement is itself unwarped */
+    unwarped:
+      if (UNLIKELY(n >= PMAX)) {
+        csound->Message(csound, Str("ERROR: too many pfields: "
+                                    "%c event with %d\n"), r->opcod, n);
+        n = PMAX;
+      }
+      for (i = 0; i < n; i++)
+        e->p[i + 1] = v[i];
+      e->p2orig = e->p[2];
+      e->p3orig = e->p[3];
+      e->c.extra = NULL;
+      break;
+    default:
+      if (!csound->warped) goto unwarped;
+      free(e->c.extra);
+      e->c.extra = NULL;
+      /* p1, p2 orig, p2 warp, p3 orig, p3 warp, p4 ... */
+      if (n > 0) e->p[1] = v[0];
+      if (n > 1) e->p2orig = v[1];
+      if (n > 2) e->p[2] = v[2];
+      if (n > 3) e->p3orig = v[3];
+      if (n > 4) e->p[3] = v[4];
+      /* count the p-fields as p1 p2 p3 p4 ... */
+      n = (n > 4 ? n - 2 : n > 2 ? 2 : n > 0 ? 1 : 0);
+      if (n < PMAX) {
+        for (i = 4; i <= n; i++)
+          e->p[i] = v[i + 1];
+      }
+      else {                    /* p[PMAX] and the rest go in extra */
+        MYFLT *new;
+        for (i = 4; i <= PMAX; i++)
+          e->p[i] = v[i + 1];
+        new = (MYFLT*) malloc(sizeof(MYFLT) * (n - PMAX + 2));
+        if (new == NULL) {
+          fprintf(stderr, Str("Out of Memory\n"));
+          exit(7);
+        }
+        e->c.extra = new;
+        new[0] = (MYFLT) (n - PMAX + 1);
+        for (i = PMAX; i <= n; i++)
+          new[i - PMAX + 1] = v[i + 1];
+        n = PMAX;
+      }
+      e->pcnt = n;
+      if (e->pcnt >= PMAX) e->pcnt += e->c.extra[0];
+      goto setp;
+    }
+    e->pcnt = n;
+ setp:
+    if (!csound->csoundIsScorePending_ && e->opcod == 'i') {
+      /* FIXME: should pause and not mute */
+      e->opcod = 'f'; e->p[1] = FL(0.0); e->pcnt = 2; e->scnt = 0;
+      return 1;
+    }
+    if (r->nstrs > 0) {         /* if string arg present, save it */
+      e->strarg = csound->Malloc(csound, r->slen);
+      memcpy(e->strarg, (char*) (v + r->nvals), r->slen);
+      e->scnt = csound->scnt = r->nstrs;
+    }
+    else { e->strarg = NULL; e->scnt = 0; }
+    return 1;
+}
+
 int rdscor(CSOUND *csound, EVTBLK *e) /* read next score-line from scorefile */
                                       /*  & maintain section warped status   */
 {                                     /*      presumes good format if warped */
@@ -126,6 +220,8 @@ int rdscor(CSOUND *csound, EVTBLK *e) /* read next score-line from scorefile */
     int     c;
     e->pinstance = NULL;
 
+    if (csound->scbin != NULL)
+      return rdscorbin(csound, e);
     if (csound->scstr == NULL ||
         csound->scstr->body[0] == '\0') {   /* if no concurrent scorefile  */
       e->opcod = 'f';             /*     return an 'f 0 3600'    */
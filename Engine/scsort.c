@@ -27,6 +27,7 @@
 extern void sort(CSOUND*);
 extern void twarp(CSOUND*);
 extern void swritestr(CSOUND*, CORFIL *sco, int first);
+extern void swritebin(CSOUND*, SCOREBIN *bin);
 extern void sfree(CSOUND *csound);
 //extern void sread_init(CSOUND *csound);
 extern int  sread(CSOUND *csound);
@@ -35,18 +36,33 @@ extern int  sread(CSOUND *csound);
 /* reads,sorts,timewarps each score sect in turn */
 
 extern void sread_initstr(CSOUND *, CORFIL *sco);
+static struct SCORESTREAM_ *stream_lock(CSOUND *);
+static void stream_unlock(struct SCORESTREAM_ *);
+
 char *scsortstr(CSOUND *csound, CORFIL *scin)
 {
     int     n;
     int     m = 0, first = 0;
     CORFIL *sco;
+    struct SCORESTREAM_ *st;
+    jmp_buf errjmp;
 
     csound->scoreout = NULL;
-    if(csound->scstr == NULL && (csound->engineStatus & CS_STATE_COMP) == 0) {
+    if(csound->scstr == NULL && csound->scbin == NULL &&
+       (csound->engineStatus & CS_STATE_COMP) == 0) {
        first = 1;
        sco = csound->scstr = corfile_create_w();
     }
     else sco = corfile_create_w();
+    st = stream_lock(csound);           /* a streamed score sorting ahead */
+    if (st != NULL) {
+      if (setjmp(errjmp) != 0) {        /* a score error: unlock it first */
+        csound->sreadStatics.errjmp = NULL;
+        stream_unlock(st);
+        csound->LongJmp(csound, 1);
+      }
+      csound->sreadStatics.errjmp = &errjmp;
+    }
     csound->sectcnt = 0;
     sread_initstr(csound, scin);
 
@@ -63,6 +79,8 @@ char *scsortstr(CSOUND *csound, CORFIL *scin)
     }
     corfile_flush(sco);
     sfree(csound);
+    csound->sreadStatics.errjmp = NULL;
+    stream_unlock(st);
     if(first) return sco->body;
     else {
       char *str = strdup(sco->body);
@@ -71,3 +89,331 @@ char *scsortstr(CSOUND *csound, CORFIL *scin)
     }
 }
 
+/* the end of a binary score: an 'f' to keep an empty score going, and 'e' */
+static void scorebin_finish(SCOREBIN *bin, int m)
+{
+    if (m==0) {
+      scorebin_begin(bin, 'f');         /* f0 800000000000.0, ~25367 years */
+      scorebin_flt(bin, FL(0.0));
+      scorebin_flt(bin, FL(800000000000.0));
+      scorebin_end(bin);
+    }
+    scorebin_begin(bin, 'e');
+    scorebin_end(bin);
+}
+
+/* A score sorted one section at a time as it is played (--score-stream),
+   so that only the events of one section are held at once.  The sorter
+   keeps its state in csound->sreadStatics, which csoundReadScore() text
+   also uses, so the state of the stream is swapped in only while one of
+   its sections is read.  A thread of the stream sorts the next section
+   into ahead while the current one plays; lock is held while it does, and
+   by scsortstr(), so only one of them uses the sorter at a time.  The
+   stream has its own seed for ~, kept in start, so a rewind sorts the
+   same values again; a seed statement in the score sets that seed, not
+   the one of the orchestra. */
+typedef struct SCORESTREAM_ {
+    struct sreadStatics__ sread;        /* sorter state of the stream */
+    struct sreadStatics__ start;        /*   as it was at the start */
+    struct sreadStatics__ other;        /* state swapped out meanwhile */
+    CORFIL  *sco;
+    SRTBLK  *otherfrst;
+    int     sectcnt, othersectcnt;
+    int     m;                          /* sections sorted */
+    int     done;                       /* end of the score reached */
+    CSOUND  *csound;
+    SCOREBIN *ahead;                    /* the section after this one */
+    pthread_mutex_t lock;
+    pthread_cond_t  work, sorted;
+    pthread_t thread;
+    int     running;                    /* the thread is there */
+    int     want;                       /* ahead is to be sorted */
+    int     ready;                      /* ahead holds a section */
+    int     error;                      /*   or a score error */
+    int     quit;
+    jmp_buf errjmp;
+} SCORESTREAM;
+
+static void stream_in(CSOUND *csound, SCORESTREAM *st)
+{
+    st->other = csound->sreadStatics;
+    st->otherfrst = csound->frstbp;
+    st->othersectcnt = csound->sectcnt;
+    csound->sreadStatics = st->sread;
+    csound->sectcnt = st->sectcnt;
+}
+
+static void stream_out(CSOUND *csound, SCORESTREAM *st)
+{
+    st->sread = csound->sreadStatics;
+    st->sectcnt = csound->sectcnt;
+    csound->sreadStatics = st->other;
+    csound->frstbp = st->otherfrst;
+    csound->sectcnt = st->othersectcnt;
+}
+
+/* drop the input stack of the sorter, but not the score itself */
+static void stream_drop_input(CSOUND *csound)
+{
+    struct sreadStatics__ *s = &(csound->sreadStatics);
+
+    if (s->inputs == NULL)
+      return;
+    while (s->str != &(s->inputs[0])) {
+      corfile_rm(&(s->str->cf));
+      s->str--;
+    }
+    csound->Free(csound, s->inputs);
+    s->inputs = s->str = NULL;
+}
+
+/* with the stream swapped in: sort again from the start of the score */
+static void stream_start(CSOUND *csound, SCORESTREAM *st)
+{
+    char    *curmem = csound->sreadStatics.curmem;
+    char    *memend = csound->sreadStatics.memend;
+
+    stream_drop_input(csound);
+    csound->sreadStatics = st->start;
+    csound->sreadStatics.curmem = curmem;       /* reused by each section */
+    csound->sreadStatics.memend = memend;
+    corfile_rewind(st->sco);
+    csound->sectcnt = 0;
+    sread_initstr(csound, st->sco);
+    st->m = st->done = 0;
+}
+
+/* replace the events in bin by those of the next section of the stream */
+static void stream_section(CSOUND *csound, SCORESTREAM *st, SCOREBIN *bin)
+{
+    bin->len = bin->p = 0;
+    stream_in(csound, st);
+    if (sread(csound) > 0) {
+      sort(csound);
+      twarp(csound);
+      swritebin(csound, bin);
+      st->m++;
+    }
+    else {
+      scorebin_finish(bin, st->m);
+      st->done = 1;
+    }
+    stream_out(csound, st);
+}
+
+/* sorts the section after the one being played into st->ahead; a score
+   error comes back here, and scsortbin_next() reports it */
+static void *stream_thread(void *st_)
+{
+    SCORESTREAM *st = (SCORESTREAM*) st_;
+    CSOUND  *csound = st->csound;
+
+    pthread_mutex_lock(&st->lock);
+    while (1) {
+      while (!st->want && !st->quit)
+        pthread_cond_wait(&st->work, &st->lock);
+      if (st->quit)
+        break;
+      st->sread.errjmp = &(st->errjmp);
+      if (setjmp(st->errjmp) == 0)
+        stream_section(csound, st, st->ahead);
+      else {
+        stream_out(csound, st);         /* the sorter state stays broken */
+        st->error = st->done = 1;
+      }
+      st->sread.errjmp = NULL;
+      st->want = 0;
+      st->ready = 1;
+      pthread_cond_signal(&st->sorted);
+    }
+    pthread_mutex_unlock(&st->lock);
+    return NULL;
+}
+
+/* with st->lock held: have the thread sort the next section, if any */
+static void stream_ask(SCORESTREAM *st)
+{
+    st->ready = 0;
+    if (!st->done) {
+      st->want = 1;
+      pthread_cond_signal(&st->work);
+    }
+}
+
+/* As the first scsortstr(), but the sorted score is left in
+   csound->scbin as binary events for rdscor(), with no text; for when
+   nothing needs the sorted text (score.srt, extract, cscore).  With
+   --score-stream only the first section is sorted here, and the rest
+   ahead of rdscor() by the thread of the stream. */
+void scsortbin(CSOUND *csound, CORFIL *scin)
+{
+    int     n;
+    int     m = 0;
+    SCOREBIN *bin;
+
+    csound->scoreout = NULL;
+    bin = csound->scbin = scorebin_create();
+    if (csound->oparmsExt.scoreStream) {
+      SCORESTREAM *st =
+        (SCORESTREAM*) csound->Calloc(csound, sizeof(SCORESTREAM));
+      st->csound = csound;
+      st->sco = scin;                   /* the stream owns the score now */
+      if (csound->scorestr == scin)
+        csound->scorestr = NULL;
+      st->start = csound->sreadStatics;
+      st->start.curmem = st->start.memend = NULL;
+      st->start.inputs = st->start.str = NULL;
+      st->start.randSeed = csound->randSeed1;
+      st->start.ownSeed = 1;
+      st->start.errjmp = NULL;
+      st->sread = st->start;
+      bin->stream = (void*) st;
+      stream_in(csound, st);
+      stream_start(csound, st);
+      stream_out(csound, st);
+      stream_section(csound, st, bin);
+      st->ahead = scorebin_create();
+      pthread_mutex_init(&st->lock, NULL);
+      pthread_cond_init(&st->work, NULL);
+      pthread_cond_init(&st->sorted, NULL);
+#ifndef __EMSCRIPTEN__
+      st->running =
+        (pthread_create(&st->thread, NULL, stream_thread, st) == 0);
+#endif
+      if (st->running) {
+        pthread_mutex_lock(&st->lock);
+        stream_ask(st);
+        pthread_mutex_unlock(&st->lock);
+      }
+      return;
+    }
+    csound->sectcnt = 0;
+    sread_initstr(csound, scin);
+
+    while ((n = sread(csound)) > 0) {
+      sort(csound);
+      twarp(csound);
+      swritebin(csound, bin);
+      m++;
+    }
+    scorebin_finish(bin, m);
+    sfree(csound);
+}
+
+/* called by rdscor() when it has read all the events of csound->scbin:
+   takes the next section of a stream, and returns non-zero if there are
+   events to read.  It waits only if the thread has not sorted the
+   section yet. */
+int scsortbin_next(CSOUND *csound)
+{
+    SCOREBIN *bin = csound->scbin;
+    SCORESTREAM *st = (SCORESTREAM*) bin->stream;
+
+    if (st == NULL)
+      return (bin->p < bin->len);
+    if (!st->running) {
+      while (!st->done && bin->p >= bin->len)
+        stream_section(csound, st, bin);
+      return (bin->p < bin->len);
+    }
+    pthread_mutex_lock(&st->lock);
+    while (bin->p >= bin->len && (st->want || st->ready)) {
+      SCOREBIN tmp;
+      while (st->want)
+        pthread_cond_wait(&st->sorted, &st->lock);
+      if (UNLIKELY(st->error)) {        /* reported by scorerr() */
+        st->ready = 0;
+        pthread_mutex_unlock(&st->lock);
+        csound->LongJmp(csound, 1);
+      }
+      tmp = *bin;                       /* bin gets the events of ahead */
+      *bin = *(st->ahead);
+      *(st->ahead) = tmp;
+      bin->stream = (void*) st;
+      st->ahead->stream = NULL;
+      stream_ask(st);
+    }
+    pthread_mutex_unlock(&st->lock);
+    return (bin->p < bin->len);
+}
+
+/* back to the first event; a stream sorts its sections again from the
+   first, with the same seed for ~ */
+void scsortbin_rewind(CSOUND *csound)
+{
+    SCOREBIN *bin = csound->scbin;
+    SCORESTREAM *st = (SCORESTREAM*) bin->stream;
+
+    if (st == NULL) {
+      scorebin_rewind(bin);
+      return;
+    }
+    if (st->running) {
+      pthread_mutex_lock(&st->lock);
+      while (st->want)
+        pthread_cond_wait(&st->sorted, &st->lock);
+    }
+    stream_in(csound, st);
+    stream_start(csound, st);
+    stream_out(csound, st);
+    st->error = 0;
+    bin->len = bin->p = 0;
+    if (st->running) {                  /* rdscor() waits for it */
+      stream_ask(st);
+      pthread_mutex_unlock(&st->lock);
+    }
+    else
+      stream_section(csound, st, bin);
+}
+
+/* free csound->scbin, and the sorter state and score of a stream */
+void scsortbin_rm(CSOUND *csound)
+{
+    SCOREBIN *bin = csound->scbin;
+    SCORESTREAM *st;
+
+    if (bin == NULL)
+      return;
+    if ((st = (SCORESTREAM*) bin->stream) != NULL) {
+      if (st->running) {
+        pthread_mutex_lock(&st->lock);
+        st->quit = 1;
+        pthread_cond_signal(&st->work);
+        pthread_mutex_unlock(&st->lock);
+        pthread_join(st->thread, NULL);
+      }
+      pthread_cond_destroy(&st->sorted);
+      pthread_cond_destroy(&st->work);
+      pthread_mutex_destroy(&st->lock);
+      stream_in(csound, st);
+      stream_drop_input(csound);
+      if (csound->sreadStatics.curmem != NULL)  /* sorter memory */
+        csound->Free(csound, csound->sreadStatics.curmem);
+      csound->sreadStatics.curmem = NULL;
+      stream_out(csound, st);
+      corfile_rm(&(st->sco));
+      scorebin_rm(&(st->ahead));
+      csound->Free(csound, st);
+    }
+    scorebin_rm(&(csound->scbin));
+}
+
+/* the stream of csound->scbin, locked while another score is sorted;
+   NULL if it has no thread */
+static SCORESTREAM *stream_lock(CSOUND *csound)
+{
+    SCORESTREAM *st;
+
+    if (csound->scbin == NULL ||
+        (st = (SCORESTREAM*) csound->scbin->stream) == NULL ||
+        !st->running)
+      return NULL;
+    pthread_mutex_lock(&st->lock);
+    return st;
+}
+
+static void stream_unlock(SCORESTREAM *st)
+{
+    if (st != NULL)
+      pthread_mutex_unlock(&st->lock);
+}
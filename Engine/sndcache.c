@@ -0,0 +1,307 @@
+/*
+    sndcache.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"                         /*      SNDCACHE.C      */
+#include "soundio.h"
+#include "sndcache.h"
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_UNISTD_H)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* An entry is a header of one page, so that the frames are page
+   aligned, then the frames and the guard float.  It is written to a
+   temporary file with a unique name (mkstemp()) and renamed into place,
+   so that readers see either nothing or a complete entry; two instances
+   missing at once, in one process or in several, both decode, and the
+   second rename wins. */
+
+#define SNDCACHE_MAGIC    "CSSMPC1"
+#define SNDCACHE_HDRSIZE  4096
+#define SNDCACHE_CHUNK    16384     /* frames decoded per write */
+
+typedef struct {
+    char        magic[8];
+    int64_t     mtime, mtimeNsec;
+    int64_t     fileSize;
+    int64_t     nFrames;
+    int32_t     format, channels, sampleRate, pathLen;
+    char        path[SNDCACHE_HDRSIZE - 56];
+} SNDCACHE_HDR;
+
+typedef struct sndcache_map_ {
+    struct sndcache_map_ *nxt;
+    void        *base;
+    size_t      len;
+} SNDCACHE_MAP;
+
+/* the parts of the format that change the decoded frames */
+#define KEY_FORMAT(f) ((f) & (SF_FORMAT_TYPEMASK | SF_FORMAT_SUBMASK))
+
+static void sndcache_key(SNDCACHE_HDR *h, const char *path,
+                         const struct stat *st, const SF_INFO *sfinfo)
+{
+    memset(h, 0, sizeof(SNDCACHE_HDR));
+    memcpy(h->magic, SNDCACHE_MAGIC, 8);
+    h->mtime = (int64_t) st->st_mtime;
+#if defined(__APPLE__)
+    h->mtimeNsec = (int64_t) st->st_mtimespec.tv_nsec;
+#elif defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L
+    h->mtimeNsec = (int64_t) st->st_mtim.tv_nsec;
+#endif
+    h->fileSize = (int64_t) st->st_size;
+    h->format = KEY_FORMAT(sfinfo->format);
+    h->channels = sfinfo->channels;
+    h->sampleRate = sfinfo->samplerate;
+    h->pathLen = (int32_t) strlen(path);
+    strncpy(h->path, path, sizeof(h->path) - 1);
+}
+
+/* FNV-1a of the key fields and path */
+static uint64_t sndcache_hash(const SNDCACHE_HDR *h)
+{
+    const unsigned char *s = (const unsigned char*) h;
+    uint64_t  x = UINT64_C(14695981039346656037);
+    size_t    i, n = offsetof(SNDCACHE_HDR, path) + (size_t) h->pathLen;
+
+    for (i = 0; i < n; i++) {
+      if (i >= offsetof(SNDCACHE_HDR, nFrames) &&
+          i < offsetof(SNDCACHE_HDR, format))
+        continue;                       /* not known before decoding */
+      x = (x ^ s[i]) * UINT64_C(1099511628211);
+    }
+    return x;
+}
+
+static int sndcache_match(const SNDCACHE_HDR *key, const SNDCACHE_HDR *h)
+{
+    return (memcmp(h->magic, key->magic, 8) == 0 &&
+            h->mtime == key->mtime && h->mtimeNsec == key->mtimeNsec &&
+            h->fileSize == key->fileSize && h->format == key->format &&
+            h->channels == key->channels &&
+            h->sampleRate == key->sampleRate &&
+            h->pathLen == key->pathLen &&
+            memcmp(h->path, key->path, (size_t) key->pathLen) == 0);
+}
+
+static size_t sndcache_len(const SNDCACHE_HDR *h)
+{
+    return SNDCACHE_HDRSIZE
+      + ((size_t) h->nFrames * (size_t) h->channels + 1) * sizeof(float);
+}
+
+static int sndcache_reset(CSOUND *csound, void *userData)
+{
+    SNDCACHE_MAP *m = (SNDCACHE_MAP*) csound->sndcache;
+
+    IGN(userData);
+    for ( ; m != NULL; m = m->nxt)
+      munmap(m->base, m->len);
+    csound->sndcache = NULL;
+    return 0;
+}
+
+/* map a complete entry matching key, or return NULL */
+static void *sndcache_open(const char *name, const SNDCACHE_HDR *key,
+                           size_t *len)
+{
+    struct stat st;
+    void    *base;
+    int     fd = open(name, O_RDONLY);
+
+    if (fd < 0)
+      return NULL;
+    base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) SNDCACHE_HDRSIZE)
+      base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+      return NULL;
+    if (!sndcache_match(key, (SNDCACHE_HDR*) base) ||
+        sndcache_len((SNDCACHE_HDR*) base) != (size_t) st.st_size) {
+      munmap(base, (size_t) st.st_size);
+      return NULL;
+    }
+    *len = (size_t) st.st_size;
+    return base;
+}
+
+static int write_all(int fd, const void *buf, size_t n)
+{
+    const char *p = (const char*) buf;
+
+    while (n > 0) {
+      ssize_t k = write(fd, p, n);
+      if (k < 0) {
+        if (errno == EINTR) continue;
+        return -1;
+      }
+      p += k;
+      n -= (size_t) k;
+    }
+    return 0;
+}
+
+/* decode sf into a new entry called name */
+static int sndcache_build(CSOUND *csound, const char *name, SNDFILE *sf,
+                          SNDCACHE_HDR *h)
+{
+    char    *tmpname;
+    float   *buf;
+    sf_count_t n;
+    int     fd, err = 0;
+    size_t  chunk = (size_t) SNDCACHE_CHUNK * (size_t) h->channels;
+
+    tmpname = (char*) csound->Malloc(csound, strlen(name) + 8);
+    sprintf(tmpname, "%s.XXXXXX", name);
+    fd = mkstemp(tmpname);
+    if (UNLIKELY(fd < 0)) {
+      csound->Free(csound, tmpname);
+      return -1;
+    }
+    fchmod(fd, 0644);                   /* mkstemp() makes it 0600 */
+    buf = (float*) csound->Malloc(csound, chunk * sizeof(float));
+    h->nFrames = 0;
+    err = write_all(fd, h, sizeof(SNDCACHE_HDR));
+    while (!err && (n = sf_readf_float(sf, buf, SNDCACHE_CHUNK)) > 0) {
+      err = write_all(fd, buf, (size_t) n * (size_t) h->channels
+                               * sizeof(float));
+      h->nFrames += (int64_t) n;
+    }
+    buf[0] = 0.0f;                              /* guard point */
+    if (!err)
+      err = write_all(fd, buf, sizeof(float));
+    if (!err)
+      err = (pwrite(fd, h, sizeof(SNDCACHE_HDR), 0)
+             != (ssize_t) sizeof(SNDCACHE_HDR));
+    err |= (close(fd) != 0);
+    if (!err)
+      err = rename(tmpname, name);
+    if (err)
+      unlink(tmpname);
+    csound->Free(csound, buf);
+    csound->Free(csound, tmpname);
+    return err ? -1 : 0;
+}
+
+float *sndcache_get(CSOUND *csound, const char *path, SF_INFO *sfinfo)
+{
+    const char  *dir = csound->oparmsExt.sampleCache;
+    SNDCACHE_HDR key;
+    SNDCACHE_MAP *m;
+    struct stat st;
+    char    *name;
+    void    *base;
+    size_t  len = 0;
+
+    if (dir == NULL || *dir == '\0' || stat(path, &st) != 0 ||
+        strlen(path) >= sizeof(key.path))
+      return NULL;
+    sndcache_key(&key, path, &st, sfinfo);
+    name = (char*) csound->Malloc(csound, strlen(dir) + 32);
+    sprintf(name, "%s/%016llx.cssmp", dir,
+                  (unsigned long long) sndcache_hash(&key));
+    base = sndcache_open(name, &key, &len);
+    if (base == NULL) {
+      SNDFILE *sf;
+      SF_INFO info;
+      /* only raw files are opened with a given format */
+      memset(&info, 0, sizeof(SF_INFO));
+      if ((sfinfo->format & SF_FORMAT_TYPEMASK) == SF_FORMAT_RAW)
+        info = *sfinfo;
+      if ((sf = sf_open(path, SFM_READ, &info)) == NULL) {
+        csound->Free(csound, name);
+        return NULL;
+      }
+      mkdir(dir, 0777);
+      if (sndcache_build(csound, name, sf, &key) == 0)
+        base = sndcache_open(name, &key, &len);
+      sf_close(sf);
+      if (base == NULL)
+        csound->Warning(csound, Str("could not write sample cache entry "
+                                    "'%s' for '%s'"), name, path);
+    }
+    csound->Free(csound, name);
+    if (base == NULL)
+      return NULL;
+    if (csound->sndcache == NULL)
+      csound->RegisterResetCallback(csound, NULL, sndcache_reset);
+    m = (SNDCACHE_MAP*) csound->Malloc(csound, sizeof(SNDCACHE_MAP));
+    m->base = base;
+    m->len = len;
+    m->nxt = (SNDCACHE_MAP*) csound->sndcache;
+    csound->sndcache = (void*) m;
+    sfinfo->frames = (sf_count_t) ((SNDCACHE_HDR*) base)->nFrames;
+    return (float*) ((char*) base + SNDCACHE_HDRSIZE);
+}
+
+void sndcache_release(CSOUND *csound, float *data)
+{
+    SNDCACHE_MAP **pp = (SNDCACHE_MAP**) &(csound->sndcache), *m;
+    void    *base = (char*) data - SNDCACHE_HDRSIZE;
+
+    for ( ; (m = *pp) != NULL; pp = &(m->nxt))
+      if (m->base == base) {
+        *pp = m->nxt;
+        munmap(m->base, m->len);
+        csound->Free(csound, m);
+        return;
+      }
+}
+
+#else   /* no mmap: the cache is not used */
+
+float *sndcache_get(CSOUND *csound, const char *path, SF_INFO *sfinfo)
+{
+    IGN(csound); IGN(path); IGN(sfinfo);
+    return NULL;
+}
+
+void sndcache_release(CSOUND *csound, float *data)
+{
+    IGN(csound); IGN(data);
+}
+
+#endif
+
+int sndcache_exact(int format)
+{
+    switch (format & SF_FORMAT_SUBMASK) {
+    case SF_FORMAT_PCM_S8:
+    case SF_FORMAT_PCM_U8:
+    case SF_FORMAT_PCM_16:
+    case SF_FORMAT_PCM_24:
+    case SF_FORMAT_FLOAT:
+    case SF_FORMAT_ULAW:
+    case SF_FORMAT_ALAW:
+      return 1;
+    default:
+      return 0;
+    }
+}
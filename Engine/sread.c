@@ -57,6 +57,11 @@ static intptr_t expand_nxp(CSOUND *csound)
     size_t    nbytes;
 
     if (UNLIKELY(STA(nxp) >= (STA(memend) + MARGIN))) {
+      if (STA(errjmp) != NULL) {
+        csound->ErrorMsg(csound,
+                         Str("sread:  text space overrun, increase MARGIN"));
+        longjmp(*STA(errjmp), 1);
+      }
       csound->Die(csound, Str("sread:  text space overrun, increase MARGIN"));
       return 0;     /* not reached */
     }
@@ -120,6 +125,8 @@ static void scorerr(CSOUND *csound, const char *s, ...)
     csound->ErrMsgV(csound, Str("score error:  "), s, args);
     va_end(args);
     print_input_backtrace(csound, 0, csoundErrorMsg);
+    if (STA(errjmp) != NULL)            /* sorting ahead, see scsort.c */
+      longjmp(*STA(errjmp), 1);
     csound->LongJmp(csound, 1);
 }
 
@@ -425,7 +432,7 @@ static int getscochar(CSOUND *csound, int expand)
             scorerr(csound, Str("illegal placement of operator ~ in [] "
                                 "expression"));
           }
-          *++pv = (MYFLT) (csound->Rand31(&(csound->randSeed1)) - 1)
+          *++pv = (MYFLT) (csound->Rand31(SCORE_SEED(csound)) - 1)
                   / FL(2147483645);
           type = 1;
           c = getscochar(csound, 1);
@@ -816,15 +823,15 @@ int sread(CSOUND *csound)       /*  called from main,  reads from SCOREIN   */
             char    *tmp = p;
             tt = cs_strtod(p, &tmp);
             //printf("tt=%lf q=%c\n", tt, q);
-            csound->randSeed1 = (int)tt;
-            printf("seed from score %d\n", csound->randSeed1);
+            *SCORE_SEED(csound) = (int)tt;
+            printf("seed from score %d\n", *SCORE_SEED(csound));
           }
           else {
             uint32_t tmp = (uint32_t) csound->GetRandomSeedFromTime();
             while (tmp >= (uint32_t) 0x7FFFFFFE)
               tmp -= (uint32_t) 0x7FFFFFFE;
-            csound->randSeed1 = tmp+1;
-            printf("seed from clock %d\n", csound->randSeed1);
+            *SCORE_SEED(csound) = tmp+1;
+            printf("seed from clock %d\n", *SCORE_SEED(csound));
           }
           //printf("cleaning up\n");
           break;
@@ -27,23 +27,47 @@
 #include <ctype.h>
 #include "corfile.h"
 
+/* where the p-fields go: score text, or the values of a binary event */
+typedef struct {
+    CORFIL   *sco;
+    SCOREBIN *bin;
+} SCOUT;
+
 static SRTBLK *nxtins(SRTBLK *), *prvins(SRTBLK *);
-static char   *pfout(CSOUND *,SRTBLK *, char *, int, int, CORFIL *sco);
-static char   *nextp(CSOUND *,SRTBLK *, char *, int, int, CORFIL *sco);
-static char   *prevp(CSOUND *,SRTBLK *, char *, int, int, CORFIL *sco);
-static char   *ramp(CSOUND *,SRTBLK *, char *, int, int, CORFIL *sco);
-static char   *expramp(CSOUND *,SRTBLK *, char *, int, int,CORFIL *sco);
-static char   *randramp(CSOUND *,SRTBLK *, char *, int, int, CORFIL *sco);
-static char   *pfStr(CSOUND *,char *, int, int, CORFIL *sco);
-static char   *fpnum(CSOUND *,char *, int, int, CORFIL *sco);
-
-static void fltout(CSOUND *csound, MYFLT n, CORFIL *sco)
+static char   *pfout(CSOUND *,SRTBLK *, char *, int, int, SCOUT *out);
+static char   *nextp(CSOUND *,SRTBLK *, char *, int, int, SCOUT *out);
+static char   *prevp(CSOUND *,SRTBLK *, char *, int, int, SCOUT *out);
+static char   *ramp(CSOUND *,SRTBLK *, char *, int, int, SCOUT *out);
+static char   *expramp(CSOUND *,SRTBLK *, char *, int, int,SCOUT *out);
+static char   *randramp(CSOUND *,SRTBLK *, char *, int, int, SCOUT *out);
+static char   *pfStr(CSOUND *,char *, int, int, SCOUT *out);
+static char   *fpnum(CSOUND *,char *, int, int, SCOUT *out);
+
+static void fltout(CSOUND *csound, MYFLT n, SCOUT *out)
 {
     char *c, buffer[1024];
+    if (out->bin != NULL) {             /* exact, not rounded to text */
+      scorebin_flt(out->bin, n);
+      return;
+    }
     CS_SPRINTF(buffer, "%.6f", n);
     /* corfile_puts(buffer, sco); */
     for (c = buffer; *c != '\0'; c++)
-      corfile_putc(*c, sco);
+      corfile_putc(*c, out->sco);
+}
+
+static void outc(char c, SCOUT *out)  /* text only: numbers go as values */
+{
+    if (out->bin == NULL)
+      corfile_putc(c, out->sco);
+}
+
+static void zeroout(SCOUT *out)     /* substitute 0 for a bad p-field */
+{
+    if (out->bin != NULL)
+      scorebin_flt(out->bin, FL(0.0));
+    else
+      corfile_putc('0', out->sco);
 }
 
 /*
@@ -66,9 +90,12 @@ void swritestr(CSOUND *csound, CORFIL *sco, int first)
     SRTBLK *bp;
     char   *p, c, isntAfunc;
     int    lincnt, pcnt=0;
+    SCOUT  out;
 
     if (UNLIKELY((bp = csound->frstbp) == NULL))
       return;
+    out.sco = sco;
+    out.bin = NULL;
 
     lincnt = 0;
     if ((c = bp->text[0]) != 'w'
@@ -99,29 +126,29 @@ void swritestr(CSOUND *csound, CORFIL *sco, int first)
       corfile_putc(c, sco);
       if (c == LF)
         break;
-      fltout(csound, bp->p2val, sco);                        /* put p2val,   */
+      fltout(csound, bp->p2val, &out);                       /* put p2val,   */
       corfile_putc(SP, sco);
-      if (first) fltout(csound, bp->newp2, sco);             /*   newp2,     */
+      if (first) fltout(csound, bp->newp2, &out);            /*   newp2,     */
       while ((c = *p++) != SP && c != LF)
         ;
       corfile_putc(c, sco);                /*   and delim  */
       if (c == LF)
         break;
       if (isntAfunc) {
-        fltout(csound, bp->p3val, sco);                      /* put p3val,   */
+        fltout(csound, bp->p3val, &out);                     /* put p3val,   */
         corfile_putc(SP, sco);
-        if (first) fltout(csound, bp->newp3, sco);           /*   newp3,     */
+        if (first) fltout(csound, bp->newp3, &out);          /*   newp3,     */
         while ((c = *p++) != SP && c != LF)
           ;
       }
       else { /*make sure p3s (table length) are ints */
         char temp[256];
         snprintf(temp,256,"%d ",(int32)bp->p3val);   /* put p3val  */
-        fpnum(csound,temp, lincnt, pcnt, sco);
+        fpnum(csound,temp, lincnt, pcnt, &out);
         corfile_putc(SP, sco);
         if (first) {
           snprintf(temp,256,"%d ",(int32)bp->newp3);   /* put newp3  */
-          fpnum(csound,temp, lincnt, pcnt, sco);
+          fpnum(csound,temp, lincnt, pcnt, &out);
         }
         while ((c = *p++) != SP && c != LF)
           ;
@@ -130,7 +157,7 @@ void swritestr(CSOUND *csound, CORFIL *sco, int first)
       while (c != LF) {
         pcnt++;
         corfile_putc(SP, sco);
-        p = pfout(csound,bp,p,lincnt,pcnt, sco);     /* now put each pfield  */
+        p = pfout(csound,bp,p,lincnt,pcnt, &out);    /* now put each pfield  */
         c = *p++;
       }
       corfile_putc('\n', sco);
@@ -165,32 +192,166 @@ void swritestr(CSOUND *csound, CORFIL *sco, int first)
       goto nxtlin;
 }
 
+/* the rest of a line of w or t text: numbers and quoted strings */
+static void binline(SCOREBIN *bin, char *p)
+{
+    char    *q;
+
+    while (1) {
+      while (*p == SP || *p == '\t')
+        p++;
+      if (*p == LF || *p == '\0' || *p == ';')
+        return;
+      if (*p == '"') {
+        for (q = ++p; *p != '"' && *p != LF && *p != '\0'; p++)
+          ;
+        scorebin_str(bin, q, (int) (p - q));
+        if (*p == '"')
+          p++;
+      }
+      else {
+        scorebin_flt(bin, (MYFLT) atof(p));
+        while (*p != SP && *p != '\t' && *p != LF && *p != '\0')
+          p++;
+      }
+    }
+}
+
+/* As swritestr() for the first sort of a score, but each line becomes
+   one SCOREBIN event holding the values rdscor() would have read from
+   it, so that nothing is printed or parsed again; times are exact rather
+   than rounded to six decimals */
+void swritebin(CSOUND *csound, SCOREBIN *bin)
+{
+    SRTBLK *bp;
+    char   *p, c, isntAfunc;
+    int    lincnt, pcnt=0;
+    SCOUT  out;
+
+    if (UNLIKELY((bp = csound->frstbp) == NULL))
+      return;
+    out.sco = NULL;
+    out.bin = bin;
+
+    lincnt = 0;
+    if ((c = bp->text[0]) != 'w'
+        && c != 's' && c != 'e') {      /*   if no warp stmnt but real data,  */
+      scorebin_begin(bin, 'w');         /* create warp-format indicator */
+      scorebin_flt(bin, FL(0.0));
+      scorebin_flt(bin, FL(60.0));
+      scorebin_end(bin);
+      lincnt++;
+    }
+ nxtlin:
+    lincnt++;                           /* now for each line:           */
+    p = bp->text;
+    c = *p++;
+    isntAfunc = 1;
+    switch (c) {
+    case 'f':
+      isntAfunc = 0;
+    case 'q':
+    case 'i':
+    case 'a':
+      scorebin_begin(bin, c);
+      p++;
+      if (*p == '"') {                  /* p1: named instr or number */
+        char *q = ++p;
+        while (*p != '"' && *p != LF)
+          p++;
+        scorebin_str(bin, q, (int) (p - q));
+      }
+      else scorebin_flt(bin, (MYFLT) atof(p));
+      while ((c = *p++) != SP && c != LF)
+        ;
+      if (c == LF) {
+        scorebin_end(bin);
+        break;
+      }
+      scorebin_flt(bin, bp->p2val);     /* p2val, newp2 */
+      scorebin_flt(bin, bp->newp2);
+      while ((c = *p++) != SP && c != LF)
+        ;
+      if (c == LF) {
+        scorebin_end(bin);
+        break;
+      }
+      if (isntAfunc) {
+        scorebin_flt(bin, bp->p3val);   /* p3val, newp3 */
+        scorebin_flt(bin, bp->newp3);
+      }
+      else {                            /* table lengths are ints */
+        scorebin_flt(bin, (MYFLT) ((int32) bp->p3val));
+        scorebin_flt(bin, (MYFLT) ((int32) bp->newp3));
+      }
+      while ((c = *p++) != SP && c != LF)
+        ;
+      pcnt = 3;
+      while (c != LF) {
+        pcnt++;
+        p = pfout(csound,bp,p,lincnt,pcnt, &out);    /* now each pfield */
+        c = *p++;
+      }
+      scorebin_end(bin);
+      break;
+    case 's':
+    case 'e':
+      if (bp->pcnt > 0) {
+        scorebin_begin(bin, 'f');
+        scorebin_flt(bin, FL(0.0));
+        scorebin_flt(bin, bp->p2val);
+        scorebin_flt(bin, bp->newp2);
+        scorebin_end(bin);
+      }
+      scorebin_begin(bin, c);
+      scorebin_end(bin);
+      break;
+    case 'w':
+    case 't':
+      scorebin_begin(bin, c);
+      binline(bin, p);
+      scorebin_end(bin);
+      break;
+    case 'z':
+    case 'y':
+    case -1:
+      break;
+    default:
+      csound->Message(csound,
+                      Str("swrite: unexpected opcode %c, section %d line %d\n"),
+                      c, csound->sectcnt, lincnt);
+      break;
+    }
+    if ((bp = bp->nxtblk) != NULL)
+      goto nxtlin;
+}
+
 static char *pfout(CSOUND *csound, SRTBLK *bp, char *p,
-                   int lincnt, int pcnt, CORFIL *sco)
+                   int lincnt, int pcnt, SCOUT *out)
 {
     switch (*p) {
     case 'n':
-      p = nextp(csound, bp,p, lincnt, pcnt, sco);
+      p = nextp(csound, bp,p, lincnt, pcnt, out);
       break;
     case 'p':
-      p = prevp(csound, bp,p, lincnt, pcnt, sco);
+      p = prevp(csound, bp,p, lincnt, pcnt, out);
       break;
     case '<':
     case '>':
-      p = ramp(csound, bp,p, lincnt, pcnt, sco);
+      p = ramp(csound, bp,p, lincnt, pcnt, out);
       break;
     case '(':
     case ')':
-      p = expramp(csound, bp, p, lincnt, pcnt, sco);
+      p = expramp(csound, bp, p, lincnt, pcnt, out);
       break;
     case '~':
-      p = randramp(csound, bp, p, lincnt, pcnt, sco);
+      p = randramp(csound, bp, p, lincnt, pcnt, out);
       break;
     case '"':
-      p = pfStr(csound, p, lincnt, pcnt, sco);
+      p = pfStr(csound, p, lincnt, pcnt, out);
       break;
     default:
-      p = fpnum(csound, p, lincnt, pcnt, sco);
+      p = fpnum(csound, p, lincnt, pcnt, out);
       break;
     }
     return(p);
@@ -219,7 +380,7 @@ static SRTBLK *prvins(SRTBLK *bp) /* find prv note with same p1 */
 }
 
 static char *nextp(CSOUND *csound, SRTBLK *bp, char *p,
-                   int lincnt, int pcnt, CORFIL *sco)
+                   int lincnt, int pcnt, SCOUT *out)
 {
     char *q;
     int n;
@@ -241,7 +402,7 @@ static char *nextp(CSOUND *csound, SRTBLK *bp, char *p,
       while (n--)
         while (*q++ != SP)                 /*   go find the pfield */
           ;
-      pfout(csound,bp,q,lincnt,pcnt,sco);  /*   and put it out     */
+      pfout(csound,bp,q,lincnt,pcnt,out);  /*   and put it out     */
     }
     else {
     error:
@@ -253,13 +414,13 @@ static char *nextp(CSOUND *csound, SRTBLK *bp, char *p,
       while (*p != SP && *p != LF)
         csound->Message(csound,"%c", *p++);
       csound->Message(csound,Str("   Zero substituted\n"));
-      corfile_putc('0', sco);
+      zeroout(out);
     }
     return(p);
 }
 
 static char *prevp(CSOUND *csound, SRTBLK *bp, char *p,
-                   int lincnt, int pcnt, CORFIL *sco)
+                   int lincnt, int pcnt, SCOUT *out)
 {
     char *q;
     int n;
@@ -281,7 +442,7 @@ static char *prevp(CSOUND *csound, SRTBLK *bp, char *p,
       while (n--)
         while (*q++ != SP)          /*   go find the pfield */
           ;
-      pfout(csound,bp,q,lincnt,pcnt, sco); /*   and put it out */
+      pfout(csound,bp,q,lincnt,pcnt, out); /*   and put it out */
     }
     else {
     error:
@@ -293,13 +454,13 @@ static char *prevp(CSOUND *csound, SRTBLK *bp, char *p,
       while (*p != SP && *p != LF)
         csound->Message(csound,"%c", *p++);
       csound->Message(csound,Str("   Zero substituted\n"));
-      corfile_putc('0', sco);
+      zeroout(out);
     }
     return(p);
 }
 
 static char *ramp(CSOUND *csound, SRTBLK *bp, char *p,
-                  int lincnt, int pcnt, CORFIL *sco)
+                  int lincnt, int pcnt, SCOUT *out)
   /* NB np's may reference a ramp but ramps must terminate in valid nums */
 {
     char    *q;
@@ -346,7 +507,7 @@ static char *ramp(CSOUND *csound, SRTBLK *bp, char *p,
     if (UNLIKELY((p2span = nxtbp->newp2 - prvbp->newp2) <= 0))
       goto error2;
     rval = (qval - pval) * (bp->newp2 - prvbp->newp2) / p2span + pval;
-    fltout(csound, rval, sco);
+    fltout(csound, rval, out);
     return(psav);
 
  error1:
@@ -359,12 +520,12 @@ static char *ramp(CSOUND *csound, SRTBLK *bp, char *p,
                                 "has illegal forward or backward ref\n"),
                             csound->sectcnt, lincnt, pcnt);
  put0:
-    corfile_putc('0', sco);
+    zeroout(out);
     return(psav);
 }
 
 static char *expramp(CSOUND *csound, SRTBLK *bp, char *p,
-                     int lincnt, int pcnt, CORFIL *sco)
+                     int lincnt, int pcnt, SCOUT *out)
   /* NB np's may reference a ramp but ramps must terminate in valid nums */
 {
     char    *q;
@@ -415,7 +576,7 @@ static char *expramp(CSOUND *csound, SRTBLK *bp, char *p,
                              (double)(bp->newp2 - prvbp->newp2) / p2span);
 /*  printf("rval=%f bp->newp2=%f prvbp->newp2-%f\n",
            rval, bp->newp2, prvbp->newp2); */
-    fltout(csound, rval, sco);
+    fltout(csound, rval, out);
     return(psav);
 
  error1:
@@ -428,12 +589,12 @@ static char *expramp(CSOUND *csound, SRTBLK *bp, char *p,
                                 "has illegal forward or backward ref\n"),
                             csound->sectcnt, lincnt, pcnt);
  put0:
-    corfile_putc('0', sco);
+    zeroout(out);
     return(psav);
 }
 
 static char *randramp(CSOUND *csound, SRTBLK *bp, char *p,
-                      int lincnt, int pcnt, CORFIL *sco)
+                      int lincnt, int pcnt, SCOUT *out)
   /* NB np's may reference a ramp but ramps must terminate in valid nums */
 {
     char    *q;
@@ -477,10 +638,10 @@ static char *randramp(CSOUND *csound, SRTBLK *bp, char *p,
     else goto error2;
     pval = stof(csound, p);     /* the error msgs generated by stof     */
     qval = stof(csound, q);                         /*   are misleading */
-    rval = (MYFLT) (((double) (csound->Rand31(&(csound->randSeed1)) - 1)
+    rval = (MYFLT) (((double) (csound->Rand31(SCORE_SEED(csound)) - 1)
                      / 2147483645.0) * ((double) qval - (double) pval)
                     + (double) pval);
-    fltout(csound, rval, sco);
+    fltout(csound, rval, out);
     return(psav);
 
  error1:
@@ -493,17 +654,25 @@ static char *randramp(CSOUND *csound, SRTBLK *bp, char *p,
                                " illegal forward or backward ref\n"),
                csound->sectcnt,lincnt,pcnt);
  put0:
-    corfile_putc('0', sco);
+    zeroout(out);
     return(psav);
 }
 
-static char *pfStr(CSOUND *csound, char *p, int lincnt, int pcnt, CORFIL *sco)
+static char *pfStr(CSOUND *csound, char *p, int lincnt, int pcnt, SCOUT *out)
 {                             /* moves quoted ascii string to SCOREOUT file */
     char *q = p;              /*   with no internal format chk              */
-    corfile_putc(*p++, sco);
-    while (*p != '"')
-      corfile_putc(*p++, sco);
-    corfile_putc(*p++, sco);
+    if (out->bin != NULL) {
+      while (*++p != '"')
+        ;
+      scorebin_str(out->bin, q + 1, (int) (p - q) - 1);
+      p++;
+    }
+    else {
+      corfile_putc(*p++, out->sco);
+      while (*p != '"')
+        corfile_putc(*p++, out->sco);
+      corfile_putc(*p++, out->sco);
+    }
     if (UNLIKELY(*p != SP && *p != LF)) {
       csound->Message(csound, Str("swrite: output, sect%d line%d p%d "
                                   "has illegally terminated string   "),
@@ -518,40 +687,41 @@ static char *pfStr(CSOUND *csound, char *p, int lincnt, int pcnt, CORFIL *sco)
 }
 
 static char *fpnum(CSOUND *csound, char *p,
-                   int lincnt, int pcnt, CORFIL *sco) /* moves ascii string */
+                   int lincnt, int pcnt, SCOUT *out) /* moves ascii string */
   /* to SCOREOUT file with fpnum format chk */
 {
-    char *q;
+    char *q, *start;
     int dcnt;
 
     q = p;
     if (*p == '+')
       p++;
+    start = p;
     if (*p == '-')
-      corfile_putc(*p++, sco);
+      outc(*p++, out);
     dcnt = 0;
     while (isdigit(*p)) {
       //      printf("*p=%c\n", *p);
-      corfile_putc(*p++, sco);
+      outc(*p++, out);
       dcnt++;
     }
     //    printf("%d:output: %s<<\n", __LINE__, sco);
     if (*p == '.')
-      corfile_putc(*p++, sco);
+      outc(*p++, out);
     while (isdigit(*p)) {
-      corfile_putc(*p++, sco);
+      outc(*p++, out);
       dcnt++;
     }
     //    printf("%d:output: %s<<\n", __LINE__, sco);
     if (*p == 'E' || *p == 'e') { /* Allow exponential notation */
-      corfile_putc(*p++, sco);
+      outc(*p++, out);
       dcnt++;
       if (*p == '+' || *p == '-') {
-        corfile_putc(*p++, sco);
+        outc(*p++, out);
         dcnt++;
       }
       while (isdigit(*p)) {
-        corfile_putc(*p++, sco);
+        outc(*p++, out);
         dcnt++;
       }
     }
@@ -565,8 +735,11 @@ static char *fpnum(CSOUND *csound, char *p,
       while (*p != SP && *p != LF)
         csound->Message(csound,"%c", *p++);
       csound->Message(csound,Str("    String truncated\n"));
-      if (!dcnt)
-        corfile_putc('0', sco);
+      if (!dcnt && out->bin == NULL)
+        corfile_putc('0', out->sco);
     }
+    if (out->bin != NULL)     /* the value rdscor() would read back */
+      scorebin_flt(out->bin, dcnt ? (MYFLT) atof(start)
+                                  : FL(0.0));
     return(p);
 }
@@ -88,6 +88,31 @@ typedef struct {
     MYFLT   *r, *a, *b, *def;
 } DIVZ;
 
+/* fused a-rate arithmetic (##fuse).  The compiler passes the expression
+   tree as a postfix program string: 'A'+n pushes a-rate argument n,
+   'a'+n pushes scalar argument n, and '+', '-', '*' and '~' (negate)
+   operate on the top of the stack. */
+#define FUSE_MAXARGS    26
+#define FUSE_MAXCODE    (2*FUSE_MAXARGS)
+#define FUSE_STACK      8
+#define FUSE_CHUNK      32
+
+enum { FUSE_PUSH, FUSE_ADD, FUSE_SUB, FUSE_MUL, FUSE_NEG };
+enum { FUSE_SRC_STACK, FUSE_SRC_AUDIO, FUSE_SRC_SCALAR };
+
+typedef struct {
+    unsigned char op, src, arg;
+} FUSE_INSTR;
+
+typedef struct {
+    OPDS    h;
+    MYFLT   *r;
+    STRINGDAT *prog;
+    MYFLT   *args[FUSE_MAXARGS];
+    FUSE_INSTR code[FUSE_MAXCODE];
+    int     ncode;
+} FUSEOP;
+
 typedef struct {
     OPDS    h;
     MYFLT   *r, *a;
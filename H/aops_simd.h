@@ -0,0 +1,71 @@
+/*
+    aops_simd.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#ifndef AOPS_SIMD_H
+#define AOPS_SIMD_H
+
+#include "csoundCore.h"
+
+/* Vector kernels for the a-rate arithmetic opcodes.  Each kernel
+   processes n samples from the given pointers, which need not be
+   aligned; r may be the same array as an input.  All tables give
+   results identical to the scalar loops. */
+
+typedef void (*AOPS_VV)(MYFLT *r, const MYFLT *a, const MYFLT *b, uint32_t n);
+typedef void (*AOPS_SV)(MYFLT *r, MYFLT a, const MYFLT *b, uint32_t n);
+typedef void (*AOPS_VS)(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+typedef void (*AOPS_V)(MYFLT *r, const MYFLT *a, uint32_t n);
+typedef void (*AOPS_PEAK)(MYFLT *amax, MYFLT *apos, MYFLT *over,
+                          const MYFLT *x, uint32_t nchnls, uint32_t nframes,
+                          MYFLT lim);
+
+enum { AOPS_ADD, AOPS_SUB, AOPS_MUL, AOPS_DIV, AOPS_NOPS };
+
+typedef struct {
+    const char  *name;              /* instruction set */
+    AOPS_VV     vv[AOPS_NOPS];      /* r[n] = a[n] op b[n] */
+    AOPS_SV     sv[AOPS_NOPS];      /* r[n] = a op b[n] */
+    AOPS_VS     vs[AOPS_NOPS];      /* r[n] = a[n] op b */
+    AOPS_V      trunc;              /* r[n] = integer part of a[n] */
+    /* output metering of nframes interleaved frames of nchnls samples:
+       for each channel c, where |x| > amax[c], amax[c] = |x| and
+       apos[c] = frame number; over[c] += 1 where |x| > lim */
+    AOPS_PEAK   peak;
+} AOPS_KERNELS;
+
+/* table used by the opcodes, chosen by aops_simd_init() */
+extern const AOPS_KERNELS *aops_kernels;
+
+/* select the best table for this CPU; called once from csoundInitialize() */
+void aops_simd_init(void);
+
+/* the i-th table this CPU can run, scalar first; NULL past the last */
+const AOPS_KERNELS *aops_simd_table(int i);
+
+/* add dither noise of 1/scale peak to the n samples of buf, rectangular
+   or (if tpdf) triangular, from the LCG state *seed, which is updated;
+   the same samples as one LCG step (two if tpdf) per sample */
+void aops_dither_add(MYFLT *buf, uint32_t n, int tpdf, MYFLT scale,
+                     int *seed);
+
+#endif  /* AOPS_SIMD_H */
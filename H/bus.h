@@ -80,6 +80,7 @@ typedef struct {
     MYFLT   *fp;
     int     *lock;
     int      pos;
+    CHNENTRY *entry;            /* channel resolved at init time */
 } CHNGET;
 
 typedef struct {
@@ -54,4 +54,29 @@ void corfile_set(CORFIL *f, int n);
 void corfile_seek(CORFIL *f, int n, int dir);
 void corfile_preputs(const char *s, CORFIL *f);
 
+/* One event of a SCOREBIN: the values of the p-fields of a line of
+   sorted score text, in the order swritestr() prints them, and the
+   strings they refer to; followed by nvals MYFLTs and slen bytes, and
+   padded to a multiple of sizeof(MYFLT) */
+typedef struct {
+    int32   size;               /* bytes in the record */
+    int32   nvals;
+    int32   slen;
+    int16   nstrs;
+    char    opcod;
+} SCOREBIN_REC;
+
+#define SCOREBIN_ALIGN(n) \
+    (((n) + sizeof(MYFLT) - 1) / sizeof(MYFLT) * sizeof(MYFLT))
+#define SCOREBIN_HDRSIZE  SCOREBIN_ALIGN(sizeof(SCOREBIN_REC))
+
+SCOREBIN *scorebin_create(void);
+void scorebin_begin(SCOREBIN *b, int opcod);
+void scorebin_flt(SCOREBIN *b, MYFLT x);
+void scorebin_str(SCOREBIN *b, const char *s, int n);
+void scorebin_end(SCOREBIN *b);
+void scorebin_rm(SCOREBIN **bb);
+void scorebin_rewind(SCOREBIN *b);
+#define scorebin_rewind(b) ((b)->p = 0)
+
 #endif
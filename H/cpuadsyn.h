@@ -0,0 +1,76 @@
+/*
+    cpuadsyn.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#ifndef CPUADSYN_H
+#define CPUADSYN_H
+
+#include "csoundCore.h"
+
+/* Oscillator bank kernels for cpuadsynth.  The bank has one partial per
+   pvs bin, stored as separate arrays and padded with silent partials to
+   a multiple of CPUADSYN_LANES.  Phases are 30-bit fixed point as in the
+   cudasynth and cladsynth kernels, so every partial follows the same
+   phase trajectory as on the GPU; the sine is read from a table of
+   CPUADSYN_TABLEN points (plus a guard point) with linear interpolation. */
+
+#define CPUADSYN_LANES    8
+#define CPUADSYN_FMAXLEN  ((float) 0x40000000)
+#define CPUADSYN_PHMASK   0x3fffffff
+#define CPUADSYN_TABBITS  12
+#define CPUADSYN_TABLEN   (1 << CPUADSYN_TABBITS)
+
+typedef struct {
+    uint32_t    *ph;        /* phase at the start of the hop */
+    uint32_t    *incr;      /* phase increment per sample */
+    float       *amp;       /* amplitude at the start of the hop */
+    float       *amp1;      /* amplitude at the end of the hop */
+} CPUADSYN_BANK;
+
+/* Write the sum of partials first to last - 1 (multiples of
+   CPUADSYN_LANES) over one hop of vsamps samples to out.  acc is
+   scratch space for vsamps * CPUADSYN_LANES floats.  The bank is
+   only read. */
+typedef void (*CPUADSYN_RENDER)(float *out, float *acc,
+                                const CPUADSYN_BANK *b, const float *tab,
+                                int first, int last, int vsamps);
+
+typedef struct {
+    const char      *name;          /* instruction set */
+    CPUADSYN_RENDER render;
+} CPUADSYN_KERNEL;
+
+/* fill tab with CPUADSYN_TABLEN + 1 points of one sine cycle */
+void cpuadsyn_table(float *tab);
+
+/* set increments and target amplitudes of partials first to last - 1
+   from an amp/freq frame of bins bins; fscal is pitch * FMAXLEN / sr */
+void cpuadsyn_load(CPUADSYN_BANK *b, const float *frame, int bins,
+                   float fscal, int first, int last);
+
+/* move partials first to last - 1 to the end of a hop of vsamps samples */
+void cpuadsyn_advance(CPUADSYN_BANK *b, int first, int last, int vsamps);
+
+/* the i-th kernel this CPU can run, scalar first; NULL past the last */
+const CPUADSYN_KERNEL *cpuadsyn_kernel(int i);
+
+#endif  /* CPUADSYN_H */
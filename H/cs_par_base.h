@@ -124,6 +124,34 @@ int csp_set_union(CSOUND *csound, struct set_t *first,
 int csp_set_intersection(CSOUND *csound, struct set_t *first,
                          struct set_t *second, struct set_t **result);
 
+/*
+ * bitsets of global variables
+ *
+ * global names are interned to dense ids as the orchestra is parsed, so
+ * an instrument's read and write sets are a few words each and testing
+ * two of them for a common global needs no allocation
+ */
+struct bitset_t {
+    int                  nwords;
+    uint64_t             *words;
+};
+
+/* dense id of a global name, allocating one on first use */
+int csp_global_intern(CSOUND *csound, char *name);
+/* name for an id returned by csp_global_intern */
+char *csp_global_name(CSOUND *csound, int id);
+
+void csp_bitset_add(CSOUND *csound, struct bitset_t *bs, int id);
+/* interns and adds every member of a set of strings */
+void csp_bitset_add_set(CSOUND *csound, struct bitset_t *bs, struct set_t *set);
+void csp_bitset_union(CSOUND *csound, struct bitset_t *bs,
+                      struct bitset_t *other);
+/* returns 1 if the two have any member in common */
+int csp_bitset_intersects(struct bitset_t *first, struct bitset_t *second);
+int csp_bitset_count(struct bitset_t *bs);
+int csp_bitset_print(CSOUND *csound, struct bitset_t *bs);
+void csp_bitset_dealloc(CSOUND *csound, struct bitset_t *bs);
+
 /* spinlock */
 
 /* semaphore */
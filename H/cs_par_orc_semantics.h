@@ -21,11 +21,17 @@ typedef struct instr_semantics_t {
     char                        hdr[HDR_LEN];
     char                        *name;
     int32                       insno;
-    struct set_t                *read;
-    struct set_t                *write;
-    struct set_t                *read_write;
+    struct bitset_t             read;
+    struct bitset_t             write;
+    struct bitset_t             read_write;
     uint32_t                    weight;
     struct instr_semantics_t    *next;
+    /* cache of which other instruments share globals with this one,
+       indexed by their dep_id; filled lazily by the DAG builder */
+    int32                       dep_id;
+    int                         dep_words;
+    uint32_t                    *dep_known;
+    uint32_t                    *dep_conflict;
 } INSTR_SEMANTICS;
 
 void csp_orc_sa_cleanup(CSOUND *csound);
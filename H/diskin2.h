@@ -71,7 +71,9 @@ typedef struct {
   MYFLT *aOut_buf;
   MYFLT aOut_bufsize;
   void *cb;
+  void *ioreq;                 /* refill request of the async reader */
   int  async;
+  int  asyncDeinit;            /* deinit callback registered */
 } DISKIN2;
 
 typedef struct {
@@ -113,7 +115,9 @@ typedef struct {
   MYFLT *aOut_buf;
   MYFLT aOut_bufsize;
   void *cb;
+  void *ioreq;                 /* refill request of the async reader */
   int  async;
+  int  asyncDeinit;            /* deinit callback registered */
 } DISKIN2_ARRAY;
 
 int diskin2_init(CSOUND *csound, DISKIN2 *p);
@@ -85,6 +85,7 @@ int     modak(CSOUND *, void *);
 int     addaa(CSOUND *, void *), subaa(CSOUND *, void *);
 int     mulaa(CSOUND *, void *), divaa(CSOUND *, void *);
 int     modaa(CSOUND *, void *);
+int     fuse_init(CSOUND *, void *), fuse_perf(CSOUND *, void *);
 int     divzkk(CSOUND *, void *), divzka(CSOUND *, void *);
 int     divzak(CSOUND *, void *), divzaa(CSOUND *, void *);
 int     int1(CSOUND *, void *), int1a(CSOUND *, void *);
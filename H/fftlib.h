@@ -116,6 +116,22 @@ extern "C" {
    */
   void csoundInverseRealFFTnp2(CSOUND *csound, MYFLT *buf, int FFTsize);
 
+  /**
+   * Returns a plan for in-place real FFTs of 'FFTsize' samples in the
+   * format of csoundRealFFT(); 'direction' is FFT_FWD or FFT_INV, and
+   * inverse transforms need no scaling.  FFTsize must be even, and
+   * FFTsize / 2 of the form 2^a * 3^b * 5^c; otherwise NULL is returned.
+   * Plans are shared, and freed by csoundReset().
+   */
+  CSOUND_FFT_SETUP *csoundRealFFTSetup(CSOUND *csound,
+                                       int FFTsize, int direction);
+
+  /**
+   * Compute an in-place real FFT of 'buf', which has the size of the plan.
+   */
+  void csoundRealFFTExecute(CSOUND *csound, CSOUND_FFT_SETUP *setup,
+                            MYFLT *buf);
+
 #ifdef __cplusplus
 }
 #endif
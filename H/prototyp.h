@@ -34,6 +34,16 @@ void    *mmalloc(CSOUND *, size_t);
 void    *mcalloc(CSOUND *, size_t);
 void    *mrealloc(CSOUND *, void *, size_t);
 void    mfree(CSOUND *, void *);
+typedef struct memzone_s MEMZONE;
+MEMZONE *mzone_create(CSOUND *, size_t);
+void    *mzone_alloc(CSOUND *, MEMZONE *, size_t);
+char    *mzone_strdup(CSOUND *, MEMZONE *, const char *);
+void    mzone_prefault(CSOUND *, MEMZONE *, size_t);
+void    mzone_reset(CSOUND *, MEMZONE *);
+void    mzone_destroy(CSOUND *, MEMZONE *);
+MEMZONE *mzone_engine(CSOUND *);
+MEMZONE *mzone_compile(CSOUND *);
+MEMZONE *mzone_perf(CSOUND *);
 char    *cs_strdup(CSOUND*, char*);
 char    *cs_strndup(CSOUND*, char*, size_t);
 void    csoundAuxAlloc(CSOUND *, size_t, AUXCH *), auxchfree(CSOUND *, INSDS *);
@@ -54,6 +64,10 @@ void    dispinit(CSOUND *);
 int     init0(CSOUND *);
 void    scsort(CSOUND *, FILE *, FILE *);
 char    *scsortstr(CSOUND *, CORFIL *);
+void    scsortbin(CSOUND *, CORFIL *);
+int     scsortbin_next(CSOUND *);
+void    scsortbin_rewind(CSOUND *);
+void    scsortbin_rm(CSOUND *);
 int     scxtract(CSOUND *, CORFIL *, FILE *);
 int     rdscor(CSOUND *, EVTBLK *);
 int     musmon(CSOUND *);
@@ -85,6 +99,7 @@ int     delete_memfile(CSOUND *, const char *);
 char    *csoundTmpFileName(CSOUND *, const char *);
 void    *SAsndgetset(CSOUND *, char *, void *, MYFLT *, MYFLT *, MYFLT *, int);
 int     getsndin(CSOUND *, void *, MYFLT *, int, void *);
+int     getsndin_cached(CSOUND *, MYFLT *, int, void *);
 void    *sndgetset(CSOUND *, void *);
 void    dbfs_init(CSOUND *, MYFLT dbfs);
 int     csoundLoadExternals(CSOUND *);
@@ -99,6 +114,12 @@ int     csoundCheckOpcodePluginFile(CSOUND *, const char *);
 int     csoundLoadAndInitModule(CSOUND *, const char *);
 void    csoundNotifyFileOpened(CSOUND *, const char *, int, int, int);
 int     insert_score_event_at_sample(CSOUND *, EVTBLK *, int64_t);
+void    instr_perf(CSOUND *, INSDS *);
+void    instr_perf_sa(CSOUND *, INSDS *);
+void    instr_perf_local(CSOUND *, INSDS *);
+void    event_queue_create(CSOUND *);
+int     event_queue_push(CSOUND *, char, const MYFLT *, long, int64_t);
+void    event_queue_drain(CSOUND *);
 
 char *get_arg_string(CSOUND *, MYFLT);
 
@@ -0,0 +1,58 @@
+/*
+    sndcache.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#ifndef CSOUND_SNDCACHE_H
+#define CSOUND_SNDCACHE_H
+
+#include <sndfile.h>
+
+/* Decoded sample cache (--sample-cache=DIR).  Each entry holds all the
+   frames of one sound file as interleaved floats, as sf_readf_float()
+   returns them, followed by one zero guard float, and is keyed by the
+   full path, modification time, size, format, channels and sample rate
+   of the file.  Entries are mapped read-only and shared, so processes on
+   one machine share the page cache, and pages are read in as they are
+   touched. */
+
+/**
+ * Returns the cached frames of the sound file at 'path' (a full path),
+ * decoding them into a new entry first if there is none.  sfinfo gives
+ * the format, channels and sample rate the file was opened with (the
+ * format is only used to open raw files), and receives its length in
+ * frames.  NULL is returned if there is no cache directory, mmap() is
+ * not available, or the entry cannot be made; the caller then reads the
+ * file itself.  The mapping lasts until sndcache_release() or
+ * csoundReset().
+ */
+float *sndcache_get(CSOUND *csound, const char *path, SF_INFO *sfinfo);
+
+/** unmap frames returned by sndcache_get() */
+void sndcache_release(CSOUND *csound, float *data);
+
+/**
+ * Non-zero if sf_read_float() and sf_read_double() give the same values
+ * for this sample format, so cached floats can stand in for doubles.
+ */
+int sndcache_exact(int format);
+
+#endif  /* CSOUND_SNDCACHE_H */
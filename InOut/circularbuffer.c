@@ -76,14 +76,19 @@ int csoundReadCircularBuffer(CSOUND *csound, void *p, void *out, int items)
         return 0;
       }
       itemsread = items > remaining ? remaining : items;
-      for (i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-          rp = 0;
-        }
-      }
 #ifdef HAVE_ATOMIC_BUILTIN
+      __sync_synchronize();     /* see the items written before wp */
+#endif
+      /* at most two blocks: to the end of the buffer, then from 0 */
+      i = numelem - rp < itemsread ? numelem - rp : itemsread;
+      memcpy(out, &(buffer[elemsize * rp]), (size_t) i * elemsize);
+      memcpy((char *) out + (i * elemsize), buffer,
+             (size_t) (itemsread - i) * elemsize);
+      rp += itemsread;
+      if (rp >= numelem)
+        rp -= numelem;
+#ifdef HAVE_ATOMIC_BUILTIN
+      __sync_synchronize();     /* finish reading before freeing space */
       __sync_lock_test_and_set(&((circular_buffer *)p)->rp,rp);
 #else
       ((circular_buffer *)p)->rp = rp;
@@ -105,13 +110,13 @@ int csoundPeekCircularBuffer(CSOUND *csound, void *p, void *out, int items)
         return 0;
     }
     itemsread = items > remaining ? remaining : items;
-    for(i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-            rp = 0;
-        }
-    }
+#ifdef HAVE_ATOMIC_BUILTIN
+    __sync_synchronize();
+#endif
+    i = numelem - rp < itemsread ? numelem - rp : itemsread;
+    memcpy(out, &(buffer[elemsize * rp]), (size_t) i * elemsize);
+    memcpy((char *) out + (i * elemsize), buffer,
+           (size_t) (itemsread - i) * elemsize);
     return itemsread;
 }
 
@@ -152,12 +157,18 @@ int csoundWriteCircularBuffer(CSOUND *csound, void *p, const void *in, int items
         return 0;
     }
     itemswrite = items > remaining ? remaining : items;
-    for(i=0; i < itemswrite; i++){
-        memcpy(&(buffer[elemsize * wp++]),
-                ((char *) in) + (i * elemsize),  elemsize);
-        if(wp == numelem) wp = 0;
-    }
 #ifdef HAVE_ATOMIC_BUILTIN
+    __sync_synchronize();       /* the reader is done with this space */
+#endif
+    i = numelem - wp < itemswrite ? numelem - wp : itemswrite;
+    memcpy(&(buffer[elemsize * wp]), in, (size_t) i * elemsize);
+    memcpy(buffer, ((const char *) in) + (i * elemsize),
+           (size_t) (itemswrite - i) * elemsize);
+    wp += itemswrite;
+    if (wp >= numelem)
+      wp -= numelem;
+#ifdef HAVE_ATOMIC_BUILTIN
+      __sync_synchronize();     /* publish the items before wp */
       __sync_lock_test_and_set(&((circular_buffer *)p)->wp,wp);
 #else
       ((circular_buffer *)p)->wp = wp;
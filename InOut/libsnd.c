@@ -23,7 +23,9 @@
 
 #include "csoundCore.h"                 /*             SNDLIB.C         */
 #include "soundio.h"
+#include "aops_simd.h"
 #include <stdlib.h>
+#include <math.h>
 #ifdef HAVE_SYS_TYPES_H
 # include <sys/types.h>
 #endif
@@ -57,14 +59,58 @@ static inline void alloc_globals(CSOUND *csound)
    audtran to flush when this happens.
 */
 
+/* frames metered per call of the peak kernel, so that frame numbers
+   stay exact in the kernel's MYFLT positions */
+#define METER_FRAMES  4096
+
+/* meter nframes frames of nchnls samples from frame number frame0 */
+static void spout_peak(CSOUND *csound, const MYFLT *sp, uint32 nchnls,
+                       uint32 nframes, uint32 frame0, MYFLT lim)
+{
+    MYFLT   pos[MAXCHNLS], over[MAXCHNLS];
+    uint32  c;
+
+    for (c = 0; c < nchnls; c++) {
+      pos[c] = FL(-1.0);
+      over[c] = FL(0.0);
+    }
+    aops_kernels->peak(csound->maxamp, pos, over, sp, nchnls, nframes, lim);
+    for (c = 0; c < nchnls; c++) {
+      if (pos[c] >= FL(0.0))                /*  maxamp this seg  */
+        csound->maxpos[c] = frame0 + (uint32) pos[c];
+      if (over[c] > FL(0.0)) {              /* out of range?     */
+        csound->rngcnt[c] += (int32) over[c];   /*  report it    */
+        csound->rngflg = 1;
+      }
+    }
+}
+
+/* meter n samples of spout, a frame of nchnls at a time, as if sample
+   by sample: the peak of each channel, the frame it was first reached
+   in, and the samples over lim */
+static void spout_meter(CSOUND *csound, const MYFLT *sp, uint32 n,
+                        uint32 nchnls, MYFLT lim)
+{
+    uint32  nframes = n / nchnls, f, k;
+
+    for (f = 0; f < nframes; f += k) {
+      k = (nframes - f < METER_FRAMES ? nframes - f : METER_FRAMES);
+      spout_peak(csound, sp + f * nchnls, nchnls, k, STA(nframes) + f, lim);
+    }
+    if (n > nframes * nchnls)               /* part of a frame   */
+      spout_peak(csound, sp + nframes * nchnls, n - nframes * nchnls, 1,
+                 STA(nframes) + nframes, lim);
+    STA(nframes) += nframes;
+}
+
 static void spoutsf(CSOUND *csound)
 {
-    uint32_t   chn = 0;
     int     n;
     int spoutrem = csound->nspout;
     MYFLT   *sp = csound->spout;
-    MYFLT   absamp = FL(0.0);
-    uint32  nframes = csound->libsndStatics.nframes;
+
+    spout_meter(csound, sp, (uint32) spoutrem,
+                csound->multichan ? csound->nchnls : 1, csound->e0dbfs);
  nchk:
     /* if nspout remaining > buf rem, prepare to send in parts */
     if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem) {
@@ -72,31 +118,12 @@ static void spoutsf(CSOUND *csound)
     }
     spoutrem -= n;
     csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen) {
-        *csound->libsndStatics.outbufp++ = (absamp * csound->dbfs_to_float);
-      }
-      if (absamp < FL(0.0)) {
-        absamp = -absamp;
-      }
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
-      }
-      if (absamp > csound->e0dbfs) {        /* out of range?     */
-        csound->rngcnt[chn]++;              /*  report it        */
-        csound->rngflg = 1;
-      }
-      if (csound->multichan) {
-        if (++chn >= csound->nchnls) {
-            chn = 0;
-            nframes++;
-        }
-      } else {
-        nframes++;
-      }
-    } while (--n);
+    if (csound->libsndStatics.osfopen) {
+      aops_kernels->vs[AOPS_MUL](csound->libsndStatics.outbufp, sp,
+                                 csound->dbfs_to_float, (uint32_t) n);
+      csound->libsndStatics.outbufp += n;
+    }
+    sp += n;
     if (!csound->libsndStatics.outbufrem) {
       if (csound->libsndStatics.osfopen) {
         csound->nrecs++;
@@ -109,38 +136,29 @@ static void spoutsf(CSOUND *csound)
           goto nchk;
       }
     }
-    csound->libsndStatics.nframes = nframes;
 }
 
 /* special version of spoutsf for "raw" floating point files */
 
 static void spoutsf_noscale(CSOUND *csound)
 {
-    uint32_t chn = 0;
     int      n, spoutrem = csound->nspout;
     MYFLT    *sp = csound->spout;
-    MYFLT    absamp = FL(0.0);
-    uint32   nframes = csound->libsndStatics.nframes;
 
+    /* no range check */
+    spout_meter(csound, sp, (uint32) spoutrem, csound->nchnls,
+                (MYFLT) HUGE_VAL);
  nchk:
     /* if nspout remaining > buf rem, prepare to send in parts */
     if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem)
       n = (int)csound->libsndStatics.outbufrem;
     spoutrem -= n;
     csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen)
-        *csound->libsndStatics.outbufp++ = absamp;
-      if (absamp < FL(0.0))
-        absamp = -absamp;
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
-      }
-      if (++chn >= csound->nchnls)
-        chn = 0, nframes++;
-    } while (--n);
+    if (csound->libsndStatics.osfopen) {
+      memcpy(csound->libsndStatics.outbufp, sp, n * sizeof(MYFLT));
+      csound->libsndStatics.outbufp += n;
+    }
+    sp += n;
 
     if (!csound->libsndStatics.outbufrem) {
       if (csound->libsndStatics.osfopen) {
@@ -152,26 +170,14 @@ static void spoutsf_noscale(CSOUND *csound)
       csound->libsndStatics.outbufrem = csound->oparms_.outbufsamps;
       if (spoutrem) goto nchk;
     }
-    csound->libsndStatics.nframes = nframes;
 }
 
-/* diskfile write option for audtran's */
-/*      assigned during sfopenout()    */
-
-static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+/* heartbeat shown for each buffer written (--heartbeat) */
+static void sf_heartbeat(CSOUND *csound)
 {
-    OPARMS  *O = csound->oparms;
     int     n;
 
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader((void *)STA(outfile));
-    switch (O->heartbeat) {
+    switch (csound->oparms->heartbeat) {
       case 1:
         csound->MessageS(csound, CSOUNDMSG_REALTIME,
                                  "%c\010", "|/-\\"[csound->nrecs & 3]);
@@ -197,208 +203,249 @@ static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     }
 }
 
-static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+/* Sound file writer thread (--sf-writer=N).  The performance thread
+   queues each full output buffer and goes on filling the next of N
+   buffers, while the writer thread encodes and writes the queued ones
+   with the audtran chosen by sfopenout().  It only waits when all N are
+   queued; these waits are counted and reported by sfcloseout(). */
+
+typedef struct {
+    CSOUND  *csound;
+    void    (*write)(CSOUND *, const MYFLT *, int);
+    MYFLT   **bufs;
+    int     *nbytes;
+    int     nbufs, head, count;     /* next buffer to write, number queued */
+    int     running;
+    int     err, errn, errnbytes;   /* a short write, for sndwrterr() */
+    long    written, waits;
+    pthread_mutex_t lock;
+    pthread_cond_t  full, empty;    /* a buffer was queued, or written */
+    pthread_t thread;
+} SFWRITER;
+
+/* after a buffer is written: errors, header rewrites and heartbeat */
+static void writesf_done(CSOUND *csound, int n, int nbytes)
 {
     OPARMS  *O = csound->oparms;
+    SFWRITER *w = (SFWRITER*) STA(writer);
+
+    if (UNLIKELY(n < nbytes)) {
+      if (w != NULL) {              /* reported by the performance thread */
+        w->errn = n;
+        w->errnbytes = nbytes;
+        w->err = 1;
+        return;
+      }
+      sndwrterr(csound, n, nbytes);
+    }
+    if (UNLIKELY(O->rewrt_hdr)) {
+      if (csound->oparmsExt.rewrtInterval > 0.0 &&
+          csound->csRtClock != NULL) {
+        double  t = csound->GetRealTime(csound->csRtClock);
+        if (t - STA(hdrtime) >= csound->oparmsExt.rewrtInterval) {
+          rewriteheader((void *)STA(outfile));
+          STA(hdrtime) = t;
+        }
+      }
+      else
+        rewriteheader((void *)STA(outfile));
+    }
+    if (w == NULL)
+      sf_heartbeat(csound);
+}
+
+static void *sfwriter_thread(void *w_)
+{
+    SFWRITER *w = (SFWRITER*) w_;
+    MYFLT   *buf;
+    int     nbytes;
+
+    pthread_mutex_lock(&w->lock);
+    while (1) {
+      if (w->count == 0) {
+        if (!w->running)
+          break;
+        pthread_cond_wait(&w->full, &w->lock);
+        continue;
+      }
+      buf = w->bufs[w->head];
+      nbytes = w->nbytes[w->head];
+      pthread_mutex_unlock(&w->lock);
+      if (!w->err)                  /* after an error, drop the rest */
+        w->write(w->csound, buf, nbytes);
+      pthread_mutex_lock(&w->lock);
+      w->head = (w->head + 1) % w->nbufs;
+      w->count--;
+      w->written++;
+      pthread_cond_signal(&w->empty);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+/* write out what is queued, end the thread, and go back to writing
+   on the performance thread */
+static void sfwriter_stop(CSOUND *csound)
+{
+    SFWRITER *w = (SFWRITER*) STA(writer);
+    int     i;
+
+    pthread_mutex_lock(&w->lock);
+    w->running = 0;
+    pthread_cond_signal(&w->full);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->thread, NULL);
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->full);
+    pthread_cond_destroy(&w->empty);
+    csound->Message(csound, Str("writer thread: %ld buffers written, "
+                                "performance waited %ld times\n"),
+                    w->written, w->waits);
+    csound->audtran = w->write;
+    STA(writer) = NULL;
+    for (i = 0; i < w->nbufs; i++)
+      if (w->bufs[i] != STA(outbuf))
+        csound->Free(csound, w->bufs[i]);
+    csound->Free(csound, w->bufs);
+    csound->Free(csound, w->nbytes);
+    csound->Free(csound, w);
+}
+
+/* audtran with a writer thread: queue outbuf, and move STA(outbuf) on
+   to the next free buffer */
+static void writesf_async(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    SFWRITER *w = (SFWRITER*) STA(writer);
+    int     err, errn, errnbytes;
+
+    IGN(outbuf);                    /* always the buffer at the tail */
+    pthread_mutex_lock(&w->lock);
+    w->nbytes[(w->head + w->count) % w->nbufs] = nbytes;
+    w->count++;
+    pthread_cond_signal(&w->full);
+    if (w->count == w->nbufs) {
+      w->waits++;
+      while (w->count == w->nbufs)
+        pthread_cond_wait(&w->empty, &w->lock);
+    }
+    STA(outbuf) = w->bufs[(w->head + w->count) % w->nbufs];
+    err = w->err;
+    errn = w->errn;
+    errnbytes = w->errnbytes;
+    pthread_mutex_unlock(&w->lock);
+    if (UNLIKELY(err)) {
+      sfwriter_stop(csound);
+      sndwrterr(csound, errn, errnbytes);
+    }
+    sf_heartbeat(csound);
+}
+
+/* start a writer thread with nbufs buffers of outbufsiz bytes, the first
+   of which is STA(outbuf) */
+static void sfwriter_start(CSOUND *csound, int nbufs)
+{
+    SFWRITER *w;
+    int     i;
+
+    w = (SFWRITER*) csound->Calloc(csound, sizeof(SFWRITER));
+    w->csound = csound;
+    w->write = csound->audtran;
+    w->nbufs = nbufs;
+    w->bufs = (MYFLT**) csound->Malloc(csound, nbufs * sizeof(MYFLT*));
+    w->nbytes = (int*) csound->Calloc(csound, nbufs * sizeof(int));
+    w->bufs[0] = STA(outbuf);
+    for (i = 1; i < nbufs; i++)
+      w->bufs[i] = (MYFLT*) csound->Malloc(csound, STA(outbufsiz));
+    w->running = 1;
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->full, NULL);
+    pthread_cond_init(&w->empty, NULL);
+    if (UNLIKELY(pthread_create(&w->thread, NULL, sfwriter_thread, w) != 0)) {
+      csound->Warning(csound, Str("could not start the sound file writer "
+                                  "thread; writing on the performance "
+                                  "thread"));
+      pthread_mutex_destroy(&w->lock);
+      pthread_cond_destroy(&w->full);
+      pthread_cond_destroy(&w->empty);
+      for (i = 1; i < nbufs; i++)
+        csound->Free(csound, w->bufs[i]);
+      csound->Free(csound, w->bufs);
+      csound->Free(csound, w->nbytes);
+      csound->Free(csound, w);
+      return;
+    }
+    STA(writer) = (void*) w;
+    csound->audtran = writesf_async;
+}
+
+/* diskfile write option for audtran's */
+/*      assigned during sfopenout()    */
+
+static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
     int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
 
     if (UNLIKELY(STA(outfile) == NULL))
       return;
+    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
+                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
+    writesf_done(csound, n, nbytes);
+}
 
-    for (n=0; n<m; n++) {
-      int   tmp = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
-      buf[n] += result;
-    }
+static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    int     n;
+
+    if (UNLIKELY(STA(outfile) == NULL))
+      return;
+
+    aops_dither_add((MYFLT*) outbuf, nbytes / sizeof(MYFLT), 1,
+                    (MYFLT) 0x7fff, &STA(dither));
     n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
                              nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
+    writesf_done(csound, n, nbytes);
 }
 
 static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
-    OPARMS  *O = csound->oparms;
     int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
 
     if (UNLIKELY(STA(outfile) == NULL))
       return;
 
-    for (n=0; n<m; n++) {
-      int   tmp = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
-    }
+    aops_dither_add((MYFLT*) outbuf, nbytes / sizeof(MYFLT), 1,
+                    (MYFLT) 0x7f, &STA(dither));
     n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
                              nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
+    writesf_done(csound, n, nbytes);
 }
 
 static void writesf_dither_u16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
-    OPARMS  *O = csound->oparms;
     int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
 
     if (UNLIKELY(STA(outfile) == NULL))
       return;
 
-    for (n=0; n<m; n++) {
-        int   rnd = ((STA(dither) * 15625) + 1) & 0xFFFF;
-        MYFLT result;
-        STA(dither) = rnd;
-        result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-        result /= ((MYFLT) 0x7fff);
-        buf[n] += result;
-    }
+    aops_dither_add((MYFLT*) outbuf, nbytes / sizeof(MYFLT), 0,
+                    (MYFLT) 0x7fff, &STA(dither));
     n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
                              nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
+    writesf_done(csound, n, nbytes);
 }
 
 static void writesf_dither_u8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
-    OPARMS  *O = csound->oparms;
     int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
 
     if (UNLIKELY(STA(outfile) == NULL))
       return;
 
-    for (n=0; n<m; n++) {
-      int   rnd = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
-    }
+    aops_dither_add((MYFLT*) outbuf, nbytes / sizeof(MYFLT), 0,
+                    (MYFLT) 0x7f, &STA(dither));
     n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
                              nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
+    writesf_done(csound, n, nbytes);
 }
 
 static int readsf(CSOUND *csound, MYFLT *inbuf, int inbufsize)
@@ -848,6 +895,9 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
     }
     STA(osfopen)   = 1;
     STA(outbufrem) = O->outbufsamps;
+    if (csound->oparmsExt.sfWriterBuffers > 1 && STA(pipdevout) != 2 &&
+        STA(outfile) != NULL)
+      sfwriter_start(csound, csound->oparmsExt.sfWriterBuffers);
 }
 
 void sfclosein(CSOUND *csound)
@@ -886,6 +936,8 @@ void sfcloseout(CSOUND *csound)
       csound->nrecs++;
       csound->audtran(csound, STA(outbuf), nb);
     }
+    if (STA(writer) != NULL)
+      sfwriter_stop(csound);
     if (STA(pipdevout) == 2 && (!STA(isfopen) || STA(pipdevin) != 2)) {
       /* close only if not open for input too */
       csound->rtclose_callback(csound);
@@ -21,6 +21,7 @@
 
 #include "csoundCore.h"
 #include "soundio.h"
+#include "sndcache.h"
 #include <sndfile.h>
 
 void rewriteheader(void *ofd)
@@ -251,13 +252,8 @@ void *sndgetset(CSOUND *csound, void *p_)
     return NULL;
 }
 
-/* a simplified soundin */
-
-int getsndin(CSOUND *csound, void *fd_, MYFLT *fp, int nlocs, void *p_)
+static MYFLT getsndin_scalefac(CSOUND *csound, SOUNDIN *p)
 {
-    SNDFILE *fd = (SNDFILE*) fd_;
-    SOUNDIN *p = (SOUNDIN*) p_;
-    int     i = 0, n;
     MYFLT   scalefac;
 
     if (p->format == AE_FLOAT || p->format == AE_DOUBLE) {
@@ -271,6 +267,17 @@ int getsndin(CSOUND *csound, void *fd_, MYFLT *fp, int nlocs, void *p_)
     }
     else
       scalefac = csound->e0dbfs;
+    return scalefac;
+}
+
+/* a simplified soundin */
+
+int getsndin(CSOUND *csound, void *fd_, MYFLT *fp, int nlocs, void *p_)
+{
+    SNDFILE *fd = (SNDFILE*) fd_;
+    SOUNDIN *p = (SOUNDIN*) p_;
+    int     i = 0, n;
+    MYFLT   scalefac = getsndin_scalefac(csound, p);
 
     if (p->nchanls == 1 || p->channel == ALLCHNLS) {  /* MONO or ALLCHNLS */
       for ( ; i < nlocs; i++) {
@@ -308,6 +315,66 @@ int getsndin(CSOUND *csound, void *fd_, MYFLT *fp, int nlocs, void *p_)
     return n;
 }
 
+/* getsndin() from the sample cache, for a SOUNDIN opened by sndgetset():
+   reads the same samples from the start, skip time and channel given to
+   sndgetset(), and leaves p->audrem as the samples of the file not read.
+   Returns -1 if the file is not in the cache and cannot be added, or if
+   the cached floats would differ from the samples sf_read_MYFLT() gives,
+   in which case the caller should use getsndin(). */
+
+int getsndin_cached(CSOUND *csound, MYFLT *fp, int nlocs, void *p_)
+{
+    SOUNDIN *p = (SOUNDIN*) p_;
+    SF_INFO sfinfo;
+    float   *data, *src;
+    int64_t nframes, start, nsrc, zeros;
+    int     i = 0, nch = p->nchanls, skipframes;
+    int     framesinbuf = (int) SNDINBUFSIZ / nch;
+    MYFLT   scalefac = getsndin_scalefac(csound, p);
+
+#ifdef USE_DOUBLE
+    if (!sndcache_exact(FORMAT2SF(p->format)))
+      return -1;
+#endif
+    memset(&sfinfo, 0, sizeof(SF_INFO));
+    sfinfo.format = FORMAT2SF(p->format) | TYPE2SF(p->filetyp);
+    sfinfo.channels = nch;
+    sfinfo.samplerate = (int) p->sr;
+    data = sndcache_get(csound, csound->GetFileName(p->fd), &sfinfo);
+    if (data == NULL)
+      return -1;
+    nframes = (int64_t) sfinfo.frames;
+    /* leading zeros and first frame as in sndgetset() */
+    skipframes = (int) ((double) p->skiptime * (double) p->sr
+                        + (p->skiptime >= FL(0.0) ? 0.5 : -0.5));
+    start = (skipframes > 0 ? (int64_t) skipframes : (int64_t) 0);
+    zeros = (skipframes < 0 ? (int64_t) -skipframes * nch : (int64_t) 0);
+    if (start >= nframes) {
+      start = nframes;
+      zeros = (skipframes < framesinbuf ? 0 : (int64_t) framesinbuf * nch);
+    }
+    src = data + start * nch;
+    nsrc = (nframes - start) * nch;
+
+    if (nch == 1 || p->channel == ALLCHNLS) {       /* MONO or ALLCHNLS */
+      for ( ; i < nlocs && zeros > 0; i++, zeros--)
+        fp[i] = FL(0.0);
+      for ( ; i < nlocs && nsrc > 0; i++, nsrc--)
+        fp[i] = (MYFLT) *src++ * scalefac;
+    }
+    else {                                /* MULTI-CHANNEL, SELECT ONE */
+      int   ch = p->channel - 1;
+      for ( ; i < nlocs && zeros > 0; i++, zeros -= nch)
+        fp[i] = FL(0.0);
+      for ( ; i < nlocs && nsrc > 0; i++, nsrc -= nch, src += nch)
+        fp[i] = (MYFLT) src[ch] * scalefac;
+    }
+    p->audrem = nsrc;
+    sndcache_release(csound, data);
+    memset(&(fp[i]), 0, (nlocs-i)*sizeof(MYFLT)); /* if incomplete PAD */
+    return i;
+}
+
 void dbfs_init(CSOUND *csound, MYFLT dbfs)
 {
     csound->dbfs_to_float = FL(1.0) / dbfs;
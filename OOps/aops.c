@@ -22,6 +22,7 @@
 
 #include "csoundCore.h" /*                                      AOPS.C  */
 #include "aops.h"
+#include "aops_simd.h"
 #include <math.h>
 #include <time.h>
 
@@ -273,23 +274,29 @@ int modkk(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define KA(OPNAME,OP)                           \
+/* The a-rate arithmetic below runs through the vector kernels in
+   aops_simd.c.  Without sample-accurate offsets the whole block goes to
+   the kernel; otherwise the edges are cleared and the middle is passed. */
+
+#define KA(OPNAME,OPCODE,OP)                    \
   int OPNAME(CSOUND *csound, AOP *p) {          \
-    uint32_t n, nsmps = CS_KSMPS;                    \
+    uint32_t nsmps = CS_KSMPS;                  \
     if (LIKELY(nsmps!=1)) {                     \
-      MYFLT   *r, a, *b;                          \
+      MYFLT   *r = p->r;                        \
       uint32_t offset = p->h.insdshead->ksmps_offset;  \
       uint32_t early  = p->h.insdshead->ksmps_no_end;  \
-      r = p->r;                                        \
-      a = *p->a;                                       \
-      b = p->b;                                        \
+      if (LIKELY((offset|early) == 0)) {               \
+        aops_kernels->sv[OPCODE](r, *p->a, p->b, nsmps); \
+        return OK;                                     \
+      }                                                \
       if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
       if (UNLIKELY(early)) {                           \
         nsmps -= early;                                \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));  \
       }                                                \
-      for (n=offset; n<nsmps; n++)                     \
-        r[n] = a OP b[n];                              \
+      if (nsmps > offset)                              \
+        aops_kernels->sv[OPCODE](&r[offset], *p->a, &p->b[offset], \
+                                 nsmps-offset);        \
       return OK;                                       \
     }                                                  \
     else {                                             \
@@ -298,10 +305,10 @@ int modkk(CSOUND *csound, AOP *p)
     }                                                  \
   }
 
-KA(addka,+)
-KA(subka,-)
-KA(mulka,*)
-KA(divka,/)
+KA(addka,AOPS_ADD,+)
+KA(subka,AOPS_SUB,-)
+KA(mulka,AOPS_MUL,*)
+KA(divka,AOPS_DIV,/)
 
 /* ********COULD BE IMPROVED******** */
 int modka(CSOUND *csound, AOP *p)
@@ -324,24 +331,26 @@ int modka(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define AK(OPNAME,OP)                           \
+#define AK(OPNAME,OPCODE,OP)                    \
   int OPNAME(CSOUND *csound, AOP *p) {          \
-    uint32_t n, nsmps = CS_KSMPS;               \
+    uint32_t nsmps = CS_KSMPS;                  \
     if (LIKELY(nsmps != 1)) {                   \
-      MYFLT   *r, *a, b;                        \
+      MYFLT   *r = p->r;                        \
       uint32_t offset = p->h.insdshead->ksmps_offset;  \
       uint32_t early  = p->h.insdshead->ksmps_no_end;  \
-      r = p->r;                                 \
-      a = p->a;                                 \
-      b = *p->b;                                \
+      if (LIKELY((offset|early) == 0)) {        \
+        aops_kernels->vs[OPCODE](r, p->a, *p->b, nsmps); \
+        return OK;                              \
+      }                                         \
       if (UNLIKELY(offset))                     \
         memset(r, '\0', offset*sizeof(MYFLT));  \
       if (UNLIKELY(early)) {                    \
         nsmps -= early;                         \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
       }                                         \
-      for (n=offset; n<nsmps; n++)              \
-        r[n] = a[n] OP b;                       \
+      if (nsmps > offset)                       \
+        aops_kernels->vs[OPCODE](&r[offset], &p->a[offset], *p->b, \
+                                 nsmps-offset); \
       return OK;                                \
     }                                           \
     else {                                      \
@@ -350,12 +359,12 @@ int modka(CSOUND *csound, AOP *p)
     }                                           \
 }
 
-AK(addak,+)
-AK(subak,-)
-AK(mulak,*)
-//AK(divak,/)
+AK(addak,AOPS_ADD,+)
+AK(subak,AOPS_SUB,-)
+AK(mulak,AOPS_MUL,*)
+//AK(divak,AOPS_DIV,/)
 int divak(CSOUND *csound, AOP *p) {
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
     MYFLT b = *p->b;
     if (LIKELY(nsmps != 1)) {
       MYFLT   *r, *a;
@@ -366,14 +375,18 @@ int divak(CSOUND *csound, AOP *p) {
       b = *p->b;
       if (UNLIKELY(b==FL(0.0)))
         csound->Warning(csound, Str("Division by zero"));
+      if (LIKELY((offset|early) == 0)) {
+        aops_kernels->vs[AOPS_DIV](r, a, b, nsmps);
+        return OK;
+      }
       if (UNLIKELY(offset))
         memset(r, '\0', offset*sizeof(MYFLT));
       if (UNLIKELY(early)) {
         nsmps -= early;
-        memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
+        memset(&r[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        r[n] = a[n] / b;
+      if (nsmps > offset)
+        aops_kernels->vs[AOPS_DIV](&r[offset], &a[offset], b, nsmps-offset);
       return OK;
     }
     else {
@@ -406,23 +419,26 @@ int modak(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define AA(OPNAME,OP)                           \
+#define AA(OPNAME,OPCODE,OP)                    \
   int OPNAME(CSOUND *csound, AOP *p) {          \
-  MYFLT   *r, *a, *b;                           \
-  uint32_t n, nsmps = CS_KSMPS;                 \
+  MYFLT   *r;                                   \
+  uint32_t nsmps = CS_KSMPS;                    \
   if (LIKELY(nsmps!=1)) {                       \
     uint32_t offset = p->h.insdshead->ksmps_offset;       \
     uint32_t early  = p->h.insdshead->ksmps_no_end;  \
     r = p->r;                                   \
-    a = p->a;                                   \
-    b = p->b;                                   \
+    if (LIKELY((offset|early) == 0)) {          \
+      aops_kernels->vv[OPCODE](r, p->a, p->b, nsmps); \
+      return OK;                                \
+    }                                           \
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
     if (UNLIKELY(early)) {                      \
       nsmps -= early;                           \
       memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
     }                                           \
-    for (n=offset; n<nsmps; n++)                \
-      r[n] = a[n] OP b[n];                      \
+    if (nsmps > offset)                         \
+      aops_kernels->vv[OPCODE](&r[offset], &p->a[offset], &p->b[offset], \
+                               nsmps-offset);   \
     return OK;                                  \
   }                                             \
     else {                                      \
@@ -431,10 +447,136 @@ int modak(CSOUND *csound, AOP *p)
     }                                           \
   }
 
-AA(addaa,+)
-AA(subaa,-)
-AA(mulaa,*)
-AA(divaa,/)
+AA(addaa,AOPS_ADD,+)
+AA(subaa,AOPS_SUB,-)
+AA(mulaa,AOPS_MUL,*)
+AA(divaa,AOPS_DIV,/)
+
+/* fused arithmetic: decode the program string, folding a leaf that is
+   immediately consumed by a binary op into that op */
+
+int fuse_init(CSOUND *csound, FUSEOP *p)
+{
+    const char  *s = p->prog->data;
+    int         nargs = (int) p->INOCOUNT - 1, depth = 0, n = 0;
+    unsigned char op;
+    FUSE_INSTR  *ins;
+
+    for ( ; *s != '\0'; s++) {
+      if (UNLIKELY(n >= FUSE_MAXCODE))
+        goto err;
+      ins = &p->code[n];
+      if ((*s >= 'A' && *s <= 'Z') || (*s >= 'a' && *s <= 'z')) {
+        int audio = (*s <= 'Z');
+        int arg = *s - (audio ? 'A' : 'a');
+        if (UNLIKELY(arg >= nargs))
+          goto err;
+        ins->op = FUSE_PUSH;
+        ins->src = audio ? FUSE_SRC_AUDIO : FUSE_SRC_SCALAR;
+        ins->arg = (unsigned char) arg;
+        if (UNLIKELY(++depth > FUSE_STACK))
+          goto err;
+        n++;
+        continue;
+      }
+      switch (*s) {
+      case '~':
+        if (UNLIKELY(depth < 1))
+          goto err;
+        ins->op = FUSE_NEG;
+        ins->src = FUSE_SRC_STACK;
+        n++;
+        continue;
+      case '+': op = FUSE_ADD; break;
+      case '-': op = FUSE_SUB; break;
+      case '*': op = FUSE_MUL; break;
+      default:
+        goto err;
+      }
+      if (UNLIKELY(depth < 2))
+        goto err;
+      depth--;
+      if (p->code[n-1].op == FUSE_PUSH)     /* right operand is a leaf: */
+        p->code[n-1].op = op;               /* use it in place */
+      else {
+        ins->op = op;
+        ins->src = FUSE_SRC_STACK;
+        n++;
+      }
+    }
+    if (UNLIKELY(depth != 1 || n == 0))
+      goto err;
+    p->ncode = n;
+    return OK;
+ err:
+    return csound->InitError(csound, Str("invalid fused expression '%s'"),
+                             p->prog->data);
+}
+
+int fuse_perf(CSOUND *csound, FUSEOP *p)
+{
+    MYFLT       stack[FUSE_STACK][FUSE_CHUNK];
+    MYFLT       *r = p->r, *top, *b, k;
+    uint32_t    offset = p->h.insdshead->ksmps_offset;
+    uint32_t    early  = p->h.insdshead->ksmps_no_end;
+    uint32_t    n, i, len, nsmps = CS_KSMPS;
+    const FUSE_INSTR *ins, *end = p->code + p->ncode;
+    int         sp;
+    IGN(csound);
+
+    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
+    }
+    for (n = offset; n < nsmps; n += len) {
+      len = nsmps - n;
+      if (len > FUSE_CHUNK) len = FUSE_CHUNK;
+      sp = -1;
+      for (ins = p->code; ins < end; ins++) {
+        if (ins->op == FUSE_PUSH) {
+          top = stack[++sp];
+          if (ins->src == FUSE_SRC_AUDIO)
+            memcpy(top, p->args[ins->arg] + n, len*sizeof(MYFLT));
+          else {
+            k = *p->args[ins->arg];
+            for (i = 0; i < len; i++) top[i] = k;
+          }
+          continue;
+        }
+        if (ins->op == FUSE_NEG) {
+          top = stack[sp];
+          for (i = 0; i < len; i++) top[i] = -top[i];
+          continue;
+        }
+        if (ins->src == FUSE_SRC_SCALAR) {
+          top = stack[sp];
+          k = *p->args[ins->arg];
+          switch (ins->op) {
+          case FUSE_ADD: for (i = 0; i < len; i++) top[i] += k; break;
+          case FUSE_SUB: for (i = 0; i < len; i++) top[i] -= k; break;
+          default:       for (i = 0; i < len; i++) top[i] *= k; break;
+          }
+          continue;
+        }
+        if (ins->src == FUSE_SRC_AUDIO) {
+          top = stack[sp];
+          b = p->args[ins->arg] + n;
+        }
+        else {
+          b = stack[sp--];
+          top = stack[sp];
+        }
+        switch (ins->op) {
+        case FUSE_ADD: for (i = 0; i < len; i++) top[i] += b[i]; break;
+        case FUSE_SUB: for (i = 0; i < len; i++) top[i] -= b[i]; break;
+        default:       for (i = 0; i < len; i++) top[i] *= b[i]; break;
+        }
+      }
+      memcpy(&r[n], stack[0], len*sizeof(MYFLT));
+    }
+    return OK;
+}
 
 /* ********COULD BE IMPROVED******** */
 int modaa(CSOUND *csound, AOP *p)
@@ -578,20 +720,22 @@ int int1(CSOUND *csound, EVAL *p)               /* returns signed whole no. */
 /* ********COULD BE IMPROVED******** */
 int int1a(CSOUND *csound, EVAL *p)              /* returns signed whole no. */
 {
-    MYFLT        intpart, *a=p->a, *r=p->r;
+    MYFLT        *a=p->a, *r=p->r;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
 
+    if (LIKELY((offset|early) == 0)) {
+      aops_kernels->trunc(r, a, nsmps);
+      return OK;
+    }
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++) {
-      MODF(a[n], &intpart);
-      r[n] = intpart;
-    }
+    if (nsmps > offset)
+      aops_kernels->trunc(&r[offset], &a[offset], nsmps-offset);
     return OK;
 }
 
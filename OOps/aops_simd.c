@@ -0,0 +1,395 @@
+/*
+    aops_simd.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"                         /*      AOPS_SIMD.C     */
+#include "aops_simd.h"
+#include <math.h>
+
+/* Every instruction set gets the same kernels, written once as macros
+   over its load/store/arithmetic intrinsics.  Only IEEE add, subtract,
+   multiply, divide and truncation are used, and the remainder of each
+   block is done with the plain C operator, so each table gives exactly
+   the scalar results.  The peak kernel only compares and selects, with
+   the absolute value taken by clearing the sign bit; this differs from
+   the scalar negation only for -0 and NaN, which never compare greater
+   than the (non-negative) peak or the limit.  The x86 kernels are
+   compiled with target attributes and chosen with
+   __builtin_cpu_supports(), so no special compiler flags are needed;
+   NEON is part of every aarch64 CPU. */
+
+#define SIMD_VV(NAME, ATTR, W, LD, ST, VOP, OP)                         \
+  static ATTR void NAME(MYFLT *r, const MYFLT *a, const MYFLT *b,       \
+                        uint32_t n)                                     \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      for ( ; i + W <= n; i += W)                                       \
+        ST(&r[i], VOP(LD(&a[i]), LD(&b[i])));                           \
+      for ( ; i < n; i++)                                               \
+        r[i] = a[i] OP b[i];                                            \
+  }
+
+#define SIMD_SV(NAME, ATTR, VT, W, LD, ST, SET1, VOP, OP)               \
+  static ATTR void NAME(MYFLT *r, MYFLT a, const MYFLT *b, uint32_t n)  \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT va = SET1(a);                                                  \
+      for ( ; i + W <= n; i += W)                                       \
+        ST(&r[i], VOP(va, LD(&b[i])));                                  \
+      for ( ; i < n; i++)                                               \
+        r[i] = a OP b[i];                                               \
+  }
+
+#define SIMD_VS(NAME, ATTR, VT, W, LD, ST, SET1, VOP, OP)               \
+  static ATTR void NAME(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n)  \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      VT vb = SET1(b);                                                  \
+      for ( ; i + W <= n; i += W)                                       \
+        ST(&r[i], VOP(LD(&a[i]), vb));                                  \
+      for ( ; i < n; i++)                                               \
+        r[i] = a[i] OP b;                                               \
+  }
+
+#define SIMD_TRUNC(NAME, ATTR, W, LD, ST, VTRUNC)                       \
+  static ATTR void NAME(MYFLT *r, const MYFLT *a, uint32_t n)           \
+  {                                                                     \
+      uint32_t i = 0;                                                   \
+      MYFLT   intpart;                                                  \
+      for ( ; i + W <= n; i += W)                                       \
+        ST(&r[i], VTRUNC(LD(&a[i])));                                   \
+      for ( ; i < n; i++) {                                             \
+        MODF(a[i], &intpart);                                           \
+        r[i] = intpart;                                                 \
+      }                                                                 \
+  }
+
+/* peak of one channel, frame by frame; also the scalar table */
+static inline void peak_chn(MYFLT *amax, MYFLT *apos, MYFLT *over,
+                            const MYFLT *x, uint32_t nchnls,
+                            uint32_t nframes, MYFLT lim)
+{
+    MYFLT   m = *amax, p = *apos, o = *over;
+    uint32_t f;
+
+    for (f = 0; f < nframes; f++, x += nchnls) {
+      MYFLT a = *x;
+      if (a < FL(0.0))
+        a = -a;
+      if (a > m)
+        m = a, p = (MYFLT) f;
+      if (a > lim)
+        o += FL(1.0);
+    }
+    *amax = m; *apos = p; *over = o;
+}
+
+/* W channels at a time, each running down its stride of the frames in
+   registers; the channels left over are done one by one */
+#define SIMD_PEAK(NAME, ATTR, VT, MT, W, LD, ST, SET1, VABS, VGT, VSEL,  \
+                  VINC)                                                 \
+  static ATTR void NAME(MYFLT *amax, MYFLT *apos, MYFLT *over,          \
+                        const MYFLT *x, uint32_t nchnls,                \
+                        uint32_t nframes, MYFLT lim)                    \
+  {                                                                     \
+      uint32_t c = 0, f;                                                \
+      VT vlim = SET1(lim), vone = SET1(FL(1.0));                        \
+      for ( ; c + W <= nchnls; c += W) {                                \
+        VT m = LD(&amax[c]), p = LD(&apos[c]), o = LD(&over[c]);        \
+        const MYFLT *xp = &x[c];                                        \
+        for (f = 0; f < nframes; f++, xp += nchnls) {                   \
+          VT a = VABS(LD(xp));                                          \
+          MT up = VGT(a, m);                                            \
+          m = VSEL(up, a, m);                                           \
+          p = VSEL(up, SET1((MYFLT) f), p);                             \
+          o = VINC(o, VGT(a, vlim), vone);                              \
+        }                                                               \
+        ST(&amax[c], m);                                                \
+        ST(&apos[c], p);                                                \
+        ST(&over[c], o);                                                \
+      }                                                                 \
+      for ( ; c < nchnls; c++)                                          \
+        peak_chn(&amax[c], &apos[c], &over[c], &x[c], nchnls, nframes,  \
+                 lim);                                                  \
+  }
+
+#define SIMD_ARITH(P, ATTR, VT, W, LD, ST, SET1, VADD, VSUB, VMUL, VDIV) \
+  SIMD_VV(P##_addvv, ATTR, W, LD, ST, VADD, +)                          \
+  SIMD_VV(P##_subvv, ATTR, W, LD, ST, VSUB, -)                          \
+  SIMD_VV(P##_mulvv, ATTR, W, LD, ST, VMUL, *)                          \
+  SIMD_VV(P##_divvv, ATTR, W, LD, ST, VDIV, /)                          \
+  SIMD_SV(P##_addsv, ATTR, VT, W, LD, ST, SET1, VADD, +)                \
+  SIMD_SV(P##_subsv, ATTR, VT, W, LD, ST, SET1, VSUB, -)                \
+  SIMD_SV(P##_mulsv, ATTR, VT, W, LD, ST, SET1, VMUL, *)                \
+  SIMD_SV(P##_divsv, ATTR, VT, W, LD, ST, SET1, VDIV, /)                \
+  SIMD_VS(P##_addvs, ATTR, VT, W, LD, ST, SET1, VADD, +)                \
+  SIMD_VS(P##_subvs, ATTR, VT, W, LD, ST, SET1, VSUB, -)                \
+  SIMD_VS(P##_mulvs, ATTR, VT, W, LD, ST, SET1, VMUL, *)                \
+  SIMD_VS(P##_divvs, ATTR, VT, W, LD, ST, SET1, VDIV, /)
+
+#define SIMD_TABLE(P, NAME, TRUNC, PEAK)                                \
+  static const AOPS_KERNELS P##_kernels = {                             \
+    NAME,                                                               \
+    { P##_addvv, P##_subvv, P##_mulvv, P##_divvv },                     \
+    { P##_addsv, P##_subsv, P##_mulsv, P##_divsv },                     \
+    { P##_addvs, P##_subvs, P##_mulvs, P##_divvs },                     \
+    TRUNC,                                                              \
+    PEAK                                                                \
+  };
+
+/* scalar reference, also the fallback: one "lane" */
+
+#define SCALAR_LD(p)        (*(p))
+#define SCALAR_ST(p, x)     (*(p) = (x))
+#define SCALAR_SET1(x)      (x)
+#define SCALAR_ADD(x, y)    ((x) + (y))
+#define SCALAR_SUB(x, y)    ((x) - (y))
+#define SCALAR_MUL(x, y)    ((x) * (y))
+#define SCALAR_DIV(x, y)    ((x) / (y))
+#define NO_ATTR
+
+SIMD_ARITH(scalar, NO_ATTR, MYFLT, 1, SCALAR_LD, SCALAR_ST, SCALAR_SET1,
+           SCALAR_ADD, SCALAR_SUB, SCALAR_MUL, SCALAR_DIV)
+static void scalar_trunc(MYFLT *r, const MYFLT *a, uint32_t n)
+{
+    uint32_t i;
+    MYFLT   intpart;
+    for (i = 0; i < n; i++) {
+      MODF(a[i], &intpart);
+      r[i] = intpart;
+    }
+}
+static void scalar_peak(MYFLT *amax, MYFLT *apos, MYFLT *over,
+                        const MYFLT *x, uint32_t nchnls, uint32_t nframes,
+                        MYFLT lim)
+{
+    uint32_t c;
+    for (c = 0; c < nchnls; c++)
+      peak_chn(&amax[c], &apos[c], &over[c], &x[c], nchnls, nframes, lim);
+}
+SIMD_TABLE(scalar, "scalar", scalar_trunc, scalar_peak)
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define AOPS_SIMD_X86
+#include <immintrin.h>
+
+#define ATTR_AVX2   __attribute__((target("avx2")))
+#define ATTR_AVX512 __attribute__((target("avx512f")))
+
+/* SSE2 is part of x86_64; its truncation needs SSE4.1, so int() stays
+   scalar here */
+#ifdef USE_DOUBLE
+#define SSE2_ABS(x)         _mm_andnot_pd(_mm_set1_pd(-0.0), x)
+#define SSE2_SEL(k, a, b)   _mm_or_pd(_mm_and_pd(k, a), _mm_andnot_pd(k, b))
+#define SSE2_INC(o, k, one) _mm_add_pd(o, _mm_and_pd(k, one))
+SIMD_ARITH(sse2, NO_ATTR, __m128d, 2, _mm_loadu_pd, _mm_storeu_pd,
+           _mm_set1_pd, _mm_add_pd, _mm_sub_pd, _mm_mul_pd, _mm_div_pd)
+SIMD_PEAK(sse2_peak, NO_ATTR, __m128d, __m128d, 2, _mm_loadu_pd,
+          _mm_storeu_pd, _mm_set1_pd, SSE2_ABS, _mm_cmpgt_pd, SSE2_SEL,
+          SSE2_INC)
+#else
+#define SSE2_ABS(x)         _mm_andnot_ps(_mm_set1_ps(-0.0f), x)
+#define SSE2_SEL(k, a, b)   _mm_or_ps(_mm_and_ps(k, a), _mm_andnot_ps(k, b))
+#define SSE2_INC(o, k, one) _mm_add_ps(o, _mm_and_ps(k, one))
+SIMD_ARITH(sse2, NO_ATTR, __m128, 4, _mm_loadu_ps, _mm_storeu_ps,
+           _mm_set1_ps, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_div_ps)
+SIMD_PEAK(sse2_peak, NO_ATTR, __m128, __m128, 4, _mm_loadu_ps,
+          _mm_storeu_ps, _mm_set1_ps, SSE2_ABS, _mm_cmpgt_ps, SSE2_SEL,
+          SSE2_INC)
+#endif
+SIMD_TABLE(sse2, "sse2", scalar_trunc, sse2_peak)
+
+#ifdef USE_DOUBLE
+#define AVX2_TRUNC(x)   _mm256_round_pd(x, _MM_FROUND_TO_ZERO)
+SIMD_ARITH(avx2, ATTR_AVX2, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd,
+           _mm256_set1_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd,
+           _mm256_div_pd)
+SIMD_TRUNC(avx2_trunc, ATTR_AVX2, 4, _mm256_loadu_pd, _mm256_storeu_pd,
+           AVX2_TRUNC)
+#define AVX2_ABS(x)         _mm256_andnot_pd(_mm256_set1_pd(-0.0), x)
+#define AVX2_GT(a, b)       _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+#define AVX2_SEL(k, a, b)   _mm256_blendv_pd(b, a, k)
+#define AVX2_INC(o, k, one) _mm256_add_pd(o, _mm256_and_pd(k, one))
+SIMD_PEAK(avx2_peak, ATTR_AVX2, __m256d, __m256d, 4, _mm256_loadu_pd,
+          _mm256_storeu_pd, _mm256_set1_pd, AVX2_ABS, AVX2_GT, AVX2_SEL,
+          AVX2_INC)
+#else
+#define AVX2_TRUNC(x)   _mm256_round_ps(x, _MM_FROUND_TO_ZERO)
+SIMD_ARITH(avx2, ATTR_AVX2, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps,
+           _mm256_set1_ps, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps,
+           _mm256_div_ps)
+SIMD_TRUNC(avx2_trunc, ATTR_AVX2, 8, _mm256_loadu_ps, _mm256_storeu_ps,
+           AVX2_TRUNC)
+#define AVX2_ABS(x)         _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x)
+#define AVX2_GT(a, b)       _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define AVX2_SEL(k, a, b)   _mm256_blendv_ps(b, a, k)
+#define AVX2_INC(o, k, one) _mm256_add_ps(o, _mm256_and_ps(k, one))
+SIMD_PEAK(avx2_peak, ATTR_AVX2, __m256, __m256, 8, _mm256_loadu_ps,
+          _mm256_storeu_ps, _mm256_set1_ps, AVX2_ABS, AVX2_GT, AVX2_SEL,
+          AVX2_INC)
+#endif
+SIMD_TABLE(avx2, "avx2", avx2_trunc, avx2_peak)
+
+#ifdef USE_DOUBLE
+#define AVX512_TRUNC(x) \
+  _mm512_roundscale_pd(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)
+SIMD_ARITH(avx512, ATTR_AVX512, __m512d, 8, _mm512_loadu_pd,
+           _mm512_storeu_pd, _mm512_set1_pd, _mm512_add_pd, _mm512_sub_pd,
+           _mm512_mul_pd, _mm512_div_pd)
+SIMD_TRUNC(avx512_trunc, ATTR_AVX512, 8, _mm512_loadu_pd, _mm512_storeu_pd,
+           AVX512_TRUNC)
+#define AVX512_GT(a, b)     _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)
+#define AVX512_SEL(k, a, b) _mm512_mask_blend_pd(k, b, a)
+#define AVX512_INC(o, k, one) _mm512_mask_add_pd(o, k, o, one)
+SIMD_PEAK(avx512_peak, ATTR_AVX512, __m512d, __mmask8, 8, _mm512_loadu_pd,
+          _mm512_storeu_pd, _mm512_set1_pd, _mm512_abs_pd, AVX512_GT,
+          AVX512_SEL, AVX512_INC)
+#else
+#define AVX512_TRUNC(x) \
+  _mm512_roundscale_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)
+SIMD_ARITH(avx512, ATTR_AVX512, __m512, 16, _mm512_loadu_ps,
+           _mm512_storeu_ps, _mm512_set1_ps, _mm512_add_ps, _mm512_sub_ps,
+           _mm512_mul_ps, _mm512_div_ps)
+SIMD_TRUNC(avx512_trunc, ATTR_AVX512, 16, _mm512_loadu_ps,
+           _mm512_storeu_ps, AVX512_TRUNC)
+#define AVX512_GT(a, b)     _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)
+#define AVX512_SEL(k, a, b) _mm512_mask_blend_ps(k, b, a)
+#define AVX512_INC(o, k, one) _mm512_mask_add_ps(o, k, o, one)
+SIMD_PEAK(avx512_peak, ATTR_AVX512, __m512, __mmask16, 16, _mm512_loadu_ps,
+          _mm512_storeu_ps, _mm512_set1_ps, _mm512_abs_ps, AVX512_GT,
+          AVX512_SEL, AVX512_INC)
+#endif
+SIMD_TABLE(avx512, "avx512", avx512_trunc, avx512_peak)
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define AOPS_SIMD_NEON
+#include <arm_neon.h>
+
+#ifdef USE_DOUBLE
+SIMD_ARITH(neon, NO_ATTR, float64x2_t, 2, vld1q_f64, vst1q_f64,
+           vdupq_n_f64, vaddq_f64, vsubq_f64, vmulq_f64, vdivq_f64)
+SIMD_TRUNC(neon_trunc, NO_ATTR, 2, vld1q_f64, vst1q_f64, vrndq_f64)
+#define NEON_INC(o, k, one) \
+  vaddq_f64(o, vreinterpretq_f64_u64(vandq_u64(k, vreinterpretq_u64_f64(one))))
+SIMD_PEAK(neon_peak, NO_ATTR, float64x2_t, uint64x2_t, 2, vld1q_f64,
+          vst1q_f64, vdupq_n_f64, vabsq_f64, vcgtq_f64, vbslq_f64, NEON_INC)
+#else
+SIMD_ARITH(neon, NO_ATTR, float32x4_t, 4, vld1q_f32, vst1q_f32,
+           vdupq_n_f32, vaddq_f32, vsubq_f32, vmulq_f32, vdivq_f32)
+SIMD_TRUNC(neon_trunc, NO_ATTR, 4, vld1q_f32, vst1q_f32, vrndq_f32)
+#define NEON_INC(o, k, one) \
+  vaddq_f32(o, vreinterpretq_f32_u32(vandq_u32(k, vreinterpretq_u32_f32(one))))
+SIMD_PEAK(neon_peak, NO_ATTR, float32x4_t, uint32x4_t, 4, vld1q_f32,
+          vst1q_f32, vdupq_n_f32, vabsq_f32, vcgtq_f32, vbslq_f32, NEON_INC)
+#endif
+SIMD_TABLE(neon, "neon", neon_trunc, neon_peak)
+#endif
+
+const AOPS_KERNELS *aops_kernels = &scalar_kernels;
+
+/* supported tables, slowest first */
+static const AOPS_KERNELS *aops_tables[5];
+static int aops_ntables = 0;
+
+void aops_simd_init(void)
+{
+    int n = 0;
+
+    if (aops_ntables) return;
+    aops_tables[n++] = &scalar_kernels;
+#if defined(AOPS_SIMD_X86)
+    __builtin_cpu_init();
+    aops_tables[n++] = &sse2_kernels;
+    if (__builtin_cpu_supports("avx2"))
+      aops_tables[n++] = &avx2_kernels;
+    if (__builtin_cpu_supports("avx512f"))
+      aops_tables[n++] = &avx512_kernels;
+#elif defined(AOPS_SIMD_NEON)
+    aops_tables[n++] = &neon_kernels;
+#endif
+    aops_kernels = aops_tables[n - 1];
+    aops_ntables = n;
+}
+
+const AOPS_KERNELS *aops_simd_table(int i)
+{
+    aops_simd_init();
+    return (i >= 0 && i < aops_ntables) ? aops_tables[i] : NULL;
+}
+
+/* Dither noise is the 16 bit LCG d = 15625 * d + 1, with one step per
+   sample for rectangular noise and two (summed) for triangular noise.
+   DITHER_LANES consecutive samples are made at once, each lane jumping
+   DITHER_LANES samples ahead per step, and the noise is then scaled and
+   added with the kernels of aops_kernels, in the same operations as one
+   sample at a time. */
+#define DITHER_LANES  8
+#define DITHER_BLOCK  512
+
+#define DITHER_STEP(d)  (((d) * 15625 + 1) & 0xFFFF)
+
+void aops_dither_add(MYFLT *buf, uint32_t m, int tpdf, MYFLT scale,
+                     int *seed)
+{
+    MYFLT   noise[DITHER_BLOCK];
+    uint32_t lane[DITHER_LANES], jmul = 1, jadd = 0, d = (uint32_t) *seed;
+    uint32_t i, j, k, n;
+
+    /* d -> jmul * d + jadd is DITHER_LANES samples' worth of steps */
+    for (j = 0; j < DITHER_LANES * (tpdf ? 2 : 1); j++) {
+      jmul = (jmul * 15625) & 0xFFFF;
+      jadd = DITHER_STEP(jadd);
+    }
+    for (n = 0; n < m; n += k, buf += k) {
+      k = (m - n < DITHER_BLOCK ? m - n : DITHER_BLOCK);
+      for (j = 0; j < DITHER_LANES; j++) {
+        lane[j] = d;
+        d = (tpdf ? DITHER_STEP(DITHER_STEP(d)) : DITHER_STEP(d));
+      }
+      for (i = 0; i + DITHER_LANES <= k; i += DITHER_LANES) {
+        for (j = 0; j < DITHER_LANES; j++) {
+          uint32_t tmp = DITHER_STEP(lane[j]), rnd = tmp;
+          if (tpdf) {
+            rnd = DITHER_STEP(tmp);
+            rnd = (rnd + tmp) >> 1;         /* triangular distribution */
+          }
+          noise[i + j] = (MYFLT) ((int) rnd - 0x8000);
+          lane[j] = (jmul * lane[j] + jadd) & 0xFFFF;
+        }
+      }
+      d = lane[0];
+      for ( ; i < k; i++) {
+        uint32_t tmp = DITHER_STEP(d), rnd = tmp;
+        if (tpdf) {
+          rnd = DITHER_STEP(tmp);
+          d = rnd;
+          rnd = (rnd + tmp) >> 1;
+        }
+        else d = rnd;
+        noise[i] = (MYFLT) ((int) rnd - 0x8000);
+      }
+      aops_kernels->vs[AOPS_DIV](noise, noise, (MYFLT) 0x10000, k);
+      aops_kernels->vs[AOPS_DIV](noise, noise, scale, k);
+      aops_kernels->vv[AOPS_ADD](buf, buf, noise, k);
+    }
+    *seed = (int) d;
+}
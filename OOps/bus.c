@@ -423,14 +423,17 @@ static CS_NOINLINE int create_new_channel(CSOUND *csound, const char *name,
 }
 
 
-PUBLIC int csoundGetChannelPtr(CSOUND *csound,
-                               MYFLT **p, const char *name, int type)
+/* find or create channel 'name' of the given type; on failure, returns
+   NULL with the csoundGetChannelPtr() error code in *err */
+static CHNENTRY *get_channel_entry(CSOUND *csound, const char *name,
+                                   int type, int *err)
 {
     CHNENTRY  *pp;
 
-    *p = (MYFLT*) NULL;
-    if (UNLIKELY(name == NULL))
-      return CSOUND_ERROR;
+    if (UNLIKELY(name == NULL)) {
+      *err = CSOUND_ERROR;
+      return NULL;
+    }
     pp = find_channel(csound, name);
     if (!pp) {
         if (create_new_channel(csound, name, type) == CSOUND_SUCCESS) {
@@ -438,13 +441,106 @@ PUBLIC int csoundGetChannelPtr(CSOUND *csound,
         }
     }
     if (pp != NULL) {
-      if ((pp->type ^ type) & CSOUND_CHANNEL_TYPE_MASK)
-        return pp->type;
+      if ((pp->type ^ type) & CSOUND_CHANNEL_TYPE_MASK) {
+        *err = pp->type;
+        return NULL;
+      }
       pp->type |= (type & (CSOUND_INPUT_CHANNEL | CSOUND_OUTPUT_CHANNEL));
-      *p = pp->data;
-      return CSOUND_SUCCESS;
+      *err = CSOUND_SUCCESS;
+      return pp;
+    }
+    *err = CSOUND_ERROR;
+    return NULL;
+}
+
+static inline int *channel_lock(CHNENTRY *pp)
+{
+#ifndef MACOSX
+#if defined(HAVE_PTHREAD_SPIN_LOCK)
+    return (int*)pp->lock;
+#else
+    return &(pp->lock);
+#endif
+#else
+    return &(pp->lock);
+#endif
+}
+
+PUBLIC int csoundGetChannelPtr(CSOUND *csound,
+                               MYFLT **p, const char *name, int type)
+{
+    CHNENTRY  *pp;
+    int       err;
+
+    pp = get_channel_entry(csound, name, type, &err);
+    *p = pp != NULL ? pp->data : (MYFLT*) NULL;
+    return err;
+}
+
+PUBLIC CSOUND_CHANNEL_HANDLE csoundGetChannelHandle(CSOUND *csound,
+                                                    const char *name, int type)
+{
+    int       err;
+    return get_channel_entry(csound, name, type, &err);
+}
+
+PUBLIC int csoundSetControlChannels(CSOUND *csound,
+                                    const CSOUND_CHANNEL_HANDLE *handles,
+                                    const MYFLT *values, int n)
+{
+    int       i, err = CSOUND_SUCCESS;
+    IGN(csound);
+
+    for (i = 0; i < n; i++) {
+      CHNENTRY *pp = handles[i];
+      if (UNLIKELY(pp == NULL ||
+                   (pp->type & CSOUND_CHANNEL_TYPE_MASK) !=
+                   CSOUND_CONTROL_CHANNEL)) {
+        err = CSOUND_ERROR;
+        continue;
+      }
+#ifdef HAVE_ATOMIC_BUILTIN
+      *((volatile MYFLT*) pp->data) = values[i];
+#else
+      csoundSpinLock(channel_lock(pp));
+      *(pp->data) = values[i];
+      csoundSpinUnLock(channel_lock(pp));
+#endif
+    }
+#ifdef HAVE_ATOMIC_BUILTIN
+    __sync_synchronize();
+#endif
+    return err;
+}
+
+PUBLIC int csoundGetControlChannels(CSOUND *csound,
+                                    const CSOUND_CHANNEL_HANDLE *handles,
+                                    MYFLT *values, int n)
+{
+    int       i, err = CSOUND_SUCCESS;
+    IGN(csound);
+
+#ifdef HAVE_ATOMIC_BUILTIN
+    __sync_synchronize();
+#endif
+    for (i = 0; i < n; i++) {
+      CHNENTRY *pp = handles[i];
+      if (UNLIKELY(pp == NULL ||
+                   (pp->type & CSOUND_CHANNEL_TYPE_MASK) !=
+                   CSOUND_CONTROL_CHANNEL)) {
+        values[i] = FL(0.0);
+        err = CSOUND_ERROR;
+        continue;
+      }
+#ifdef HAVE_ATOMIC_BUILTIN
+      values[i] = *((volatile MYFLT*) pp->data);
+#else
+      csoundSpinLock(channel_lock(pp));
+      values[i] = *(pp->data);
+      csoundSpinUnLock(channel_lock(pp));
+#endif
     }
-    return CSOUND_ERROR;
+    return err;
 }
 
 PUBLIC int csoundGetChannelDatasize(CSOUND *csound, const char *name){
@@ -471,18 +567,7 @@ PUBLIC int *csoundGetChannelLock(CSOUND *csound,
     if (UNLIKELY(name == NULL))
       return NULL;
     pp = find_channel(csound, name);
-    if (pp) {
-#ifndef MACOSX
-#if defined(HAVE_PTHREAD_SPIN_LOCK)
-      return (int*)pp->lock;
-#else
-      return &(pp->lock);
-#endif
-#else
-      return &(pp->lock);
-#endif
-    }
-    else return NULL;
+    return pp != NULL ? channel_lock(pp) : NULL;
 }
 
 static int cmp_func(const void *p1, const void *p2)
@@ -639,6 +724,36 @@ static CS_NOINLINE int print_chn_err(void *p, int err)
     return csound->InitError(csound, Str(msg));
 }
 
+/* resolve the channel of a chnget/chnset opcode with a single lookup */
+
+static int chn_resolve(CSOUND *csound, CHNGET *p, int type)
+{
+    int   err;
+
+    p->entry = get_channel_entry(csound, (char*) p->iname->data, type, &err);
+    if (UNLIKELY(p->entry == NULL)) {
+      p->fp = NULL;
+      p->lock = NULL;
+      return err;
+    }
+    p->fp = p->entry->data;
+    p->lock = channel_lock(p->entry);
+    return CSOUND_SUCCESS;
+}
+
+/* at perf time, a string-named channel is only looked up again if the
+   name has changed since the last cycle */
+
+static int chn_resolve_perf(CSOUND *csound, CHNGET *p, int type)
+{
+    if (LIKELY(p->entry != NULL &&
+               strcmp(p->entry->name, (char*) p->iname->data) == 0)) {
+      p->fp = p->entry->data;
+      return CSOUND_SUCCESS;
+    }
+    return chn_resolve(csound, p, type);
+}
+
 /* receive control value from bus at performance time */
 static int chnget_opcode_perf_k(CSOUND *csound, CHNGET *p)
 {
@@ -715,9 +830,7 @@ int chnget_opcode_init_k(CSOUND *csound, CHNGET *p)
 {
     int   err;
 
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
-    p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
+    err = chn_resolve(csound, p, CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
     if (LIKELY(!err)) {
       p->h.opadr = (SUBR) chnget_opcode_perf_k;
       return OK;
@@ -731,9 +844,7 @@ int chnget_opcode_init_a(CSOUND *csound, CHNGET *p)
 {
     int   err;
     p->pos = 0;
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
-    p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
+    err = chn_resolve(csound, p, CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
 
     if (LIKELY(!err)) {
       p->h.opadr = (SUBR) chnget_opcode_perf_a;
@@ -748,9 +859,7 @@ int chnget_opcode_init_S(CSOUND *csound, CHNGET *p)
 {
     int   err;
     char *s = ((STRINGDAT *) p->arg)->data;
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_STRING_CHANNEL | CSOUND_INPUT_CHANNEL);
-    p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
+    err = chn_resolve(csound, p, CSOUND_STRING_CHANNEL | CSOUND_INPUT_CHANNEL);
 
     if (UNLIKELY(err))
       return print_chn_err(p, err);
@@ -771,9 +880,8 @@ int chnget_opcode_perf_S(CSOUND *csound, CHNGET *p)
 {
     int   err;
     char *s = ((STRINGDAT *) p->arg)->data;
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_STRING_CHANNEL | CSOUND_INPUT_CHANNEL);
-     p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
+    err = chn_resolve_perf(csound, p,
+                           CSOUND_STRING_CHANNEL | CSOUND_INPUT_CHANNEL);
 
     if (UNLIKELY(err))
       return print_chn_err(p, err);
@@ -913,10 +1021,9 @@ int chnset_opcode_init_k(CSOUND *csound, CHNGET *p)
 {
     int   err;
 
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    err = chn_resolve(csound, p,
+                      CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (LIKELY(!err)) {
-      p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
       p->h.opadr = (SUBR) chnset_opcode_perf_k;
       return OK;
     }
@@ -929,10 +1036,8 @@ int chnset_opcode_init_a(CSOUND *csound, CHNGET *p)
 {
     int   err;
     p->pos = 0;
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    err = chn_resolve(csound, p, CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (!err) {
-      p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
       p->h.opadr = (SUBR) chnset_opcode_perf_a;
       return OK;
     }
@@ -945,10 +1050,8 @@ int chnmix_opcode_init(CSOUND *csound, CHNGET *p)
 {
     int   err;
 
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    err = chn_resolve(csound, p, CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (LIKELY(!err)) {
-      p->lock = csoundGetChannelLock(csound, (char*) p->iname->data);
       p->h.opadr = (SUBR) chnmix_opcode_perf;
       return OK;
     }
@@ -980,15 +1083,13 @@ int chnset_opcode_init_S(CSOUND *csound, CHNGET *p)
     int  *lock;
     char *s = ((STRINGDAT *) p->arg)->data;
 
-    err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                              CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    err = chn_resolve(csound, p, CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     // size = csoundGetChannelDatasize(csound, p->iname->data);
     if (UNLIKELY(err))
       return print_chn_err(p, err);
 
     if (s==NULL) return NOTOK;
-    p->lock = lock =
-      csoundGetChannelLock(csound, (char*) p->iname->data);
+    lock = p->lock;
     csoundSpinLock(lock);
     if (strlen(s) >= (unsigned int) ((STRINGDAT *)p->fp)->size) {
       if (((STRINGDAT *)p->fp)->data != NULL)
@@ -1010,8 +1111,8 @@ int chnset_opcode_perf_S(CSOUND *csound, CHNGET *p)
     int  *lock;
     char *s = ((STRINGDAT *) p->arg)->data;
 
-    if ((err=csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
-                                 CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL)))
+    if ((err=chn_resolve_perf(csound, p,
+                              CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL)))
       return err;
     // size = csoundGetChannelDatasize(csound, p->iname->data);
 
@@ -1019,8 +1120,7 @@ int chnset_opcode_perf_S(CSOUND *csound, CHNGET *p)
     if (((STRINGDAT *)p->fp)->data
         && strcmp(s, ((STRINGDAT *)p->fp)->data) == 0) return OK;
 
-    p->lock = lock =
-      csoundGetChannelLock(csound, (char*) p->iname->data);
+    lock = p->lock;
     csoundSpinLock(lock);
     if (strlen(s) >= (unsigned int) ((STRINGDAT *)p->fp)->size) {
       if (((STRINGDAT *)p->fp)->data != NULL)
@@ -26,12 +26,214 @@
 #include "diskin2.h"
 #include <math.h>
 
+/* Asynchronous diskin2 (realtime audio without iforceSync): a pool of
+   refill threads, shared by all streaming instances, decodes ahead into
+   each instance's circular buffer, and the performance thread reads one
+   k-cycle block from it.  An instance asks for a refill when its buffer
+   falls below half of the read-ahead, which grows with the number of
+   voices per refill thread, and is refilled by one thread at a time. */
+
+#define DISKIN_MAXTHREADS   4   /* refill threads                       */
+#define DISKIN_THREADVOICES 32  /* voices per refill thread             */
+#define DISKIN_AHEAD        4   /* least read-ahead, in k-cycle blocks  */
+
+struct DISKIN_POOL_;
+
 typedef struct DISKIN_INST_ {
   CSOUND *csound;
-  DISKIN2 *diskin;
-  struct DISKIN_INST_ *nxt;
+  void   *diskin;               /* DISKIN2 or DISKIN2_ARRAY             */
+  int    (*fill)(CSOUND *, void *); /* decodes one block into cb        */
+  struct DISKIN_POOL_ *pool;
+  void   *cb;
+  int    blockItems;            /* samples in one block                 */
+  int    maxItems;              /* samples cb can hold                  */
+  volatile int queued;          /* samples in cb                        */
+  int    pending;               /* in the refill queue or being filled  */
+  int    busy;                  /* being filled                         */
+  struct DISKIN_INST_ *nxt;     /* refill queue                         */
 } DISKIN_INST;
 
+typedef struct DISKIN_POOL_ {
+  pthread_mutex_t lock;
+  pthread_cond_t  work, done;
+  DISKIN_INST *head, *tail;     /* refill queue                         */
+  int    nvoices, nthreads, running;
+  volatile int aheadBlocks;
+  pthread_t threads[DISKIN_MAXTHREADS];
+} DISKIN_POOL;
+
+static void *diskin_io_thread(void *pool_)
+{
+    DISKIN_POOL *pool = (DISKIN_POOL *) pool_;
+    DISKIN_INST *inst;
+    int     target;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running) {
+      if ((inst = pool->head) == NULL) {
+        pthread_cond_wait(&pool->work, &pool->lock);
+        continue;
+      }
+      if ((pool->head = inst->nxt) == NULL)
+        pool->tail = NULL;
+      inst->busy = 1;
+      pthread_mutex_unlock(&pool->lock);
+      target = pool->aheadBlocks * inst->blockItems;
+      if (target > inst->maxItems - 1)
+        target = inst->maxItems - 1;
+      while (inst->queued + inst->blockItems <= target)
+        if (inst->fill(inst->csound, inst->diskin) != OK)
+          break;
+      pthread_mutex_lock(&pool->lock);
+      inst->busy = inst->pending = 0;
+      pthread_cond_broadcast(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/* queue inst for refill, unless it is queued already */
+static void diskin_request(DISKIN_INST *inst)
+{
+    DISKIN_POOL *pool = inst->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    if (!inst->pending) {
+      inst->pending = 1;
+      inst->nxt = NULL;
+      if (pool->tail != NULL)
+        pool->tail->nxt = inst;
+      else
+        pool->head = inst;
+      pool->tail = inst;
+      pthread_cond_signal(&pool->work);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void diskin_pool_resize(DISKIN_POOL *pool)
+{
+    int     n = 1 + (pool->nvoices - 1) / DISKIN_THREADVOICES;
+
+    if (n > DISKIN_MAXTHREADS)
+      n = DISKIN_MAXTHREADS;
+#ifndef __EMSCRIPTEN__
+    while (pool->nthreads < n &&
+           pthread_create(&pool->threads[pool->nthreads], NULL,
+                          diskin_io_thread, pool) == 0)
+      pool->nthreads++;
+#endif
+    n = pool->nthreads > 0 ? pool->nthreads : 1;
+    pool->aheadBlocks = DISKIN_AHEAD + pool->nvoices / n;
+}
+
+/* create the circular buffer and refill request of a streaming
+   instance; NULL if there is no memory */
+static DISKIN_INST *diskin_async_init(CSOUND *csound, void *p,
+                                      int (*fill)(CSOUND *, void *),
+                                      int nChannels, int bufSize, int ksmps)
+{
+    DISKIN_POOL *pool;
+    DISKIN_INST *inst;
+    int     n = bufSize * 2;
+    void    *cb;
+
+    if (n < 2 * DISKIN_AHEAD * ksmps)
+      n = 2 * DISKIN_AHEAD * ksmps;
+    n = n * nChannels + 1;
+    if ((cb = csound->CreateCircularBuffer(csound, n, sizeof(MYFLT))) == NULL)
+      return NULL;
+    if ((pool = (DISKIN_POOL *)
+         csound->QueryGlobalVariable(csound, "DISKIN_POOL")) == NULL) {
+      csound->CreateGlobalVariable(csound, "DISKIN_POOL", sizeof(DISKIN_POOL));
+      pool = (DISKIN_POOL *) csound->QueryGlobalVariable(csound, "DISKIN_POOL");
+      pthread_mutex_init(&pool->lock, NULL);
+      pthread_cond_init(&pool->work, NULL);
+      pthread_cond_init(&pool->done, NULL);
+      pool->running = 1;
+    }
+    inst = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
+    inst->csound = csound;
+    inst->diskin = p;
+    inst->fill = fill;
+    inst->pool = pool;
+    inst->cb = cb;
+    inst->blockItems = ksmps * nChannels;
+    inst->maxItems = n;
+    pthread_mutex_lock(&pool->lock);
+    pool->nvoices++;
+    diskin_pool_resize(pool);
+    pthread_mutex_unlock(&pool->lock);
+    return inst;
+}
+
+/* decode the first blocks at init time, so that the stream does not
+   start with an underrun; later blocks are left to the pool */
+static void diskin_prefill(DISKIN_INST *inst)
+{
+    int     n = DISKIN_AHEAD;
+
+    while (n-- > 0 && inst->queued + inst->blockItems < inst->maxItems)
+      if (inst->fill(inst->csound, inst->diskin) != OK)
+        break;
+}
+
+/* stop refilling inst, and free it; the last instance stops the pool */
+static void diskin_async_deinit(CSOUND *csound, DISKIN_INST *inst)
+{
+    DISKIN_POOL *pool;
+    int     i;
+
+    if (inst == NULL)
+      return;
+    pool = inst->pool;
+    pthread_mutex_lock(&pool->lock);
+    if (inst->pending && !inst->busy) {
+      DISKIN_INST **pp = &pool->head, *prv = NULL;
+      while (*pp != inst) {
+        prv = *pp;
+        pp = &((*pp)->nxt);
+      }
+      *pp = inst->nxt;
+      if (pool->tail == inst)
+        pool->tail = prv;
+    }
+    while (inst->busy)
+      pthread_cond_wait(&pool->done, &pool->lock);
+    if (--pool->nvoices > 0) {
+      diskin_pool_resize(pool);
+      pthread_mutex_unlock(&pool->lock);
+    }
+    else {
+      pool->running = 0;
+      pthread_cond_broadcast(&pool->work);
+      pthread_mutex_unlock(&pool->lock);
+      for (i = 0; i < pool->nthreads; i++)
+        pthread_join(pool->threads[i], NULL);
+      pthread_cond_destroy(&pool->done);
+      pthread_cond_destroy(&pool->work);
+      pthread_mutex_destroy(&pool->lock);
+      csound->DestroyGlobalVariable(csound, "DISKIN_POOL");
+    }
+    csound->DestroyCircularBuffer(csound, inst->cb);
+    csound->Free(csound, inst);
+}
+
+/* read nItems samples (whole frames) from the circular buffer of inst,
+   zero filling on underrun, and ask for a refill at the low watermark */
+static void diskin_async_read(CSOUND *csound, DISKIN_INST *inst,
+                              MYFLT *buf, int nItems)
+{
+    int     n = csound->ReadCircularBuffer(csound, inst->cb, buf, nItems);
+
+    __sync_fetch_and_sub(&inst->queued, n);
+    if (UNLIKELY(n < nItems))
+      memset(&buf[n], 0, (nItems - n) * sizeof(MYFLT));
+    if (inst->queued * 2 < inst->pool->aheadBlocks * inst->blockItems &&
+        !inst->pending)
+      diskin_request(inst);
+}
+
 
 static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
                                             DISKIN2 *p, int bufReadPos)
@@ -257,6 +459,9 @@ int diskin_init_S(CSOUND *csound, DISKIN2 *p){
 }
 
 int diskin2_async_deinit(CSOUND *csound, void *p);
+static void diskin2_async_stop(CSOUND *csound, DISKIN2 *p);
+static int diskin_fill(CSOUND *csound, void *p);
+static int diskin_fill_array(CSOUND *csound, void *p);
 
 static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
 {
@@ -277,6 +482,8 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
       /* skip initialisation if requested */
       if (*(p->iSkipInit) != FL(0.0))
         return OK;
+      /* reinit: stop the refills of the old file before closing it */
+      diskin2_async_stop(csound, p);
       fdclose(csound, &(p->fdch));
     }
     /* set default format parameters */
@@ -377,54 +584,22 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
 
     // create circular buffer, on fail set mode to synchronous
     if(csound->realtime_audio_flag==1 && p->fforceSync==0 &&
-       (p->cb = csound->CreateCircularBuffer(csound,
-                                             p->bufSize*p->nChannels*2,
-                                             sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-      int *start;
-      // allocate buffer
-      n = CS_KSMPS*sizeof(MYFLT)*p->nChannels;
+       (p->ioreq = diskin_async_init(csound, p, diskin_fill, p->nChannels,
+                                     p->bufSize, CS_KSMPS)) != NULL){
+      // allocate buffers: one block for the refill thread, one for perf
+      n = 2*CS_KSMPS*sizeof(MYFLT)*p->nChannels;
       if (n != (int)p->auxData2.size)
         csound->AuxAlloc(csound, (int32) n, &(p->auxData2));
       p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
       memset(p->aOut_buf, 0, n);
       p->aOut_bufsize = CS_KSMPS;
+      p->cb = ((DISKIN_INST *) p->ioreq)->cb;
 
-#ifndef __EMSCRIPTEN__
-      if ((top=(DISKIN_INST **)csound->QueryGlobalVariable(csound,
-                                                       "DISKIN_INST")) == NULL){
-        csound->CreateGlobalVariable(csound, "DISKIN_INST", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound, "DISKIN_INST");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound, "DISKIN_PTHREAD", sizeof(pthread_t));
-        csound->CreateGlobalVariable(csound, "DISKIN_THREAD_START", sizeof(int));
-        current = *top;
-      }
-      else
-#endif
-      {
-        current = *top;
-        while(current->nxt != NULL) { /* find next empty slot in chain */
-          current = current->nxt;
-        }
-        current->nxt = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        current = current->nxt;
-      }
-      current->csound = csound;
-      current->diskin = p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if( *(start = csound->QueryGlobalVariable(csound,
-                                                "DISKIN_THREAD_START")) == 0) {
-        void *diskin_io_thread(void *p);
-        *start = 1;
-        pthread_create((pthread_t *)csound->QueryGlobalVariable(csound,
-                                                                "DISKIN_PTHREAD"),
-                       NULL, diskin_io_thread, *top);
+      /* once per note; a reinit reuses it */
+      if (!p->asyncDeinit) {
+        csound->RegisterDeinitCallback(csound, p, diskin2_async_deinit);
+        p->asyncDeinit = 1;
       }
-#endif
-      csound->RegisterDeinitCallback(csound, p, diskin2_async_deinit);
       p->async = 1;
 
       /* print file information */
@@ -454,42 +629,24 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
 
     /* done initialisation */
     p->initDone = 1;
+    if (p->async)
+      diskin_prefill((DISKIN_INST *) p->ioreq);
     return OK;
 }
 
-int diskin2_async_deinit(CSOUND *csound,  void *p){
+static void diskin2_async_stop(CSOUND *csound, DISKIN2 *p){
 
-  DISKIN_INST **top, *current, *prv;
-
-  if ((top = (DISKIN_INST **)
-       csound->QueryGlobalVariable(csound, "DISKIN_INST")) == NULL) return NOTOK;
-   current = *top;
-   prv = NULL;
-   while(current->diskin != (DISKIN2 *)p) {
-        prv = current;
-        current = current->nxt;
-   }
-   if(prv == NULL) *top = current->nxt;
-   else prv->nxt = current->nxt;
+  diskin_async_deinit(csound, (DISKIN_INST *) p->ioreq);
+  p->ioreq = NULL;
+  p->cb = NULL;
+  p->async = 0;
+}
 
-#ifndef __EMSCRIPTEN__
-   if(*top == NULL) {
-     int *start; pthread_t *pt;
-
-     start = (int *) csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-     *start = 0;
-     pt = (pthread_t *) csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD");
-     //csound->Message(csound, "dealloc %p %d\n", start, *start);
-     pthread_join(*pt, NULL);
-     csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD");
-     csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START");
-     csound->DestroyGlobalVariable(csound, "DISKIN_INST");
-   }
-#endif
-   csound->Free(csound, current);
-   csound->DestroyCircularBuffer(csound, ((DISKIN2 *)p)->cb);
+int diskin2_async_deinit(CSOUND *csound,  void *p){
 
-   return OK;
+  diskin2_async_stop(csound, (DISKIN2 *) p);
+  ((DISKIN2 *)p)->asyncDeinit = 0;
+  return OK;
 }
 
 static inline void diskin2_file_pos_inc(DISKIN2 *p, int32 *ndx)
@@ -870,14 +1027,10 @@ int diskin_file_read(CSOUND *csound, DISKIN2 *p)
         }
     }
     {
-    /* write to circular buffer */
-    int lc, mc=0, nc=nsmps*p->nChannels;
-    int *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-    do{
-      lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-      nc -= lc;
-      mc += lc;
-    } while(nc && *start);
+    /* write to circular buffer; the refill thread checked for space */
+    int nc = csound->WriteCircularBuffer(csound, p->cb, aOut,
+                                         nsmps*p->nChannels);
+    __sync_fetch_and_add(&((DISKIN_INST *) p->ioreq)->queued, nc);
     }
     return OK;
  file_error:
@@ -886,15 +1039,19 @@ int diskin_file_read(CSOUND *csound, DISKIN2 *p)
 }
 
 
+static int diskin_fill(CSOUND *csound, void *p)
+{
+    return diskin_file_read(csound, (DISKIN2 *) p);
+}
+
 int diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nn, nsmps = CS_KSMPS;
-    MYFLT samp;
     int chn;
-    void *cb = p->cb;
     int chans = p->nChannels;
+    MYFLT *buf = p->aOut_buf + CS_KSMPS*chans, *src;
 
     if(offset || early) {
    for (chn = 0; chn < chans; chn++)
@@ -908,38 +1065,19 @@ int diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
       return csound->PerfError(csound, p->h.insdshead,
                                Str("diskin2: not initialised"));
     }
-    for (nn = offset; nn < nsmps; nn++){
-
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    /* read the whole block, then deinterleave */
+    diskin_async_read(csound, (DISKIN_INST *) p->ioreq, buf,
+                      (nsmps - offset)*chans);
     for (chn = 0; chn < chans; chn++) {
-      //int i =0;
-      //do {
-      // i =
-       csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        p->aOut[chn][nn] = csound->e0dbfs*samp;
-      }
+      MYFLT *out = p->aOut[chn];
+      for (nn = offset, src = buf + chn; nn < nsmps; nn++, src += chans)
+        out[nn] = csound->e0dbfs * *src;
     }
     return OK;
 }
 
 
-void *diskin_io_thread(void *p){
-  DISKIN_INST *current = (DISKIN_INST *) p;
-  int wakeup = 1000*current->csound->ksmps/current->csound->esr;
-  int *start =
-    current->csound->QueryGlobalVariable(current->csound,"DISKIN_THREAD_START");
-  while(*start){
-    current = (DISKIN_INST *) p;
-    csoundSleep(wakeup > 0 ? wakeup : 1);
-    while(current != NULL){
-      diskin_file_read(current->csound, current->diskin);
-      current = current->nxt;
-  }
-  }
-  return NULL;
-}
-
-
 int diskin2_perf(CSOUND *csound, DISKIN2 *p) {
   if(!p->async) return diskin2_perf_synchronous(csound, p);
   else return diskin2_perf_asynchronous(csound, p);
@@ -1482,42 +1620,19 @@ static inline void diskin2_get_sample_array(CSOUND *csound,
    }
 }
 
-int diskin2_async_deinit_array(CSOUND *csound,  void *p){
+static void diskin2_async_stop_array(CSOUND *csound, DISKIN2_ARRAY *p){
 
-  DISKIN_INST **top, *current, *prv;
-
-  if ((top = (DISKIN_INST **)
-       csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY")) == NULL)
-    return NOTOK;
-   current = *top;
-   prv = NULL;
-   while(current->diskin != (DISKIN2 *)p) {
-        prv = current;
-        current = current->nxt;
-   }
-   if(prv == NULL) *top = current->nxt;
-   else prv->nxt = current->nxt;
-
-#ifndef __EMSCRIPTEN__
-   if(*top == NULL) {
-     int *start; pthread_t *pt;
-
-     start = (int *) csound->QueryGlobalVariable(csound,
-                                                 "DISKIN_THREAD_START_ARRAY");
-     *start = 0;
-     pt = (pthread_t *) csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD_ARRAY");
-     //csound->Message(csound, "dealloc %p %d\n", start, *start);
-     pthread_join(*pt, NULL);
-     csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD_ARRAY");
-     csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START_ARRAY");
-     csound->DestroyGlobalVariable(csound, "DISKIN_INST_ARRAY");
-   }
-#endif
+  diskin_async_deinit(csound, (DISKIN_INST *) p->ioreq);
+  p->ioreq = NULL;
+  p->cb = NULL;
+  p->async = 0;
+}
 
-   csound->Free(csound, current);
-   csound->DestroyCircularBuffer(csound, ((DISKIN2_ARRAY *)p)->cb);
+int diskin2_async_deinit_array(CSOUND *csound,  void *p){
 
-   return OK;
+  diskin2_async_stop_array(csound, (DISKIN2_ARRAY *) p);
+  ((DISKIN2_ARRAY *)p)->asyncDeinit = 0;
+  return OK;
 }
 
 
@@ -1696,14 +1811,10 @@ int diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
         }
     }
     {
-    /* write to circular buffer */
-    int lc, mc=0, nc=nsmps*p->nChannels;
-    int *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-    do{
-      lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-      nc -= lc;
-      mc += lc;
-    } while(nc && *start);
+    /* write to circular buffer; the refill thread checked for space */
+    int nc = csound->WriteCircularBuffer(csound, p->cb, aOut,
+                                         nsmps*p->nChannels);
+    __sync_fetch_and_add(&((DISKIN_INST *) p->ioreq)->queued, nc);
     }
     return OK;
  file_error:
@@ -1711,24 +1822,11 @@ int diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
    return NOTOK;
 }
 
-void *diskin_io_thread_array(void *p){
-  DISKIN_INST *current = (DISKIN_INST *) p;
-  int wakeup = 1000*current->csound->ksmps/current->csound->esr;
-  int *start =
-    current->csound->QueryGlobalVariable(current->csound,
-                                         "DISKIN_THREAD_START_ARRAY");
-  while(*start){
-    current = (DISKIN_INST *) p;
-    csoundSleep(wakeup > 0 ? wakeup : 1);
-    while(current != NULL){
-      diskin_file_read_array(current->csound, (DISKIN2_ARRAY *)current->diskin);
-      current = current->nxt;
-  }
-  }
-  return NULL;
+static int diskin_fill_array(CSOUND *csound, void *p)
+{
+    return diskin_file_read_array(csound, (DISKIN2_ARRAY *) p);
 }
 
-
 static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
 {
     double  pos;
@@ -1743,6 +1841,8 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
       /* skip initialisation if requested */
       if (*(p->iSkipInit) != FL(0.0))
         return OK;
+      /* reinit: stop the refills of the old file before closing it */
+      diskin2_async_stop_array(csound, p);
       fdclose(csound, &(p->fdch));
     }
     /* set default format parameters */
@@ -1858,61 +1958,24 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
 
     // create circular buffer, on fail set mode to synchronous
     if(csound->realtime_audio_flag==1 && p->fforceSync==0 &&
-       (p->cb = csound->CreateCircularBuffer(csound,
-                                             p->bufSize*p->nChannels*2,
-                                             sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-      int *start;
-      // allocate buffer
-      n = CS_KSMPS*sizeof(MYFLT)*p->nChannels;
+       (p->ioreq = diskin_async_init(csound, p, diskin_fill_array,
+                                     p->nChannels, p->bufSize,
+                                     CS_KSMPS)) != NULL){
+      // allocate buffers: one block for the refill thread, one for perf
+      n = 2*CS_KSMPS*sizeof(MYFLT)*p->nChannels;
       if (n != (int)p->auxData2.size)
         csound->AuxAlloc(csound, (int32) n, &(p->auxData2));
       p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
       memset(p->aOut_buf, 0, n);
       p->aOut_bufsize = CS_KSMPS;
+      p->cb = ((DISKIN_INST *) p->ioreq)->cb;
 
-#ifndef __EMSCRIPTEN__
-      if ((top=(DISKIN_INST **)
-           csound->QueryGlobalVariable(csound,
-                                       "DISKIN_INST_ARRAY")) == NULL){
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_INST_ARRAY", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound,
-                                                           "DISKIN_INST_ARRAY");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_PTHREAD_ARRAY", sizeof(pthread_t));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START_ARRAY", sizeof(int));
-        current = *top;
+      /* once per note; a reinit reuses it */
+      if (!p->asyncDeinit) {
+        csound->RegisterDeinitCallback(csound, (DISKIN2 *) p,
+                                       diskin2_async_deinit_array);
+        p->asyncDeinit = 1;
       }
-      else
-#endif
-      {
-        current = *top;
-        while(current->nxt != NULL) { /* find next empty slot in chain */
-          current = current->nxt;
-        }
-        current->nxt = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        current = current->nxt;
-      }
-      current->csound = csound;
-      current->diskin =  (DISKIN2 *) p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if (*(start =
-            csound->QueryGlobalVariable(csound,
-                                        "DISKIN_THREAD_START_ARRAY")) == 0) {
-        void *diskin_io_thread(void *p);
-        *start = 1;
-        pthread_create((pthread_t *)csound->QueryGlobalVariable(csound,
-                                                       "DISKIN_PTHREAD_ARRAY"),
-                       NULL, diskin_io_thread_array, *top);
-      }
-#endif
-      csound->RegisterDeinitCallback(csound, (DISKIN2 *) p,
-                                     diskin2_async_deinit_array);
       p->async = 1;
 
       /* print file information */
@@ -1942,6 +2005,8 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
 
     /* done initialisation */
     p->initDone = 1;
+    if (p->async)
+      diskin_prefill((DISKIN_INST *) p->ioreq);
     return OK;
 }
 
@@ -2140,11 +2205,10 @@ int diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nn, nsmps = CS_KSMPS, ksmps = CS_KSMPS;
-    MYFLT samp;
     int chn;
-    void *cb = p->cb;
     int chans = p->nChannels;
     MYFLT *aOut = (MYFLT *) p->aOut->data;
+    MYFLT *buf = p->aOut_buf + CS_KSMPS*chans, *src;
 
     if(offset || early) {
    for (chn = 0; chn < chans; chn++)
@@ -2158,16 +2222,14 @@ int diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
       return csound->PerfError(csound, p->h.insdshead,
                                Str("diskin2: not initialised"));
     }
-    for (nn = offset; nn < nsmps; nn++){
-
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    /* read the whole block, then deinterleave */
+    diskin_async_read(csound, (DISKIN_INST *) p->ioreq, buf,
+                      (nsmps - offset)*chans);
     for (chn = 0; chn < chans; chn++) {
-      //int i =0;
-      //do {
-      // i =
-       csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        aOut[chn*ksmps+nn] = csound->e0dbfs*samp;
-      }
+      MYFLT *out = aOut + chn*ksmps;
+      for (nn = offset, src = buf + chn; nn < nsmps; nn++, src += chans)
+        out[nn] = csound->e0dbfs * *src;
     }
     return OK;
 }
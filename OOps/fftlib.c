@@ -37,6 +37,10 @@
 /* fft's with M bigger than this bust primary cache */
 #define MCACHE  (11 - (sizeof(MYFLT) / 8))
 
+/* real fft's of this size and up go to the planned code in fftplan.c,
+   which is faster from here on */
+#define FFT_PLAN_MINSIZE  64
+
 /* some math constants to 40 decimal places */
 #define MYPI      3.141592653589793238462643383279502884197   /* pi         */
 #define MYROOT2   1.414213562373095048801688724209698078569   /* sqrt(2)    */
@@ -3276,7 +3280,13 @@ void csoundRealFFT(CSOUND *csound, MYFLT *buf, int FFTsize)
     MYFLT *Utbl;
     int16 *BRLow;
     int   M;
+    CSOUND_FFT_SETUP *p;
 
+    if (FFTsize >= FFT_PLAN_MINSIZE &&
+        (p = csoundRealFFTSetup(csound, FFTsize, FFT_FWD)) != NULL) {
+      csoundRealFFTExecute(csound, p, buf);
+      return;
+    }
     M = ConvertFFTSize(csound, FFTsize);
     getTablePointers(csound, &Utbl, &BRLow, M, (M - 1) / 2);
     rffts1(buf, M, Utbl, BRLow);
@@ -3297,7 +3307,13 @@ void csoundInverseRealFFT(CSOUND *csound, MYFLT *buf, int FFTsize)
     MYFLT *Utbl;
     int16 *BRLow;
     int   M;
+    CSOUND_FFT_SETUP *p;
 
+    if (FFTsize >= FFT_PLAN_MINSIZE &&
+        (p = csoundRealFFTSetup(csound, FFTsize, FFT_INV)) != NULL) {
+      csoundRealFFTExecute(csound, p, buf);
+      return;
+    }
     M = ConvertFFTSize(csound, FFTsize);
     getTablePointers(csound, &Utbl, &BRLow, M, (M - 1) / 2);
     riffts1(buf, M, Utbl, BRLow);
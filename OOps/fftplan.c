@@ -0,0 +1,573 @@
+/*
+    fftplan.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"                         /*      FFTPLAN.C       */
+#include "fftlib.h"
+#include <math.h>
+#ifdef HAVE_FFTW3
+#include <fftw3.h>
+#endif
+
+/* Planned real FFTs of any even length whose half is of the form
+   2^a * 3^b * 5^c, in the packed format of csoundRealFFT().
+
+   A real FFT of N points is done as a complex FFT of N/2 points on the
+   even/odd samples, followed by a pass that separates the two spectra.
+   The complex FFT is a Stockham autosort with radix 4, 2, 3 and 5
+   stages on split real/imaginary arrays, so no bit reversal is needed.
+   Each stage has an inner loop over the stride s, which is written once
+   as a macro over the load/store/arithmetic intrinsics of every
+   instruction set, as in aops_simd.c; a stage runs with the widest
+   kernel whose width divides s, so the first stages, where s is small,
+   are scalar.  Inverse transforms use IFFT(X) = conj(FFT(conj(X))).
+
+   Plans are cached per instance, one for each size and direction, and
+   live until csoundReset().  New plans are made under a process-wide
+   lock, which also serialises the FFTW planner, and are published after
+   they are complete, so lookups need no lock.  A plan keeps a list of
+   scratch buffers: a caller claims a free one, and only adds another
+   when all are in use, so there is one for each thread that runs the
+   plan at the same time. */
+
+#define FFTPLAN_MAXSTAGES  32
+
+/* guards the plan caches, the kernel table and the FFTW planner */
+static pthread_mutex_t fftplan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#if defined(HAVE_ATOMIC_BUILTIN)
+#define PLAN_LOAD(x)        __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define PLAN_PUBLISH(x, v)  __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#define PLAN_TRYLOCK(s)     (__sync_lock_test_and_set(&(s)->busy, 1) == 0)
+#define PLAN_UNLOCK(s)      __sync_lock_release(&(s)->busy)
+#elif defined(MSVC)
+#define PLAN_LOAD(x)        (MemoryBarrier(), (x))
+#define PLAN_PUBLISH(x, v)  (MemoryBarrier(), (x) = (v))
+#define PLAN_TRYLOCK(s)     (_InterlockedExchange(&(s)->busy, 1) == 0)
+#define PLAN_UNLOCK(s)      _InterlockedExchange(&(s)->busy, 0)
+#else
+/* no atomics: scratch buffers are claimed and released under the lock */
+#define PLAN_LOCKED_CLAIM
+#define PLAN_LOAD(x)        (x)
+#define PLAN_PUBLISH(x, v)  ((x) = (v))
+#define PLAN_TRYLOCK(s)     ((s)->busy == 0 && ((s)->busy = 1))
+#define PLAN_UNLOCK(s)      ((s)->busy = 0)
+#endif
+
+typedef void (*FFT_STAGE_FN)(const MYFLT *xr, const MYFLT *xi,
+                             MYFLT *yr, MYFLT *yi, int m, int s,
+                             const MYFLT *twr, const MYFLT *twi);
+
+typedef struct {
+    const char      *name;
+    int             width;
+    FFT_STAGE_FN    stage[6];       /* indexed by radix */
+} FFT_KERNELS;
+
+typedef struct FFT_SCRATCH_ {
+    struct FFT_SCRATCH_ *nxt;
+    volatile int32_t busy;
+    MYFLT           *buf;           /* 4 * M + 2 */
+} FFT_SCRATCH;
+
+struct CSOUND_FFT_SETUP_ {
+    CSOUND_FFT_SETUP *nxt;
+    int             N;              /* real FFT size */
+    int             M;              /* complex FFT size, N / 2 */
+    int             direction;
+    int             nstages;
+    int             radix[FFTPLAN_MAXSTAGES];
+    FFT_STAGE_FN    fn[FFTPLAN_MAXSTAGES];
+    MYFLT           *twr[FFTPLAN_MAXSTAGES], *twi[FFTPLAN_MAXSTAGES];
+    MYFLT           *rtr, *rti;     /* e^(-2 pi i k / N), k < M */
+    FFT_SCRATCH     *volatile scratch;  /* claimed by callers */
+#ifdef HAVE_FFTW3
+#ifdef USE_DOUBLE
+    fftw_plan       fftw;
+#else
+    fftwf_plan      fftw;
+#endif
+#endif
+};
+
+/* y[q + s(r p + k)] = w^(p k) sum_j x[q + s(p + j m)] e^(-2 pi i j k / r),
+   w = e^(-2 pi i / (r m)), for p < m, q < s */
+
+#define FFT_STAGE(NAME, ATTR, VT, W, LD, ST, SET1, ADD, SUB, MUL, R, BFLY) \
+  static ATTR void NAME(const MYFLT *xr, const MYFLT *xi,               \
+                        MYFLT *yr, MYFLT *yi, int m, int s,             \
+                        const MYFLT *twr, const MYFLT *twi)             \
+  {                                                                     \
+      int     p, q, j;                                                  \
+      for (p = 0; p < m; p++) {                                         \
+        VT    wr[R], wi[R];                                             \
+        for (j = 1; j < R; j++) {                                       \
+          wr[j] = SET1(twr[(j - 1) * m + p]);                           \
+          wi[j] = SET1(twi[(j - 1) * m + p]);                           \
+        }                                                               \
+        for (q = 0; q < s; q += W) {                                    \
+          VT  ar[R], ai[R], br[R], bi[R];                               \
+          for (j = 0; j < R; j++) {                                     \
+            ar[j] = LD(&xr[q + s * (p + j * m)]);                       \
+            ai[j] = LD(&xi[q + s * (p + j * m)]);                       \
+          }                                                             \
+          BFLY(VT, SET1, ADD, SUB, MUL)                                 \
+          ST(&yr[q + s * R * p], br[0]);                                \
+          ST(&yi[q + s * R * p], bi[0]);                                \
+          for (j = 1; j < R; j++) {                                     \
+            ST(&yr[q + s * (R * p + j)],                                \
+               SUB(MUL(br[j], wr[j]), MUL(bi[j], wi[j])));              \
+            ST(&yi[q + s * (R * p + j)],                                \
+               ADD(MUL(br[j], wi[j]), MUL(bi[j], wr[j])));              \
+          }                                                             \
+        }                                                               \
+      }                                                                 \
+  }
+
+/* the butterflies, with -i x = (x.im, -x.re) */
+
+#define BFLY2(VT, SET1, ADD, SUB, MUL)                                  \
+  br[0] = ADD(ar[0], ar[1]);  bi[0] = ADD(ai[0], ai[1]);                \
+  br[1] = SUB(ar[0], ar[1]);  bi[1] = SUB(ai[0], ai[1]);
+
+#define BFLY4(VT, SET1, ADD, SUB, MUL)                                  \
+  {                                                                     \
+    VT t0r = ADD(ar[0], ar[2]), t0i = ADD(ai[0], ai[2]);                \
+    VT t1r = SUB(ar[0], ar[2]), t1i = SUB(ai[0], ai[2]);                \
+    VT t2r = ADD(ar[1], ar[3]), t2i = ADD(ai[1], ai[3]);                \
+    VT t3r = SUB(ar[1], ar[3]), t3i = SUB(ai[1], ai[3]);                \
+    br[0] = ADD(t0r, t2r);  bi[0] = ADD(t0i, t2i);                      \
+    br[2] = SUB(t0r, t2r);  bi[2] = SUB(t0i, t2i);                      \
+    br[1] = ADD(t1r, t3i);  bi[1] = SUB(t1i, t3r);                      \
+    br[3] = SUB(t1r, t3i);  bi[3] = ADD(t1i, t3r);                      \
+  }
+
+#define FFT_C3  FL(-0.5)
+#define FFT_S3  FL(0.86602540378443864676)
+
+#define BFLY3(VT, SET1, ADD, SUB, MUL)                                  \
+  {                                                                     \
+    VT t1r = ADD(ar[1], ar[2]), t1i = ADD(ai[1], ai[2]);                \
+    VT t2r = ADD(ar[0], MUL(SET1(FFT_C3), t1r));                        \
+    VT t2i = ADD(ai[0], MUL(SET1(FFT_C3), t1i));                        \
+    VT t3r = MUL(SET1(FFT_S3), SUB(ar[1], ar[2]));                      \
+    VT t3i = MUL(SET1(FFT_S3), SUB(ai[1], ai[2]));                      \
+    br[0] = ADD(ar[0], t1r);  bi[0] = ADD(ai[0], t1i);                  \
+    br[1] = ADD(t2r, t3i);    bi[1] = SUB(t2i, t3r);                    \
+    br[2] = SUB(t2r, t3i);    bi[2] = ADD(t2i, t3r);                    \
+  }
+
+#define FFT_C51 FL(0.30901699437494742410)
+#define FFT_C52 FL(-0.80901699437494742410)
+#define FFT_S51 FL(0.95105651629515357212)
+#define FFT_S52 FL(0.58778525229247312917)
+
+#define BFLY5(VT, SET1, ADD, SUB, MUL)                                  \
+  {                                                                     \
+    VT t1r = ADD(ar[1], ar[4]), t1i = ADD(ai[1], ai[4]);                \
+    VT t2r = ADD(ar[2], ar[3]), t2i = ADD(ai[2], ai[3]);                \
+    VT t3r = SUB(ar[1], ar[4]), t3i = SUB(ai[1], ai[4]);                \
+    VT t4r = SUB(ar[2], ar[3]), t4i = SUB(ai[2], ai[3]);                \
+    VT m1r = ADD(ar[0], ADD(MUL(SET1(FFT_C51), t1r),                    \
+                            MUL(SET1(FFT_C52), t2r)));                  \
+    VT m1i = ADD(ai[0], ADD(MUL(SET1(FFT_C51), t1i),                    \
+                            MUL(SET1(FFT_C52), t2i)));                  \
+    VT m2r = ADD(ar[0], ADD(MUL(SET1(FFT_C52), t1r),                    \
+                            MUL(SET1(FFT_C51), t2r)));                  \
+    VT m2i = ADD(ai[0], ADD(MUL(SET1(FFT_C52), t1i),                    \
+                            MUL(SET1(FFT_C51), t2i)));                  \
+    VT n1r = ADD(MUL(SET1(FFT_S51), t3r), MUL(SET1(FFT_S52), t4r));     \
+    VT n1i = ADD(MUL(SET1(FFT_S51), t3i), MUL(SET1(FFT_S52), t4i));     \
+    VT n2r = SUB(MUL(SET1(FFT_S52), t3r), MUL(SET1(FFT_S51), t4r));     \
+    VT n2i = SUB(MUL(SET1(FFT_S52), t3i), MUL(SET1(FFT_S51), t4i));     \
+    br[0] = ADD(ar[0], ADD(t1r, t2r));  bi[0] = ADD(ai[0], ADD(t1i, t2i)); \
+    br[1] = ADD(m1r, n1i);  bi[1] = SUB(m1i, n1r);                      \
+    br[4] = SUB(m1r, n1i);  bi[4] = ADD(m1i, n1r);                      \
+    br[2] = ADD(m2r, n2i);  bi[2] = SUB(m2i, n2r);                      \
+    br[3] = SUB(m2r, n2i);  bi[3] = ADD(m2i, n2r);                      \
+  }
+
+#define FFT_KERNEL_SET(P, NAME, ATTR, VT, W, LD, ST, SET1, ADD, SUB, MUL) \
+  FFT_STAGE(P##_radix2, ATTR, VT, W, LD, ST, SET1, ADD, SUB, MUL, 2, BFLY2) \
+  FFT_STAGE(P##_radix3, ATTR, VT, W, LD, ST, SET1, ADD, SUB, MUL, 3, BFLY3) \
+  FFT_STAGE(P##_radix4, ATTR, VT, W, LD, ST, SET1, ADD, SUB, MUL, 4, BFLY4) \
+  FFT_STAGE(P##_radix5, ATTR, VT, W, LD, ST, SET1, ADD, SUB, MUL, 5, BFLY5) \
+  static const FFT_KERNELS P##_fft_kernels = {                          \
+    NAME, W,                                                            \
+    { NULL, NULL, P##_radix2, P##_radix3, P##_radix4, P##_radix5 }      \
+  };
+
+/* scalar, also for the stages whose stride is below the vector width */
+
+#define SCALAR_LD(p)        (*(p))
+#define SCALAR_ST(p, x)     (*(p) = (x))
+#define SCALAR_SET1(x)      (x)
+#define SCALAR_ADD(x, y)    ((x) + (y))
+#define SCALAR_SUB(x, y)    ((x) - (y))
+#define SCALAR_MUL(x, y)    ((x) * (y))
+#define NO_ATTR
+
+FFT_KERNEL_SET(scalar, "scalar", NO_ATTR, MYFLT, 1, SCALAR_LD, SCALAR_ST,
+               SCALAR_SET1, SCALAR_ADD, SCALAR_SUB, SCALAR_MUL)
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define FFTPLAN_X86
+#include <immintrin.h>
+
+#define ATTR_AVX2   __attribute__((target("avx2")))
+
+#ifdef USE_DOUBLE
+FFT_KERNEL_SET(sse2, "sse2", NO_ATTR, __m128d, 2, _mm_loadu_pd,
+               _mm_storeu_pd, _mm_set1_pd, _mm_add_pd, _mm_sub_pd,
+               _mm_mul_pd)
+FFT_KERNEL_SET(avx2, "avx2", ATTR_AVX2, __m256d, 4, _mm256_loadu_pd,
+               _mm256_storeu_pd, _mm256_set1_pd, _mm256_add_pd,
+               _mm256_sub_pd, _mm256_mul_pd)
+#else
+FFT_KERNEL_SET(sse2, "sse2", NO_ATTR, __m128, 4, _mm_loadu_ps,
+               _mm_storeu_ps, _mm_set1_ps, _mm_add_ps, _mm_sub_ps,
+               _mm_mul_ps)
+FFT_KERNEL_SET(avx2, "avx2", ATTR_AVX2, __m256, 8, _mm256_loadu_ps,
+               _mm256_storeu_ps, _mm256_set1_ps, _mm256_add_ps,
+               _mm256_sub_ps, _mm256_mul_ps)
+#endif
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define FFTPLAN_NEON
+#include <arm_neon.h>
+
+#ifdef USE_DOUBLE
+FFT_KERNEL_SET(neon, "neon", NO_ATTR, float64x2_t, 2, vld1q_f64, vst1q_f64,
+               vdupq_n_f64, vaddq_f64, vsubq_f64, vmulq_f64)
+#else
+FFT_KERNEL_SET(neon, "neon", NO_ATTR, float32x4_t, 4, vld1q_f32, vst1q_f32,
+               vdupq_n_f32, vaddq_f32, vsubq_f32, vmulq_f32)
+#endif
+#endif
+
+/* supported kernel sets, widest first */
+static const FFT_KERNELS *fft_kernel_sets[4];
+static int fft_nkernel_sets = 0;
+
+static void fftplan_kernels_init(void)
+{
+    int n = 0;
+
+    if (fft_nkernel_sets) return;
+#if defined(FFTPLAN_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      fft_kernel_sets[n++] = &avx2_fft_kernels;
+    fft_kernel_sets[n++] = &sse2_fft_kernels;
+#elif defined(FFTPLAN_NEON)
+    fft_kernel_sets[n++] = &neon_fft_kernels;
+#endif
+    fft_kernel_sets[n++] = &scalar_fft_kernels;
+    fft_nkernel_sets = n;
+}
+
+#ifdef HAVE_FFTW3
+#ifdef USE_DOUBLE
+#define FFTW(x)     fftw_##x
+#define FFTW_CPLX   fftw_complex
+#else
+#define FFTW(x)     fftwf_##x
+#define FFTW_CPLX   fftwf_complex
+#endif
+
+static int fftplan_reset(CSOUND *csound, void *userData)
+{
+    CSOUND_FFT_SETUP *p = (CSOUND_FFT_SETUP*) csound->FFT_plans;
+
+    IGN(userData);
+    pthread_mutex_lock(&fftplan_lock);
+    for ( ; p != NULL; p = p->nxt)
+      if (p->fftw != NULL)
+        FFTW(destroy_plan)(p->fftw);
+    pthread_mutex_unlock(&fftplan_lock);
+    return 0;
+}
+
+/* plan on a scratch buffer, with the layouts of csoundRealFFT() and the
+   FFTW half-complex array interleaved in the same N + 2 values; called
+   with fftplan_lock held */
+static void fftplan_fftw(CSOUND *csound, CSOUND_FFT_SETUP *p, MYFLT *buf)
+{
+    if (csound->FFT_plans == NULL)
+      csound->RegisterResetCallback(csound, NULL, fftplan_reset);
+    if (p->direction == FFT_FWD)
+      p->fftw = FFTW(plan_dft_r2c_1d)(p->N, buf, (FFTW_CPLX*) buf,
+                                      FFTW_ESTIMATE | FFTW_UNALIGNED);
+    else
+      p->fftw = FFTW(plan_dft_c2r_1d)(p->N, (FFTW_CPLX*) buf, buf,
+                                      FFTW_ESTIMATE | FFTW_UNALIGNED);
+}
+
+static void fftplan_fftw_execute(CSOUND_FFT_SETUP *p, MYFLT *buf,
+                                 MYFLT *tmp)
+{
+    int     i, N = p->N;
+
+    if (p->direction == FFT_FWD) {
+      memcpy(tmp, buf, N * sizeof(MYFLT));
+      FFTW(execute_dft_r2c)(p->fftw, tmp, (FFTW_CPLX*) tmp);
+      memcpy(buf, tmp, N * sizeof(MYFLT));
+      buf[1] = tmp[N];
+    }
+    else {
+      MYFLT scl = FL(1.0) / N;
+      memcpy(tmp, buf, N * sizeof(MYFLT));
+      tmp[N] = buf[1];
+      tmp[1] = tmp[N + 1] = FL(0.0);
+      FFTW(execute_dft_c2r)(p->fftw, (FFTW_CPLX*) tmp, tmp);
+      for (i = 0; i < N; i++)
+        buf[i] = tmp[i] * scl;
+    }
+}
+#endif  /* HAVE_FFTW3 */
+
+/* split n into radix 4, 2, 3 and 5 stages; 0 if it has other factors */
+static int fftplan_factor(int n, int *radix)
+{
+    int     ns = 0;
+
+    while (n % 4 == 0) { radix[ns++] = 4; n /= 4; }
+    if (n % 2 == 0) { radix[ns++] = 2; n /= 2; }
+    while (n % 3 == 0) { radix[ns++] = 3; n /= 3; }
+    while (n % 5 == 0) { radix[ns++] = 5; n /= 5; }
+    return n == 1 ? ns : -1;
+}
+
+static FFT_SCRATCH *fftplan_scratch_new(CSOUND *csound, CSOUND_FFT_SETUP *p)
+{
+    FFT_SCRATCH *s = (FFT_SCRATCH*) csound->Calloc(csound, sizeof(FFT_SCRATCH));
+
+    /* the FFTW backend needs N + 2 */
+    s->buf = (MYFLT*) csound->Calloc(csound,
+                                     (4 * (size_t) p->M + 2) * sizeof(MYFLT));
+    return s;
+}
+
+/* called with fftplan_lock held */
+static CSOUND_FFT_SETUP *fftplan_new(CSOUND *csound, int N, int direction)
+{
+    CSOUND_FFT_SETUP *p;
+    int     radix[FFTPLAN_MAXSTAGES];
+    int     M = N >> 1, ns, i, j, k, n, s;
+    size_t  ntw = 0;
+    MYFLT   *tw;
+
+    if (N < 2 || (N & 1) || (ns = fftplan_factor(M, radix)) < 0)
+      return NULL;
+    /* twiddles of stage i: (r - 1) * n / r, with n the stage length */
+    for (i = 0, n = M; i < ns; n /= radix[i], i++)
+      ntw += (size_t) (radix[i] - 1) * (n / radix[i]);
+    p = (CSOUND_FFT_SETUP*) csound->Calloc(csound, sizeof(CSOUND_FFT_SETUP));
+    p->N = N;
+    p->M = M;
+    p->direction = direction;
+    p->nstages = ns;
+    p->scratch = fftplan_scratch_new(csound, p);
+    tw = (MYFLT*) csound->Malloc(csound,
+                                 (2 * ntw + 2 * (size_t) M) * sizeof(MYFLT));
+    p->rtr = tw;
+    p->rti = tw + M;
+    tw += 2 * M;
+    for (k = 0; k < M; k++) {
+      p->rtr[k] = (MYFLT) cos(TWOPI * k / N);
+      p->rti[k] = (MYFLT) -sin(TWOPI * k / N);
+    }
+    fftplan_kernels_init();
+    for (i = 0, n = M, s = 1; i < ns; i++) {
+      int r = radix[i], m = n / r;
+      p->radix[i] = r;
+      p->twr[i] = tw;
+      p->twi[i] = tw + (r - 1) * m;
+      tw += 2 * (r - 1) * m;
+      for (j = 1; j < r; j++)
+        for (k = 0; k < m; k++) {
+          double a = TWOPI * (double) j * k / n;
+          p->twr[i][(j - 1) * m + k] = (MYFLT) cos(a);
+          p->twi[i][(j - 1) * m + k] = (MYFLT) -sin(a);
+        }
+      for (j = 0; fft_kernel_sets[j]->width > 1 &&
+                  s % fft_kernel_sets[j]->width != 0; j++)
+        ;
+      p->fn[i] = fft_kernel_sets[j]->stage[r];
+      n = m;
+      s *= r;
+    }
+#ifdef HAVE_FFTW3
+    fftplan_fftw(csound, p, p->scratch->buf);
+#endif
+    return p;
+}
+
+/* complex FFT of M points from (ar, ai); returns the array pair, at
+   a or at b, that holds the result */
+
+static MYFLT *fftplan_complex(CSOUND_FFT_SETUP *p, MYFLT *a, MYFLT *b)
+{
+    int     i, n = p->M, s = 1;
+
+    for (i = 0; i < p->nstages; i++) {
+      MYFLT *t;
+      int   m = n / p->radix[i];
+      p->fn[i](a, a + p->M, b, b + p->M, m, s, p->twr[i], p->twi[i]);
+      t = a; a = b; b = t;
+      n = m;
+      s *= p->radix[i];
+    }
+    return a;
+}
+
+static void fftplan_forward(CSOUND_FFT_SETUP *p, MYFLT *buf, MYFLT *tmp)
+{
+    int     k, M = p->M;
+    MYFLT   *zr, *zi;
+
+    for (k = 0; k < M; k++) {
+      tmp[k] = buf[2 * k];
+      tmp[M + k] = buf[2 * k + 1];
+    }
+    zr = fftplan_complex(p, tmp, tmp + 2 * M);
+    zi = zr + M;
+    buf[0] = zr[0] + zi[0];
+    buf[1] = zr[0] - zi[0];
+    for (k = 1; k < M; k++) {
+      MYFLT fer = FL(0.5) * (zr[k] + zr[M - k]);
+      MYFLT fei = FL(0.5) * (zi[k] - zi[M - k]);
+      MYFLT for_ = FL(0.5) * (zi[k] + zi[M - k]);
+      MYFLT foi = FL(0.5) * (zr[M - k] - zr[k]);
+      buf[2 * k] = fer + p->rtr[k] * for_ - p->rti[k] * foi;
+      buf[2 * k + 1] = fei + p->rtr[k] * foi + p->rti[k] * for_;
+    }
+}
+
+static void fftplan_inverse(CSOUND_FFT_SETUP *p, MYFLT *buf, MYFLT *tmp)
+{
+    int     k, M = p->M;
+    MYFLT   *zr, *zi, scl = FL(1.0) / p->N;
+
+    /* conj(Fe + i Fo), Fe = X[k] + conj(X[M-k]),
+       Fo = (X[k] - conj(X[M-k])) e^(2 pi i k / N) */
+    tmp[0] = buf[0] + buf[1];
+    tmp[M] = buf[1] - buf[0];
+    for (k = 1; k < M; k++) {
+      MYFLT xr = buf[2 * k], xi = buf[2 * k + 1];
+      MYFLT yr = buf[2 * (M - k)], yi = buf[2 * (M - k) + 1];
+      MYFLT dr = xr - yr, di = xi + yi;
+      MYFLT for_ = dr * p->rtr[k] + di * p->rti[k];
+      MYFLT foi = di * p->rtr[k] - dr * p->rti[k];
+      tmp[k] = xr + yr - foi;
+      tmp[M + k] = -(xi - yi + for_);
+    }
+    zr = fftplan_complex(p, tmp, tmp + 2 * M);
+    zi = zr + M;
+    for (k = 0; k < M; k++) {
+      buf[2 * k] = zr[k] * scl;
+      buf[2 * k + 1] = -zi[k] * scl;
+    }
+}
+
+static CSOUND_FFT_SETUP *fftplan_find(CSOUND *csound, int N, int direction)
+{
+    CSOUND_FFT_SETUP *p = (CSOUND_FFT_SETUP*) PLAN_LOAD(csound->FFT_plans);
+
+    for ( ; p != NULL; p = p->nxt)
+      if (p->N == N && p->direction == direction)
+        return p;
+    return NULL;
+}
+
+CSOUND_FFT_SETUP *csoundRealFFTSetup(CSOUND *csound,
+                                     int FFTsize, int direction)
+{
+    CSOUND_FFT_SETUP *p;
+
+    direction = (direction == FFT_INV ? FFT_INV : FFT_FWD);
+    if ((p = fftplan_find(csound, FFTsize, direction)) != NULL)
+      return p;
+    pthread_mutex_lock(&fftplan_lock);
+    /* another thread may have made it meanwhile */
+    if ((p = fftplan_find(csound, FFTsize, direction)) == NULL &&
+        (p = fftplan_new(csound, FFTsize, direction)) != NULL) {
+      p->nxt = (CSOUND_FFT_SETUP*) csound->FFT_plans;
+      PLAN_PUBLISH(csound->FFT_plans, (void*) p);
+    }
+    pthread_mutex_unlock(&fftplan_lock);
+    return p;
+}
+
+/* a free scratch buffer of the plan, or a new one if all are in use */
+static FFT_SCRATCH *fftplan_claim(CSOUND *csound, CSOUND_FFT_SETUP *p)
+{
+    FFT_SCRATCH *s;
+
+#ifdef PLAN_LOCKED_CLAIM
+    pthread_mutex_lock(&fftplan_lock);
+#endif
+    for (s = PLAN_LOAD(p->scratch); s != NULL; s = s->nxt)
+      if (PLAN_TRYLOCK(s))
+        break;
+#ifndef PLAN_LOCKED_CLAIM
+    if (s != NULL)
+      return s;
+    pthread_mutex_lock(&fftplan_lock);
+#endif
+    if (s == NULL) {
+      s = fftplan_scratch_new(csound, p);
+      s->busy = 1;
+      s->nxt = p->scratch;
+      PLAN_PUBLISH(p->scratch, s);
+    }
+    pthread_mutex_unlock(&fftplan_lock);
+    return s;
+}
+
+static void fftplan_release(FFT_SCRATCH *s)
+{
+#ifdef PLAN_LOCKED_CLAIM
+    pthread_mutex_lock(&fftplan_lock);
+    PLAN_UNLOCK(s);
+    pthread_mutex_unlock(&fftplan_lock);
+#else
+    PLAN_UNLOCK(s);
+#endif
+}
+
+void csoundRealFFTExecute(CSOUND *csound, CSOUND_FFT_SETUP *p, MYFLT *buf)
+{
+    FFT_SCRATCH *s = fftplan_claim(csound, p);
+    MYFLT   *tmp = s->buf;
+
+#ifdef HAVE_FFTW3
+    if (p->fftw != NULL)
+      fftplan_fftw_execute(p, buf, tmp);
+    else
+#endif
+    if (p->direction == FFT_FWD)
+      fftplan_forward(p, buf, tmp);
+    else
+      fftplan_inverse(p, buf, tmp);
+    fftplan_release(s);
+}
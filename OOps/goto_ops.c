@@ -117,18 +117,27 @@ int rireturn(CSOUND *csound, LINK *p)
     return OK;
 }
 
+extern void init_queue_push(CSOUND *, INSDS *);
+
 int reinit(CSOUND *csound, GOTO *p)
 {
+    if(csound->realtime_audio_flag == 0) {
     csound->reinitflag = p->h.insdshead->reinitflag = 1;
     csound->curip = p->h.insdshead;
     csound->ids = p->lblblk->prvi;        /* now, despite ANSI C warning:  */
-    if(csound->realtime_audio_flag == 0) {
     while ((csound->ids = csound->ids->nxti) != NULL &&
            csound->ids->iopadr != (SUBR) rireturn)
       (*csound->ids->iopadr)(csound, csound->ids);
      csound->reinitflag = p->h.insdshead->reinitflag = 0;
      } else {
-    csound->curip->init_done = 0;
+    /* the init-pass thread owns curip and ids: hand the instance over */
+    p->h.insdshead->reinitflag = 1;
+#ifdef HAVE_ATOMIC_BUILTIN
+    __sync_lock_test_and_set((int*)&p->h.insdshead->init_done, 0);
+#else
+    p->h.insdshead->init_done = 0;
+#endif
+    init_queue_push(csound, p->h.insdshead);
     }
     return OK;
 }
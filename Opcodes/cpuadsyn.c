@@ -0,0 +1,418 @@
+/*
+    cpuadsyn.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+/* cpuadsynth: the cudasynth/cladsynth oscillator bank on the CPU.
+
+   asig cpuadsynth fsig, kamp, kfreq [, inum, ithreads]
+
+   Each pvs bin drives one partial, interpolating its amplitude over the
+   hop and using the bin frequency scaled by kfreq.  The bank is split
+   into ithreads slices (default: the -j setting) and the slices of one
+   hop are rendered in parallel by a pool of worker threads, so the hop
+   is complete within the k-cycle that needs it. */
+
+#include "csoundCore.h"
+#include "pstream.h"
+#include "cpuadsyn.h"
+#include <math.h>
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
+
+#define FRACBITS  (30 - CPUADSYN_TABBITS)
+#define FRACMASK  ((1 << FRACBITS) - 1)
+#define FRACSCAL  (1.0f / (float) (1 << FRACBITS))
+
+/* fewest partials worth giving a thread of their own */
+#define MIN_SLICE 128
+
+void cpuadsyn_table(float *tab)
+{
+    int i;
+    for (i = 0; i <= CPUADSYN_TABLEN; i++)
+      tab[i] = (float) sin(TWOPI * i / CPUADSYN_TABLEN);
+}
+
+void cpuadsyn_load(CPUADSYN_BANK *b, const float *frame, int bins,
+                   float fscal, int first, int last)
+{
+    int h;
+    for (h = first; h < last; h++) {
+      if (h < bins) {
+        /* same rounding as the GPU kernels */
+        b->incr[h] = (uint32_t) (int64_t) roundf(frame[2*h+1] * fscal);
+        b->amp1[h] = frame[2*h];
+      }
+      else {
+        b->incr[h] = 0;
+        b->amp1[h] = 0.0f;
+      }
+    }
+}
+
+void cpuadsyn_advance(CPUADSYN_BANK *b, int first, int last, int vsamps)
+{
+    int h;
+    for (h = first; h < last; h++) {
+      b->ph[h] = (b->ph[h] + (uint32_t) vsamps * b->incr[h]) & CPUADSYN_PHMASK;
+      b->amp[h] = b->amp1[h];
+    }
+}
+
+static void render_scalar(float *out, float *acc, const CPUADSYN_BANK *b,
+                          const float *tab, int first, int last, int vsamps)
+{
+    float rv = 1.0f / vsamps;
+    int   h, n;
+
+    (void) acc;
+    memset(out, 0, vsamps * sizeof(float));
+    for (h = first; h < last; h++) {
+      uint32_t ph = b->ph[h], d = b->incr[h];
+      float    a0 = b->amp[h], da = (b->amp1[h] - a0) * rv;
+      if (a0 == 0.0f && b->amp1[h] == 0.0f) continue;
+      for (n = 0; n < vsamps; n++, ph += d) {
+        uint32_t    m = ph & CPUADSYN_PHMASK;
+        const float *t = tab + (m >> FRACBITS);
+        float       fr = (float) (m & FRACMASK) * FRACSCAL;
+        out[n] += (a0 + n * da) * (t[0] + fr * (t[1] - t[0]));
+      }
+    }
+}
+
+static const CPUADSYN_KERNEL scalar_kernel = { "scalar", render_scalar };
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CPUADSYN_X86
+#include <immintrin.h>
+
+/* eight partials per vector: the phases advance with integer adds and
+   both table points are fetched with gathers.  Each sample's vector is
+   accumulated in acc and reduced once at the end of the hop. */
+__attribute__((target("avx2")))
+static void render_avx2(float *out, float *acc, const CPUADSYN_BANK *b,
+                        const float *tab, int first, int last, int vsamps)
+{
+    const __m256i phmask = _mm256_set1_epi32(CPUADSYN_PHMASK);
+    const __m256i frmask = _mm256_set1_epi32(FRACMASK);
+    const __m256  frscal = _mm256_set1_ps(FRACSCAL);
+    const __m256  rv = _mm256_set1_ps(1.0f / vsamps);
+    int h, n, j;
+
+    memset(acc, 0, vsamps * CPUADSYN_LANES * sizeof(float));
+    for (h = first; h < last; h += CPUADSYN_LANES) {
+      __m256i ph = _mm256_loadu_si256((const __m256i *) &b->ph[h]);
+      __m256i d = _mm256_loadu_si256((const __m256i *) &b->incr[h]);
+      __m256  a0 = _mm256_loadu_ps(&b->amp[h]);
+      __m256  a1 = _mm256_loadu_ps(&b->amp1[h]);
+      __m256  da = _mm256_mul_ps(_mm256_sub_ps(a1, a0), rv);
+      __m256  nf = _mm256_setzero_ps();
+      if (_mm256_testz_si256(_mm256_castps_si256(a0), _mm256_castps_si256(a0))
+          && _mm256_testz_si256(_mm256_castps_si256(a1),
+                                _mm256_castps_si256(a1)))
+        continue;
+      for (n = 0; n < vsamps; n++) {
+        __m256i m = _mm256_and_si256(ph, phmask);
+        __m256i i = _mm256_srli_epi32(m, FRACBITS);
+        __m256  fr = _mm256_mul_ps(_mm256_cvtepi32_ps(
+                                     _mm256_and_si256(m, frmask)), frscal);
+        __m256  t0 = _mm256_i32gather_ps(tab, i, 4);
+        __m256  t1 = _mm256_i32gather_ps(tab + 1, i, 4);
+        __m256  s = _mm256_add_ps(t0, _mm256_mul_ps(fr, _mm256_sub_ps(t1, t0)));
+        __m256  a = _mm256_add_ps(a0, _mm256_mul_ps(nf, da));
+        float   *ac = acc + n * CPUADSYN_LANES;
+        _mm256_storeu_ps(ac, _mm256_add_ps(_mm256_loadu_ps(ac),
+                                           _mm256_mul_ps(a, s)));
+        ph = _mm256_add_epi32(ph, d);
+        nf = _mm256_add_ps(nf, _mm256_set1_ps(1.0f));
+      }
+    }
+    for (n = 0; n < vsamps; n++) {
+      float sum = 0.0f, *ac = acc + n * CPUADSYN_LANES;
+      for (j = 0; j < CPUADSYN_LANES; j++)
+        sum += ac[j];
+      out[n] = sum;
+    }
+}
+
+static const CPUADSYN_KERNEL avx2_kernel = { "avx2", render_avx2 };
+#endif
+
+const CPUADSYN_KERNEL *cpuadsyn_kernel(int i)
+{
+    if (i == 0) return &scalar_kernel;
+#if defined(CPUADSYN_X86)
+    __builtin_cpu_init();
+    if (i == 1 && __builtin_cpu_supports("avx2"))
+      return &avx2_kernel;
+#endif
+    return NULL;
+}
+
+typedef struct cpuadsyn_ CPUADSYN;
+
+typedef struct {
+    CSOUND      *csound;
+    CPUADSYN    *p;
+    int         index;
+} ADSYN_WORKER;
+
+struct cpuadsyn_ {
+    OPDS        h;
+    MYFLT       *asig;
+    PVSDAT      *fsig;
+    MYFLT       *kamp, *kfreq;
+    MYFLT       *inum, *ithreads;
+    CPUADSYN_BANK bank;
+    const CPUADSYN_KERNEL *kernel;
+    AUXCH       mem;            /* bank arrays and sine table */
+    AUXCH       out_;           /* one hop per slice, then scratch */
+    float       *tab, *outs, *acc;
+    const float *frame;
+    float       fscal;
+    int         bins, nparts, vsamps, count;
+    int         nslices;
+    ADSYN_WORKER *workers;
+    void        **threads;
+#ifndef __EMSCRIPTEN__
+    /* each hop bumps hop and sets pending to the number of workers;
+       the last worker to finish its slice signals done */
+    pthread_mutex_t lock;
+    pthread_cond_t  start, done;
+    unsigned int hop;
+    int         pending;
+    int         quit;
+#endif
+};
+
+/* render slice w of the bank for the current frame */
+static void adsyn_slice(CPUADSYN *p, int w)
+{
+    int groups = p->nparts / CPUADSYN_LANES;
+    int first = (groups * w / p->nslices) * CPUADSYN_LANES;
+    int last = (groups * (w + 1) / p->nslices) * CPUADSYN_LANES;
+
+    cpuadsyn_load(&p->bank, p->frame, p->bins, p->fscal, first, last);
+    p->kernel->render(p->outs + w * p->vsamps,
+                      p->acc + w * p->vsamps * CPUADSYN_LANES,
+                      &p->bank, p->tab, first, last, p->vsamps);
+    cpuadsyn_advance(&p->bank, first, last, p->vsamps);
+}
+
+#ifndef __EMSCRIPTEN__
+static uintptr_t adsyn_worker(void *arg)
+{
+    ADSYN_WORKER *w = (ADSYN_WORKER *) arg;
+    CPUADSYN *p = w->p;
+    unsigned int hop = 0;
+
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+      while (p->hop == hop && !p->quit)
+        pthread_cond_wait(&p->start, &p->lock);
+      if (p->quit) break;
+      hop = p->hop;
+      pthread_mutex_unlock(&p->lock);
+      adsyn_slice(p, w->index);
+      pthread_mutex_lock(&p->lock);
+      if (--p->pending == 0)
+        pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+/* render all slices of a hop, slice 0 on the calling thread */
+static void render_hop(CPUADSYN *p)
+{
+    pthread_mutex_lock(&p->lock);
+    p->hop++;
+    p->pending = p->nslices - 1;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+    adsyn_slice(p, 0);
+    pthread_mutex_lock(&p->lock);
+    while (p->pending > 0)
+      pthread_cond_wait(&p->done, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+}
+#endif
+
+static int destroy_cpuadsyn(CSOUND *csound, void *pp)
+{
+    CPUADSYN *p = (CPUADSYN *) pp;
+    int i;
+
+#ifndef __EMSCRIPTEN__
+    if (p->threads != NULL) {
+      pthread_mutex_lock(&p->lock);
+      p->quit = 1;
+      pthread_cond_broadcast(&p->start);
+      pthread_mutex_unlock(&p->lock);
+      for (i = 1; i < p->nslices; i++)
+        csound->JoinThread(p->threads[i]);
+      pthread_cond_destroy(&p->start);
+      pthread_cond_destroy(&p->done);
+      pthread_mutex_destroy(&p->lock);
+      csound->Free(csound, p->threads);
+      csound->Free(csound, p->workers);
+      p->threads = NULL;
+      p->workers = NULL;
+    }
+#else
+    IGN(csound); IGN(i);
+#endif
+    p->nslices = 1;
+    return OK;
+}
+
+static int start_workers(CSOUND *csound, CPUADSYN *p)
+{
+#ifndef __EMSCRIPTEN__
+    int i;
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+    p->hop = 0;
+    p->pending = 0;
+    p->quit = 0;
+    p->threads = (void **) csound->Calloc(csound, p->nslices * sizeof(void *));
+    p->workers = (ADSYN_WORKER *)
+      csound->Calloc(csound, p->nslices * sizeof(ADSYN_WORKER));
+    /* slice 0 is rendered by the performance thread */
+    for (i = 1; i < p->nslices; i++) {
+      p->workers[i].csound = csound;
+      p->workers[i].p = p;
+      p->workers[i].index = i;
+      p->threads[i] = csound->CreateThread(adsyn_worker, &p->workers[i]);
+    }
+    return csound->RegisterDeinitCallback(csound, p, destroy_cpuadsyn);
+#else
+    IGN(csound);
+    p->nslices = 1;
+    return OK;
+#endif
+}
+
+static int init_cpuadsyn(CSOUND *csound, CPUADSYN *p)
+{
+    int     i, nthreads;
+    size_t  nbytes;
+    char    *mem;
+
+    if (UNLIKELY(p->fsig->format != PVS_AMP_FREQ))
+      return csound->InitError(csound,
+                               Str("cpuadsynth: signal format "
+                                   "must be amp-freq.\n"));
+    if (UNLIKELY(p->fsig->overlap <= 0))
+      return csound->InitError(csound, Str("cpuadsynth: invalid overlap\n"));
+    destroy_cpuadsyn(csound, p);
+
+    p->bins = p->fsig->N / 2;
+    if (*p->inum > 0 && *p->inum < p->bins) p->bins = (int) *p->inum;
+    p->nparts = (p->bins + CPUADSYN_LANES - 1) & ~(CPUADSYN_LANES - 1);
+    p->vsamps = p->fsig->overlap;
+
+    nthreads = *p->ithreads > 0 ? (int) *p->ithreads
+                                : csound->oparms->numThreads;
+    if (nthreads > p->nparts / MIN_SLICE) nthreads = p->nparts / MIN_SLICE;
+    if (nthreads < 1) nthreads = 1;
+    p->nslices = nthreads;
+
+    for (i = 1; cpuadsyn_kernel(i) != NULL; i++) ;
+    p->kernel = cpuadsyn_kernel(i - 1);
+
+    nbytes = p->nparts * (2 * sizeof(uint32_t) + 2 * sizeof(float))
+      + (CPUADSYN_TABLEN + 1) * sizeof(float);
+    if (p->mem.auxp == NULL || p->mem.size < nbytes)
+      csound->AuxAlloc(csound, nbytes, &p->mem);
+    else
+      memset(p->mem.auxp, 0, nbytes);
+    mem = (char *) p->mem.auxp;
+    p->bank.ph = (uint32_t *) mem;
+    p->bank.incr = p->bank.ph + p->nparts;
+    p->bank.amp = (float *) (p->bank.incr + p->nparts);
+    p->bank.amp1 = p->bank.amp + p->nparts;
+    p->tab = p->bank.amp1 + p->nparts;
+    cpuadsyn_table(p->tab);
+
+    nbytes = p->nslices * p->vsamps * (1 + CPUADSYN_LANES) * sizeof(float);
+    if (p->out_.auxp == NULL || p->out_.size < nbytes)
+      csound->AuxAlloc(csound, nbytes, &p->out_);
+    p->outs = (float *) p->out_.auxp;
+    p->acc = p->outs + p->nslices * p->vsamps;
+
+    p->count = 0;
+    if (p->nslices > 1)
+      return start_workers(csound, p);
+    return OK;
+}
+
+static int perf_cpuadsyn(CSOUND *csound, CPUADSYN *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t n, nsmps = CS_KSMPS;
+    MYFLT   *asig = p->asig, amp = *p->kamp;
+    float   *out_ = p->outs;
+    int     count = p->count, vsamps = p->vsamps;
+    int     i, j;
+
+    if (UNLIKELY(offset)) memset(asig, '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&asig[nsmps], '\0', early*sizeof(MYFLT));
+    }
+
+    for (n = offset; n < nsmps; n++) {
+      if (count == 0) {
+        p->frame = (const float *) p->fsig->frame.auxp;
+        p->fscal = (float) *p->kfreq * CPUADSYN_FMAXLEN / (float) CS_ESR;
+#ifndef __EMSCRIPTEN__
+        if (p->threads != NULL) {
+          render_hop(p);
+          for (i = 1; i < p->nslices; i++) {
+            const float *o = p->outs + i * vsamps;
+            for (j = 0; j < vsamps; j++)
+              out_[j] += o[j];
+          }
+        }
+        else
+#endif
+          adsyn_slice(p, 0);
+        count = vsamps;
+      }
+      asig[n] = amp * (MYFLT) out_[vsamps - count];
+      count--;
+    }
+    p->count = count;
+    return OK;
+}
+
+static OENTRY cpuadsyn_localops[] = {
+  { "cpuadsynth", sizeof(CPUADSYN), 0, 5, "a", "fkkoo",
+    (SUBR) init_cpuadsyn, NULL, (SUBR) perf_cpuadsyn }
+};
+
+LINKAGE_BUILTIN(cpuadsyn_localops)
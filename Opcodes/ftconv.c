@@ -23,6 +23,9 @@
 
 #include "stdopcod.h"
 #include <math.h>
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
 
 #define FTCONV_MAXCHN   8
 
@@ -300,14 +303,460 @@ static int ftconv_perf(CSOUND *csound, FTCONV *p)
                              Str("ftconv: not initialised"));
 }
 
+/* ------------------------------------------------------------------------ */
+
+/* nuconv: non-uniform partitioned convolution.  The impulse response is
+   cut into levels of increasing block size N, as described by Gardner:
+   the head (N = partition length, IR samples 0 to 8N) is computed on the
+   performance thread exactly like ftconv, and each further level has a
+   block size four times the previous one, starting at 2N and covering
+   six blocks (the last level takes whatever remains, with N at most
+   NUCONV_MAXPART).  A tail block is needed N + partition length samples
+   after its input is complete, so it is handed to a pool of worker
+   threads, which always compute the block with the earliest deadline.
+   The performance thread only waits at a deadline if that block is
+   still being computed, and computes it itself if no worker has taken
+   it.  The latency and output are the same as ftconv's with the same
+   partition length. */
+
+#define NUCONV_MAXLVL   8
+#define NUCONV_MAXPART  16384
+#define NUCONV_MAXTHR   8
+#define NUCONV_SLOTS    4   /* blocks being filled, computed and read */
+
+enum { NU_FREE, NU_QUEUED, NU_RUNNING, NU_DONE };
+
+typedef struct {
+    int     partSize;           /* block length N of this level             */
+    int     nPartitions;        /* number of blocks of IR                   */
+    int     irOffset;           /* first IR sample frame of this level      */
+    int     delay;              /* samples from end of input to output      */
+    int     sync;               /* computed on the performance thread       */
+    int     rbCnt;              /* ring buffer index                        */
+    int     inCnt;              /* input position, 0 to N - 1               */
+    int     outCnt;             /* output position, negative until the
+                                   first block is due                       */
+    int64_t inBlock, outBlock;  /* blocks being filled and read out         */
+    MYFLT   *ringBuf;           /* ring buffer of FFTs of input blocks      */
+    MYFLT   *tmpBuf;            /* temporary buffer for accumulating FFTs   */
+    MYFLT   *inBuf[NUCONV_SLOTS];               /* input blocks (size=N)    */
+    MYFLT   *IR_Data[FTCONV_MAXCHN];            /* impulse responses        */
+    MYFLT   *outBuf[NUCONV_SLOTS][FTCONV_MAXCHN]; /* results (size=N*2)    */
+    int     state[NUCONV_SLOTS];
+    int64_t deadline[NUCONV_SLOTS];
+    int64_t nextBlock;          /* next block to compute, in order          */
+} NUCONV_LEVEL;
+
+typedef struct {
+    OPDS    h;
+    MYFLT   *aOut[FTCONV_MAXCHN];
+    MYFLT   *aIn;
+    MYFLT   *iFTNum;
+    MYFLT   *iPartLen;
+    MYFLT   *iSkipSamples;
+    MYFLT   *iTotLen;
+    MYFLT   *iSkipInit;
+    MYFLT   *iThreads;
+ /* ------------------------- */
+    CSOUND  *csound;
+    int     initDone;
+    int     nChannels;
+    int     nLevels;
+    int     nThreads;
+    int     late;               /* deadlines missed by the workers          */
+    NUCONV_LEVEL lvl[NUCONV_MAXLVL];
+    AUXCH   auxData;
+#ifndef __EMSCRIPTEN__
+    int     quit;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    pthread_t       threads[NUCONV_MAXTHR];
+#endif
+} NUCONV;
+
+/* FFT the input of block k of a level, convolve it with the level's IR
+   partitions and leave the result in the block's output slot */
+static void nuconv_block(NUCONV *p, NUCONV_LEVEL *l, int64_t k)
+{
+    CSOUND  *csound = p->csound;
+    int     slot = (int) (k % NUCONV_SLOTS);
+    int     nSamples = l->partSize, n;
+    MYFLT   *rBuf = &(l->ringBuf[l->rbCnt * (nSamples << 1)]);
+
+    memcpy(rBuf, l->inBuf[slot], nSamples * sizeof(MYFLT));
+    memset(rBuf + nSamples, 0, nSamples * sizeof(MYFLT));
+    csound->RealFFT(csound, rBuf, (nSamples << 1));
+    if (++l->rbCnt >= l->nPartitions)
+      l->rbCnt = 0;
+    for (n = 0; n < p->nChannels; n++) {
+      multiply_fft_buffers(l->tmpBuf, l->ringBuf, l->IR_Data[n],
+                           nSamples, l->nPartitions,
+                           l->rbCnt * (nSamples << 1));
+      csound->InverseRealFFT(csound, l->tmpBuf, (nSamples << 1));
+      memcpy(l->outBuf[slot][n], l->tmpBuf, (nSamples << 1) * sizeof(MYFLT));
+    }
+}
+
+#ifndef __EMSCRIPTEN__
+/* the queued block with the earliest deadline that can start now;
+   blocks of a level are computed in order.  Called with lock held. */
+static NUCONV_LEVEL *nuconv_next(NUCONV *p, int64_t *blk)
+{
+    NUCONV_LEVEL *best = NULL;
+    int     i;
+
+    for (i = 0; i < p->nLevels; i++) {
+      NUCONV_LEVEL *l = &(p->lvl[i]);
+      int slot = (int) (l->nextBlock % NUCONV_SLOTS);
+      if (l->sync || l->state[slot] != NU_QUEUED)
+        continue;
+      if (best == NULL || l->deadline[slot] <
+          best->deadline[best->nextBlock % NUCONV_SLOTS])
+        best = l;
+    }
+    if (best != NULL) {
+      *blk = best->nextBlock;
+      best->state[*blk % NUCONV_SLOTS] = NU_RUNNING;
+    }
+    return best;
+}
+
+static void *nuconv_thread(void *pp)
+{
+    NUCONV  *p = (NUCONV *) pp;
+    NUCONV_LEVEL *l;
+    int64_t k;
+
+    pthread_mutex_lock(&p->lock);
+    while (!p->quit) {
+      if ((l = nuconv_next(p, &k)) == NULL) {
+        pthread_cond_wait(&p->cond, &p->lock);
+        continue;
+      }
+      pthread_mutex_unlock(&p->lock);
+      nuconv_block(p, l, k);
+      pthread_mutex_lock(&p->lock);
+      l->state[k % NUCONV_SLOTS] = NU_DONE;
+      l->nextBlock++;
+      pthread_cond_broadcast(&p->cond);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+#endif
+
+/* block k of a level has reached its deadline: make sure it is done */
+static void nuconv_collect(NUCONV *p, NUCONV_LEVEL *l, int64_t k)
+{
+    int     slot = (int) (k % NUCONV_SLOTS);
+
+#ifndef __EMSCRIPTEN__
+    if (p->nThreads > 0 && !l->sync) {
+      pthread_mutex_lock(&p->lock);
+      if (l->state[slot] != NU_DONE)
+        p->late++;
+      while (l->state[slot] == NU_RUNNING)
+        pthread_cond_wait(&p->cond, &p->lock);
+      if (l->state[slot] == NU_QUEUED) {
+        /* nobody has started it: no point in waiting */
+        l->state[slot] = NU_RUNNING;
+        pthread_mutex_unlock(&p->lock);
+        nuconv_block(p, l, k);
+        pthread_mutex_lock(&p->lock);
+        l->nextBlock++;
+        pthread_cond_broadcast(&p->cond);
+      }
+      l->state[slot] = NU_FREE;
+      pthread_mutex_unlock(&p->lock);
+      return;
+    }
+#endif
+    if (l->state[slot] == NU_QUEUED) {
+      nuconv_block(p, l, k);
+      l->nextBlock++;
+    }
+    l->state[slot] = NU_FREE;
+}
+
+/* input block k of a level is complete */
+static void nuconv_submit(NUCONV *p, NUCONV_LEVEL *l, int64_t k)
+{
+    int     slot = (int) (k % NUCONV_SLOTS);
+
+#ifndef __EMSCRIPTEN__
+    if (p->nThreads > 0 && !l->sync) {
+      pthread_mutex_lock(&p->lock);
+      l->deadline[slot] = (k + 1) * l->partSize + l->delay;
+      l->state[slot] = NU_QUEUED;
+      pthread_cond_signal(&p->cond);
+      pthread_mutex_unlock(&p->lock);
+      return;
+    }
+#endif
+    l->state[slot] = NU_QUEUED;
+}
+
+static int nuconv_deinit(CSOUND *csound, void *pp)
+{
+    NUCONV  *p = (NUCONV *) pp;
+#ifndef __EMSCRIPTEN__
+    int     i;
+
+    if (p->nThreads > 0) {
+      pthread_mutex_lock(&p->lock);
+      p->quit = 1;
+      pthread_cond_broadcast(&p->cond);
+      pthread_mutex_unlock(&p->lock);
+      for (i = 0; i < p->nThreads; i++)
+        pthread_join(p->threads[i], NULL);
+      pthread_cond_destroy(&p->cond);
+      pthread_mutex_destroy(&p->lock);
+      p->nThreads = 0;
+    }
+#endif
+    if (p->late > 0 && (csound->oparms->msglevel & WARNMSG))
+      csound->Warning(csound, Str("nuconv: %d tail blocks were not ready "
+                                  "in time\n"), p->late);
+    p->late = 0;
+    p->initDone = 0;
+    return OK;
+}
+
+static int nuconv_init(CSOUND *csound, NUCONV *p)
+{
+    FUNC    *ftp;
+    NUCONV_LEVEL *l;
+    int     i, j, k, m, n, nBytes, skipSamples, partSize, nChannels;
+    int     nThreads;
+    MYFLT   FFTscale, *ptr;
+
+    /* check parameters */
+    nChannels = (int) p->OUTOCOUNT;
+    if (UNLIKELY(nChannels < 1 || nChannels > FTCONV_MAXCHN)) {
+      return csound->InitError(csound, Str("nuconv: invalid number of channels"));
+    }
+    /* partition length */
+    partSize = MYFLT2LRND(*(p->iPartLen));
+    if (UNLIKELY(partSize < 4 || (partSize & (partSize - 1)) != 0)) {
+      return csound->InitError(csound, Str("nuconv: invalid impulse response "
+                                           "partition length"));
+    }
+    ftp = csound->FTnp2Find(csound, p->iFTNum);
+    if (UNLIKELY(ftp == NULL))
+      return NOTOK; /* ftfind should already have printed the error message */
+    /* calculate total length */
+    n = (int) ftp->flen / nChannels;
+    skipSamples = MYFLT2LRND(*(p->iSkipSamples));
+    n -= skipSamples;
+    if (MYFLT2LRND(*(p->iTotLen)) > 0 && n > MYFLT2LRND(*(p->iTotLen)))
+      n = MYFLT2LRND(*(p->iTotLen));
+    if (UNLIKELY(n <= 0)) {
+      return csound->InitError(csound,
+                               Str("nuconv: invalid length, or insufficient"
+                                   " IR data for convolution"));
+    }
+    if (p->initDone > 0 && *(p->iSkipInit) != FL(0.0) &&
+        nChannels == p->nChannels && partSize == p->lvl[0].partSize)
+      return OK;    /* skip initialisation if requested */
+    nuconv_deinit(csound, p);
+    p->csound = csound;
+    p->nChannels = nChannels;
+    p->late = 0;
+
+    /* lay out the levels: the head takes 8 blocks, every other level
+       starts at twice its block size and takes 6, the last takes the rest */
+    memset(p->lvl, 0, sizeof(p->lvl));
+    p->nLevels = 0;
+    for (i = 0, m = 0; m < n && i < NUCONV_MAXLVL; i++) {
+      int N = (i == 0 ? partSize : p->lvl[i - 1].partSize << 2);
+      l = &(p->lvl[i]);
+      l->partSize = N;
+      l->irOffset = m;
+      if (i == 0) {
+        l->nPartitions = 8;
+        l->delay = 0;
+        l->sync = 1;
+      }
+      else {
+        l->nPartitions = 6;
+        l->delay = N + partSize;
+        l->sync = 0;
+      }
+      if (i == NUCONV_MAXLVL - 1 || (N << 2) > NUCONV_MAXPART ||
+          m + N * l->nPartitions >= n)
+        l->nPartitions = (n - m + N - 1) / N;
+      l->outCnt = -(N + l->delay);
+      m += N * l->nPartitions;
+      p->nLevels++;
+    }
+
+    /* calculate the amount of aux space to allocate (in bytes) */
+    nBytes = 0;
+    for (i = 0; i < p->nLevels; i++) {
+      l = &(p->lvl[i]);
+      nBytes += (l->partSize << 1) * (1 + l->nPartitions * (1 + nChannels)
+                                      + NUCONV_SLOTS * nChannels);
+      nBytes += l->partSize * NUCONV_SLOTS;
+    }
+    nBytes *= (int) sizeof(MYFLT);
+    if (nBytes != (int) p->auxData.size)
+      csound->AuxAlloc(csound, (int32) nBytes, &(p->auxData));
+    else
+      memset(p->auxData.auxp, 0, nBytes);
+    ptr = (MYFLT*) p->auxData.auxp;
+
+    /* if skipping samples: check for possible truncation of IR */
+    if (skipSamples > 0 && (csound->oparms->msglevel & WARNMSG)) {
+      k = skipSamples * nChannels;
+      if (k > (int) ftp->flen)
+        k = (int) ftp->flen;
+      for (i = 0; i < k; i++) {
+        if (UNLIKELY(ftp->ftable[i] != FL(0.0))) {
+          csound->Warning(csound,
+                          Str("nuconv: skipped non-zero samples, "
+                              "impulse response may be truncated\n"));
+          break;
+        }
+      }
+    }
+
+    for (i = 0; i < p->nLevels; i++) {
+      int N2;
+      l = &(p->lvl[i]);
+      N2 = l->partSize << 1;
+      l->tmpBuf = ptr;                      ptr += N2;
+      l->ringBuf = ptr;                     ptr += N2 * l->nPartitions;
+      for (j = 0; j < nChannels; j++) {
+        l->IR_Data[j] = ptr;                ptr += N2 * l->nPartitions;
+      }
+      for (k = 0; k < NUCONV_SLOTS; k++) {
+        l->inBuf[k] = ptr;                  ptr += l->partSize;
+        for (j = 0; j < nChannels; j++) {
+          l->outBuf[k][j] = ptr;            ptr += N2;
+        }
+      }
+      /* calculate FFT of impulse response partitions, in reverse order;
+         this also sets up the FFT tables for the worker threads */
+      FFTscale = csound->GetInverseRealFFTScale(csound, N2);
+      for (j = 0; j < nChannels; j++) {
+        int rd = ((skipSamples + l->irOffset) * nChannels) + j;
+        int wr = N2 * (l->nPartitions - 1);
+        do {
+          for (k = 0; k < l->partSize; k++) {
+            if (rd >= 0 && rd < (int) ftp->flen &&
+                l->irOffset + (N2 * (l->nPartitions - 1) - wr) / 2 + k < n)
+              l->IR_Data[j][wr + k] = ftp->ftable[rd] * FFTscale;
+            else
+              l->IR_Data[j][wr + k] = FL(0.0);
+            rd += nChannels;
+          }
+          /* pad second half of IR to zero */
+          for (k = l->partSize; k < N2; k++)
+            l->IR_Data[j][wr + k] = FL(0.0);
+          csound->RealFFT(csound, &(l->IR_Data[j][wr]), N2);
+          wr -= N2;
+        } while (wr >= 0);
+      }
+    }
+
+    /* one worker per tail level unless asked otherwise */
+    nThreads = MYFLT2LRND(*(p->iThreads));
+    if (nThreads <= 0)
+      nThreads = p->nLevels - 1;
+    if (nThreads > NUCONV_MAXTHR)
+      nThreads = NUCONV_MAXTHR;
+    if (p->nLevels < 2)
+      nThreads = 0;
+    p->nThreads = 0;
+#ifndef __EMSCRIPTEN__
+    if (nThreads > 0) {
+      p->quit = 0;
+      pthread_mutex_init(&p->lock, NULL);
+      pthread_cond_init(&p->cond, NULL);
+      for (i = 0; i < nThreads; i++) {
+        if (pthread_create(&p->threads[i], NULL, nuconv_thread, p) != 0)
+          break;
+        p->nThreads++;
+      }
+      if (p->nThreads == 0) {
+        pthread_cond_destroy(&p->cond);
+        pthread_mutex_destroy(&p->lock);
+      }
+    }
+#endif
+    csound->RegisterDeinitCallback(csound, p, nuconv_deinit);
+    p->initDone = 1;
+
+    return OK;
+}
+
+static int nuconv_perf(CSOUND *csound, NUCONV *p)
+{
+    NUCONV_LEVEL  *l;
+    MYFLT         *cur, *prev;
+    int           i, n, N;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t nn, nsmps = CS_KSMPS;
+
+    if (p->initDone <= 0) goto err1;
+    if (UNLIKELY(offset))
+      for (n = 0; n < p->nChannels; n++)
+        memset(p->aOut[n], '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      for (n = 0; n < p->nChannels; n++)
+        memset(&p->aOut[n][nsmps], '\0', early*sizeof(MYFLT));
+    }
+    for (nn = offset; nn < nsmps; nn++) {
+      for (n = 0; n < p->nChannels; n++)
+        p->aOut[n][nn] = FL(0.0);
+      for (i = 0; i < p->nLevels; i++) {
+        l = &(p->lvl[i]);
+        N = l->partSize;
+        /* mix the block being read out, and the tail of the one before */
+        if (l->outCnt >= 0) {
+          if (l->outCnt == 0)
+            nuconv_collect(p, l, l->outBlock);
+          for (n = 0; n < p->nChannels; n++) {
+            cur = l->outBuf[l->outBlock % NUCONV_SLOTS][n];
+            prev = l->outBuf[(l->outBlock + NUCONV_SLOTS - 1) % NUCONV_SLOTS][n];
+            p->aOut[n][nn] += cur[l->outCnt] + prev[l->outCnt + N];
+          }
+          if (++l->outCnt >= N) {
+            l->outCnt = 0;
+            l->outBlock++;
+          }
+        }
+        else
+          l->outCnt++;
+        /* store input signal; is the block full ? */
+        l->inBuf[l->inBlock % NUCONV_SLOTS][l->inCnt] = p->aIn[nn];
+        if (++l->inCnt >= N) {
+          nuconv_submit(p, l, l->inBlock);
+          l->inBlock++;
+          l->inCnt = 0;
+        }
+      }
+    }
+    return OK;
+ err1:
+    return csound->PerfError(csound, p->h.insdshead,
+                             Str("nuconv: not initialised"));
+}
+
 /* module interface functions */
 
 int ftconv_init_(CSOUND *csound)
 {
-    return csound->AppendOpcode(csound, "ftconv",
+    return (csound->AppendOpcode(csound, "ftconv",
                                 (int) sizeof(FTCONV), TR, 5, "mmmmmmmm", "aiiooo",
                                 (int (*)(CSOUND *, void *)) ftconv_init,
                                 (int (*)(CSOUND *, void *)) NULL,
-                                (int (*)(CSOUND *, void *)) ftconv_perf);
+                                (int (*)(CSOUND *, void *)) ftconv_perf)
+            | csound->AppendOpcode(csound, "nuconv",
+                                (int) sizeof(NUCONV), TR, 5, "mmmmmmmm", "aiioooo",
+                                (int (*)(CSOUND *, void *)) nuconv_init,
+                                (int (*)(CSOUND *, void *)) NULL,
+                                (int (*)(CSOUND *, void *)) nuconv_perf));
 }
-
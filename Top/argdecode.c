@@ -212,6 +212,10 @@ static const char *longUsageList[] = {
   Str_noop("--notify\t\tNotify (ring the bell) when score or miditrack is done"),
   Str_noop("--rewrite\t\tContinually rewrite header while writing "
            "soundfile (WAV/AIFF)"),
+  Str_noop("--rewrite-interval=SECS\tRewrite the header at most every SECS "
+           "seconds (implies --rewrite)"),
+  Str_noop("--sf-writer=N\t\tWrite the soundfile on a separate thread, "
+           "with N buffers"),
   " ",
   Str_noop("--input=FNAME\t\tSound input filename"),
   Str_noop("--output=FNAME\t\tSound output filename"),
@@ -243,6 +247,8 @@ static const char *longUsageList[] = {
   Str_noop("\t\t\t1=use CSD line #s (default), 0=use ORC/SCO-relative line #s"),
   Str_noop("--extract-score=FNAME\tExtract from score.srt using extract file"),
   Str_noop("--keep-sorted-score"),
+  Str_noop("--score-stream\t\tSort the score one section at a time as it "
+           "is played"),
   Str_noop("--env:NAME=VALUE\tSet environment variable NAME to VALUE"),
   Str_noop("--env:NAME+=VALUE\tAppend VALUE to environment variable NAME"),
   Str_noop("--strsetN=VALUE\t\tSet strset table at index N to VALUE"),
@@ -255,6 +261,9 @@ static const char *longUsageList[] = {
   Str_noop("--dither-uniform\t\tDither output with rectanular distribution"),
   Str_noop("--sched\t\t\tSet real-time scheduling priority and lock memory"),
   Str_noop("--sched=N\t\tSet priority to N and lock memory"),
+  Str_noop("--sched=worksteal\tUse work-stealing deques to dispatch "
+           "instruments with -j"),
+  Str_noop("--sched=scan\t\tScan for runnable instruments with -j (default)"),
   Str_noop("--opcode-lib=NAMES\tDynamic libraries to load"),
   Str_noop("--opcode-omit=NAMES\tDynamic libraries not to load"),
   Str_noop("--omacro:XXX=YYY\tSet orchestra macro XXX to value YYY"),
@@ -273,6 +282,14 @@ static const char *longUsageList[] = {
   Str_noop("\t\t\tvelocity number to pfield N as amplitude"),
   Str_noop("--no-default-paths\tTurn off relative paths from CSD/ORC/SCO"),
   Str_noop("--sample-accurate\t\tUse sample-accurate timing of score events"),
+  Str_noop("--prefault-instances=N\tReserve memory for N instances of each "
+           "instrument at compile time"),
+  Str_noop("--opt-level=N\t\tOrchestra optimisation: 0 none, 1 folding and "
+           "unused temporaries (default),"),
+  Str_noop("\t\t\t2 also common subexpressions and init-time hoisting"),
+  Str_noop("--sample-cache=DIR\tKeep decoded GEN01 and loscilx samples in "
+           "DIR, shared"),
+  Str_noop("\t\t\tread-only between runs and processes"),
   Str_noop("--realtime\t\trealtime priority mode"),
   Str_noop("--nchnls=N\t\t override number of audio channels"),
   Str_noop("--nchnls_i=N\t\t override number of input audio channels"),
@@ -783,6 +800,20 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       O->rewrt_hdr = 1;
       return 1;
     }
+    else if (!(strncmp (s, "rewrite-interval=", 17))) {
+      s += 17;
+      csound->oparmsExt.rewrtInterval = atof(s);
+      O->rewrt_hdr = 1;
+      return 1;
+    }
+    else if (!(strncmp (s, "sf-writer=", 10))) {
+      s += 10;
+      csound->oparmsExt.sfWriterBuffers = atoi(s);
+      if (UNLIKELY(csound->oparmsExt.sfWriterBuffers == 1 ||
+                   csound->oparmsExt.sfWriterBuffers < 0))
+        dieu(csound, Str("--sf-writer needs at least 2 buffers"));
+      return 1;
+    }
     /* -S  */
     /* tempo=N use uninterpreted beats of the score, initially at tempo N
      */
@@ -797,6 +828,10 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       csound->keep_tmp = 1;
       return 1;
     }
+    else if (!(strcmp (s, "score-stream"))) {
+      csound->oparmsExt.scoreStream = 1;
+      return 1;
+    }
     /* IV - Jan 27 2005: --expression-opt */
     /* NOTE these do nothing */
     else if (!(strcmp (s, "expression-opt"))) {
@@ -945,6 +980,30 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       O->numThreads = atoi(s);
       return 1;
     }
+    else if (!(strncmp (s, "prefault-instances=", 19))) {
+      s += 19;
+      csound->oparmsExt.prefaultInstances = atoi(s);
+      return 1;
+    }
+    else if (!(strncmp (s, "opt-level=", 10))) {
+      s += 10;
+      csound->oparmsExt.optLevel = atoi(s);
+      return 1;
+    }
+    else if (!(strncmp (s, "sample-cache=", 13))) {
+      s += 13;
+      if (UNLIKELY(*s == '\0')) dieu(csound, Str("no sample cache directory"));
+      csound->oparmsExt.sampleCache = cs_strdup(csound, s);
+      return 1;
+    }
+    else if (!(strcmp (s, "sched=worksteal"))) {
+      csound->oparmsExt.dagScheduler = DAG_SCHED_WORKSTEAL;
+      return 1;
+    }
+    else if (!(strcmp (s, "sched=scan"))) {
+      csound->oparmsExt.dagScheduler = DAG_SCHED_SCAN;
+      return 1;
+    }
     else if (!(strcmp (s, "syntax-check-only"))) {
       O->syntaxCheckOnly = 1;
       return 1;
@@ -1340,7 +1399,8 @@ PUBLIC int argdecode(CSOUND *csound, int argc, char **argv_)
               while (*(++s));
               break;
             }
-            if (!(strncmp(s, "sched=", 6))) {
+            if (!(strncmp(s, "sched=", 6)) &&     /* --sched=N is priority */
+                (isdigit(s[6]) || s[6] == '-')) {
               while (*(++s));
               break;
             }
@@ -1512,8 +1572,7 @@ PUBLIC void csoundSetOutput(CSOUND *csound, char *name, char *type, char *format
     if (csound->engineStatus & CS_STATE_COMP) return;
 
     oparms->outfilename =
-      csound->Malloc(csound, strlen(name) + 1); /* will be freed by memRESET */
-    strcpy(oparms->outfilename, name); /* unsafe -- REVIEW */
+      mzone_strdup(csound, mzone_engine(csound), name); /* freed by memRESET */
     if (strcmp(oparms->outfilename, "stdout") == 0) {
       set_stdout_assign(csound, STDOUTASSIGN_SNDFILE, 1);
 #if defined(WIN32)
@@ -1552,8 +1611,7 @@ PUBLIC void csoundSetInput(CSOUND *csound, char *name) {
   if(csound->engineStatus & CS_STATE_COMP) return;
 
   oparms->infilename =
-    csound->Malloc(csound, strlen(name)); /* will be freed by memRESET */
-  strcpy(oparms->infilename, name);
+    mzone_strdup(csound, mzone_engine(csound), name); /* freed by memRESET */
   if (strcmp(oparms->infilename, "stdin") == 0) {
         set_stdin_assign(csound, STDINASSIGN_SNDFILE, 1);
 #if defined(WIN32)
@@ -1572,8 +1630,7 @@ PUBLIC void csoundSetMIDIInput(CSOUND *csound, char *name) {
   if(csound->engineStatus & CS_STATE_COMP) return;
 
    oparms->Midiname =
-     csound->Malloc(csound, strlen(name)); /* will be freed by memRESET */
-   strcpy(oparms->Midiname, name);
+     mzone_strdup(csound, mzone_engine(csound), name); /* freed by memRESET */
    if (!strcmp(oparms->Midiname, "stdin")) {
         set_stdin_assign(csound, STDINASSIGN_MIDIDEV, 1);
 #if defined(WIN32)
@@ -1592,8 +1649,7 @@ PUBLIC void csoundSetMIDIFileInput(CSOUND *csound, char *name) {
   if(csound->engineStatus & CS_STATE_COMP) return;
 
    oparms->FMidiname =
-     csound->Malloc(csound, strlen(name)); /* will be freed by memRESET */
-   strcpy(oparms->FMidiname, name);
+     mzone_strdup(csound, mzone_engine(csound), name); /* freed by memRESET */
    if (!strcmp(oparms->FMidiname, "stdin")) {
         set_stdin_assign(csound, STDINASSIGN_MIDIFILE, 1);
 #if defined(WIN32)
@@ -1612,8 +1668,7 @@ PUBLIC void csoundSetMIDIFileOutput(CSOUND *csound, char *name) {
   if(csound->engineStatus & CS_STATE_COMP) return;
 
    oparms->FMidioutname =
-     csound->Malloc(csound, strlen(name)); /* will be freed by memRESET */
-   strcpy(oparms->FMidioutname, name);
+     mzone_strdup(csound, mzone_engine(csound), name); /* freed by memRESET */
 }
 
 PUBLIC void csoundSetMIDIOutput(CSOUND *csound, char *name) {
@@ -1623,8 +1678,7 @@ PUBLIC void csoundSetMIDIOutput(CSOUND *csound, char *name) {
   if(csound->engineStatus & CS_STATE_COMP) return;
 
    oparms->Midioutname =
-     csound->Malloc(csound, strlen(name)); /* will be freed by memRESET */
-   strcpy(oparms->Midioutname, name);
+     mzone_strdup(csound, mzone_engine(csound), name); /* freed by memRESET */
 }
 
 static void list_audio_devices(CSOUND *csound, int output){
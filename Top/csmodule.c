@@ -808,6 +808,7 @@ extern long sockrecv_localops_init(CSOUND *, void *);
 #endif
 extern long afilts_localops_init(CSOUND *, void *);
 extern long pinker_localops_init(CSOUND *, void *);
+extern long cpuadsyn_localops_init(CSOUND *, void *);
 
 extern int stdopc_ModuleInit(CSOUND *csound);
 extern int pvsopc_ModuleInit(CSOUND *csound);
@@ -843,7 +844,7 @@ const INITFN staticmodules[] = { hrtfopcodes_localops_init, babo_localops_init,
 #endif
                                  gendy_localops_init,
                                  scnoise_localops_init, afilts_localops_init,
-                                 pinker_localops_init,
+                                 pinker_localops_init, cpuadsyn_localops_init,
                                  NULL };
 
 typedef NGFENS* (*FGINITFN)(CSOUND *);
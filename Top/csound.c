@@ -59,6 +59,7 @@
 #include "cs_par_orc_semantics.h"
 #include "cs_par_dispatch.h"
 #include "csound_orc_semantics.h"
+#include "aops_simd.h"
 
 #if defined(linux) || defined(__HAIKU__) || defined(__EMSCRIPTEN__)
 #define PTHREAD_SPINLOCK_INITIALIZER 0
@@ -106,19 +107,13 @@ void csoundDebuggerBreakpointReached(CSOUND *csound);
 extern OENTRY opcodlst_1[];
 
 static void free_opcode_table(CSOUND* csound) {
-    int i;
-    CS_HASH_TABLE_ITEM* bucket;
-    CONS_CELL* head;
-
-    for (i = 0; i < HASH_SIZE; i++) {
-        bucket = csound->opcodes->buckets[i];
+    CONS_CELL *head, *item;
 
-        while(bucket != NULL) {
-            head = bucket->value;
-            cs_cons_free(csound, head);
-            bucket = bucket->next;
-        }
+    head = cs_hash_table_values(csound, csound->opcodes);
+    for (item = head; item != NULL; item = item->next) {
+        cs_cons_free(csound, item->value);
     }
+    cs_cons_free(csound, head);
 
     cs_hash_table_free(csound, csound->opcodes);
 }
@@ -438,12 +433,14 @@ static const CSOUND cenviron_ = {
     csoundSetScoreOffsetSeconds,
     csoundRewindScore,
     csoundInputMessageInternal,
+    csoundRealFFTSetup,
+    csoundRealFFTExecute,
     {
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL,
+      NULL,
     },
     /* ------- private data (not to be used by hosts or externals) ------- */
     /* callback function pointers */
@@ -545,6 +542,7 @@ static const CSOUND cenviron_ = {
     NULL,           /*  csoundCallbacks_    */
     (FILE*)NULL,    /*  scfp                */
     (CORFIL*)NULL,  /*  scstr               */
+    (SCOREBIN*)NULL, /* scbin               */
     NULL,           /*  oscfp               */
     { FL(0.0) },    /*  maxamp              */
     { FL(0.0) },    /*  smaxamp             */
@@ -604,6 +602,9 @@ static const CSOUND cenviron_ = {
     0, 0,           /*  rngflg, multichan   */
     NULL,           /*  evtFuncChain        */
     NULL,           /*  OrcTrigEvts         */
+    0, 0,           /*  OrcTrigEvtsCnt, OrcTrigEvtsMax */
+    0,              /*  OrcTrigEvtsSeq      */
+    NULL,           /*  evt_queue           */
     NULL,           /*  freeEvtNodes        */
     1,              /*  csoundIsScorePending_ */
     0,              /*  advanceCnt          */
@@ -624,6 +625,10 @@ static const CSOUND cenviron_ = {
     { 0, NULL, NULL, '\0', 0, FL(0.0),
       FL(0.0), { FL(0.0) }, {NULL}},   /*  evt */
     NULL,           /*  memalloc_db         */
+    NULL,           /*  memzone_db          */
+    NULL,           /*  engine_zone         */
+    NULL,           /*  compile_zone        */
+    NULL,           /*  perf_zone           */
     (MGLOBAL*) NULL, /* midiGlobals         */
     NULL,           /*  envVarDB            */
     (MEMFIL*) NULL, /*  memfiles            */
@@ -631,6 +636,7 @@ static const CSOUND cenviron_ = {
     0,              /*  FFT_max_size        */
     NULL,           /*  FFT_table_1         */
     NULL,           /*  FFT_table_2         */
+    NULL,           /*  FFT_plans           */
     NULL, NULL, NULL, /* tseg, tpsave, tplim */
     0, 0, 0, 0, 0, 0, /*  acount, kcount, icount, Bcount, bcount, tcount */
     (MYFLT*) NULL,  /*  gbloffbas           */
@@ -649,6 +655,9 @@ static const CSOUND cenviron_ = {
 #endif
     0,              /* init pass loop  */
     NULL,           /* init pass threadlock */
+    NULL,           /* init pass signal */
+    NULL,           /* init queue lock */
+    NULL, NULL,     /* init queue head, tail */
     NULL,           /* API_lock */
 #if defined(HAVE_PTHREAD_SPIN_LOCK)
     PTHREAD_SPINLOCK_INITIALIZER,              /*  spoutlock           */
@@ -684,6 +693,8 @@ static const CSOUND cenviron_ = {
       "",          /*  repeat_name[NAMELEN] */
       0,0,1,        /*  repeat_cnt, repeat_point, repeat_inc */
       NULL,         /*  repeat_mm */
+      0, 0,         /*  randSeed, ownSeed */
+      NULL          /*  errjmp */
     },
     {
       NULL,
@@ -723,6 +734,8 @@ static const CSOUND cenviron_ = {
       1U,           /*  nframes             */
       NULL, NULL,   /*  pin, pout           */
       0,            /*dither                */
+      NULL,         /*  writer              */
+      0.0           /*  hdrtime             */
     },
     0,              /*  warped              */
     0,              /*  sstrlen             */
@@ -744,6 +757,7 @@ static const CSOUND cenviron_ = {
     NULL,           /*  open_files          */
     NULL,           /*  searchPathCache     */
     NULL,           /*  sndmemfiles         */
+    NULL,           /*  sndcache            */
     NULL,           /*  reset_list          */
     NULL,           /*  pvFileTable         */
     0,              /*  pvNumFiles          */
@@ -839,6 +853,10 @@ static const CSOUND cenviron_ = {
     NULL,           /* instCurr */
     NULL,           /* instRoot */
     0,              /* inInstr */
+    NULL,           /* globalIds */
+    NULL,           /* globalNames */
+    0,              /* globalCount */
+    0,              /* globalNamesMax */
     /* new dag model statics */
     1,              /* dag_changed */
     0,              /* dag_num_active */
@@ -846,8 +864,14 @@ static const CSOUND cenviron_ = {
     NULL,           /* dag_task_status */
     NULL,           /* dag_task_watch */
     NULL,           /* dag_wlmm */
-    NULL,           /* dag_task_dep */
+    NULL,           /* dag_task_grp */
     100,            /* dag_task_max_size */
+    NULL,           /* dag_groups */
+    0,              /* dag_num_groups */
+    0,              /* dag_groups_max */
+    NULL,           /* dag_grp_deps */
+    0,              /* dag_grp_deps_max */
+    NULL,           /* dag_sched */
     0,              /* tempStatus */
     0,              /* orcLineOffset */
     0,              /* scoLineOffset */
@@ -871,7 +895,16 @@ static const CSOUND cenviron_ = {
     -1,             /* audio system sr */
     0,              /* csdebug_data */
     kperf_nodebug,  /* current kperf function - nodebug by default */
-    0               /* which score parser */
+    0,              /* which score parser */
+    {               /*  oparmsExt           */
+      DAG_SCHED_SCAN, /*  dagScheduler */
+      0,            /*    prefaultInstances */
+      1,            /*    optLevel */
+      NULL,         /*    sampleCache */
+      0,            /*    scoreStream */
+      0.0,          /*    rewrtInterval */
+      0             /*    sfWriterBuffers */
+    }
     /*, NULL */           /* self-reference */
 };
 
@@ -1119,6 +1152,7 @@ PUBLIC int csoundInitialize(int flags)
       csoundUnLock();
       return -1;
     }
+    aops_simd_init();
     if (!(flags & CSOUNDINIT_NO_SIGNAL_HANDLER)) {
       install_signal_handler();
     }
@@ -1322,90 +1356,162 @@ int dag_get_task(CSOUND *csound);
 int dag_end_task(CSOUND *csound, int task);
 void dag_build(CSOUND *csound, INSDS *chain);
 void dag_reinit(CSOUND *csound);
+void dag_ws_free(CSOUND *csound);
+int dag_ws_get_task(CSOUND *csound, int index);
+void dag_ws_end_task(CSOUND *csound, int index, int task);
+
+/* Per-instance performance functions.  insert() picks instr_perf or,
+   with --sample-accurate, instr_perf_sa; setksmps switches an instance
+   to instr_perf_local.  The single and multi-threaded kperf loops just
+   call ip->perfadr for every instance whose init pass is done. */
+
+/* An opcode has moved ip->pds (kgoto, reinit, turnoff...): perf
+   continues after the op it points to.  The ops of an instance are laid
+   out in chain order, so the array is sorted by address.  Returns NULL
+   if the target is not in the array. */
+static CS_NOINLINE OPDS **instr_perf_jump(INSDS *ip)
+{
+    OPDS    **ops = ip->perfops, *to = ip->pds;
+    int     lo = 0, hi, mid;
+
+    if (to == (OPDS*) ip)
+      return ops;                     /* back to the start */
+    for (hi = 0; ops[hi] != NULL; hi++)
+      ;
+    if (to == NULL)
+      return &ops[hi];
+    hi--;
+    while (lo <= hi) {
+      mid = (lo + hi) >> 1;
+      if (ops[mid] == to)
+        return &ops[mid + 1];
+      if (ops[mid] < to) lo = mid + 1;
+      else hi = mid - 1;
+    }
+    return NULL;
+}
+
+/* the old chain walk, for a jump the array does not know about */
+static CS_NOINLINE void instr_perf_chain(CSOUND *csound, INSDS *ip,
+                                         int checkact)
+{
+    OPDS  *opstart = ip->pds;
+    while ((opstart = opstart->nxtp) != NULL && (!checkact || ip->actflg)) {
+      opstart->insdshead->pds = opstart;
+      (*opstart->opadr)(csound, opstart); /* run each opcode */
+      opstart = opstart->insdshead->pds;
+    }
+}
+
+/* ip->pds is still stored for each op, since perf errors, turnoff and
+   a few opcodes read it, but only read back to detect a jump */
+static inline void instr_perf_ops(CSOUND *csound, INSDS *ip, int checkact)
+{
+    OPDS  **pp = ip->perfops, *opds;
+    while ((opds = *pp++) != NULL && (!checkact || ip->actflg)) {
+      ip->pds = opds;
+      (*opds->opadr)(csound, opds); /* run each opcode */
+      if (UNLIKELY(ip->pds != opds)) {
+        if ((pp = instr_perf_jump(ip)) == NULL) {
+          instr_perf_chain(csound, ip, checkact);
+          return;
+        }
+      }
+    }
+}
+
+/* sample-accurate end: flag the last cycle of performance */
+static inline void instr_perf_check_end(CSOUND *csound, INSDS *ip)
+{
+    double time_end = (csound->ksmps+csound->icurTime)/csound->esr;
+    if (ip->offtim > 0 && time_end > ip->offtim)
+      ip->ksmps_no_end = ip->no_end;
+}
+
+void instr_perf(CSOUND *csound, INSDS *ip)
+{
+    ip->spin = csound->spin;
+    ip->spout = csound->spout;
+    ip->kcounter = csound->kcounter;
+    instr_perf_ops(csound, ip, 0);
+    ip->ksmps_offset = 0; /* reset sample-accuracy offset */
+    ip->ksmps_no_end = 0; /* reset end of loop samples */
+}
+
+void instr_perf_sa(CSOUND *csound, INSDS *ip)
+{
+    instr_perf_check_end(csound, ip);
+    instr_perf(csound, ip);
+}
+
+/* local ksmps: run the instance once per sub-block */
+void instr_perf_local(CSOUND *csound, INSDS *ip)
+{
+    int i, n = csound->nspout, start = 0;
+    int lksmps = ip->ksmps;
+    int incr = csound->nchnls*lksmps;
+    int offset, early;
+
+    if (csound->oparms->sampleAccurate)
+      instr_perf_check_end(csound, ip);
+    offset = ip->ksmps_offset;
+    early = ip->ksmps_no_end;
+    ip->spin = csound->spin;
+    ip->spout = csound->spout;
+    ip->kcounter = csound->kcounter*csound->ksmps/lksmps;
+
+    /* we have to deal with sample-accurate code
+       whole CS_KSMPS blocks are offset here, the
+       remainder is left to each opcode to deal with.
+    */
+    while (offset >= lksmps) {
+      offset -= lksmps;
+      start += csound->nchnls;
+    }
+    ip->ksmps_offset = offset;
+    if (early) {
+      n -= (early*csound->nchnls);
+      ip->ksmps_no_end = early % lksmps;
+    }
+
+    for (i=start; i < n; i+=incr, ip->spin+=incr, ip->spout+=incr) {
+      instr_perf_ops(csound, ip, 1);
+      ip->kcounter++;
+    }
+    ip->ksmps_offset = 0; /* reset sample-accuracy offset */
+    ip->ksmps_no_end = 0; /* reset end of loop samples */
+}
 
 inline static int nodePerf(CSOUND *csound, int index)
 {
     INSDS *insds = NULL;
-    OPDS  *opstart = NULL;
     int played_count = 0;
     int which_task;
     INSDS **task_map = (INSDS**)csound->dag_task_map;
-    double time_end;
+    int worksteal = (csound->oparmsExt.dagScheduler == DAG_SCHED_WORKSTEAL);
 #define INVALID (-1)
 #define WAIT    (-2)
-    IGN(index);
 
     while(1) {
       int done;
-      which_task = dag_get_task(csound);
+      which_task = worksteal ? dag_ws_get_task(csound, index)
+                             : dag_get_task(csound);
       //printf("******** Select task %d\n", which_task);
       if (which_task==WAIT) continue;
       if (which_task==INVALID) return played_count;
-         /* VL: the validity of icurTime needs to be checked */
-        time_end = (csound->ksmps+csound->icurTime)/csound->esr;
-        insds = task_map[which_task];
-        if (insds->offtim > 0 && time_end > insds->offtim){
-            /* this is the last cycle of performance */
-            insds->ksmps_no_end = insds->no_end;
-          }
+      insds = task_map[which_task];
 #ifdef HAVE_ATOMIC_BUILTIN
-        done = __sync_fetch_and_add((int *) &insds->init_done, 0);
+      done = __sync_fetch_and_add((int *) &insds->init_done, 0);
 #else
-        done = insds->init_done;
+      done = insds->init_done;
 #endif
-        if(done) {
-        opstart = (OPDS*)task_map[which_task];
-        if(insds->ksmps == csound->ksmps) {
-        insds->spin = csound->spin;
-        insds->spout = csound->spout;
-        insds->kcounter =  csound->kcounter;
-        while ((opstart = opstart->nxtp) != NULL) {
-          /* In case of jumping need this repeat of opstart */
-          opstart->insdshead->pds = opstart;
-          (*opstart->opadr)(csound, opstart); /* run each opcode */
-          opstart = opstart->insdshead->pds;
-        }
-        } else {
-          int i, n = csound->nspout, start = 0;
-          int lksmps = insds->ksmps;
-          int incr = csound->nchnls*lksmps;
-          int offset =  insds->ksmps_offset;
-          int early = insds->ksmps_no_end;
-          OPDS  *opstart;
-          insds->spin = csound->spin;
-          insds->spout = csound->spout;
-          insds->kcounter =  csound->kcounter*csound->ksmps;
-
-          /* we have to deal with sample-accurate code
-             whole CS_KSMPS blocks are offset here, the
-             remainder is left to each opcode to deal with.
-          */
-          while(offset >= lksmps) {
-            offset -= lksmps;
-            start += csound->nchnls;
-          }
-          insds->ksmps_offset = offset;
-          if(early){
-            n -= (early*csound->nchnls);
-            insds->ksmps_no_end = early % lksmps;
-          }
-
-          for (i=start; i < n; i+=incr, insds->spin+=incr, insds->spout+=incr) {
-            opstart = (OPDS*) insds;
-            while ((opstart = opstart->nxtp) != NULL) {
-              opstart->insdshead->pds = opstart;
-              (*opstart->opadr)(csound, opstart); /* run each opcode */
-              opstart = opstart->insdshead->pds;
-            }
-            insds->kcounter++;
-          }
-        }
-        insds->ksmps_offset = 0; /* reset sample-accuracy offset */
-        insds->ksmps_no_end = 0;  /* reset end of loop samples */
+      if (done) {
+        insds->perfadr(csound, insds);
         played_count++;
-        }
-        //printf("******** finished task %d\n", which_task);
-        dag_end_task(csound, which_task);
+      }
+      //printf("******** finished task %d\n", which_task);
+      if (worksteal) dag_ws_end_task(csound, index, which_task);
+      else dag_end_task(csound, which_task);
     }
     return played_count;
 }
@@ -1504,76 +1610,16 @@ int kperf_nodebug(CSOUND *csound)
       }
       else {
         int done;
-        double time_end = (csound->ksmps+csound->icurTime)/csound->esr;
 
         while (ip != NULL) {                /* for each instr active:  */
           INSDS *nxt = ip->nxtact;
-          if (UNLIKELY(csound->oparms->sampleAccurate &&
-                       ip->offtim > 0                 &&
-                       time_end > ip->offtim)) {
-            /* this is the last cycle of performance */
-            //   csound->Message(csound, "last cycle %d: %f %f %d\n",
-            //       ip->insno, csound->icurTime/csound->esr,
-            //          ip->offtim, ip->no_end);
-            ip->ksmps_no_end = ip->no_end;
-          }
 #ifdef HAVE_ATOMIC_BUILTIN
           done = __sync_fetch_and_add((int *) &ip->init_done, 0);
 #else
           done = ip->init_done;
 #endif
-
-          if (done == 1) {/* if init-pass has been done */
-            OPDS  *opstart = (OPDS*) ip;
-            ip->spin = csound->spin;
-            ip->spout = csound->spout;
-            ip->kcounter =  csound->kcounter;
-            if(ip->ksmps == csound->ksmps) {
-              while ((opstart = opstart->nxtp) != NULL) {
-                opstart->insdshead->pds = opstart;
-                (*opstart->opadr)(csound, opstart); /* run each opcode */
-                opstart = opstart->insdshead->pds;
-              }
-            } else {
-              int i, n = csound->nspout, start = 0;
-                int lksmps = ip->ksmps;
-                int incr = csound->nchnls*lksmps;
-                int offset =  ip->ksmps_offset;
-                int early = ip->ksmps_no_end;
-                OPDS  *opstart;
-                ip->spin = csound->spin;
-                ip->spout = csound->spout;
-                ip->kcounter =  csound->kcounter*csound->ksmps/lksmps;
-
-                /* we have to deal with sample-accurate code
-                   whole CS_KSMPS blocks are offset here, the
-                   remainder is left to each opcode to deal with.
-                */
-                while(offset >= lksmps) {
-                  offset -= lksmps;
-                  start += csound->nchnls;
-                }
-                ip->ksmps_offset = offset;
-                if(early){
-                  n -= (early*csound->nchnls);
-                  ip->ksmps_no_end = early % lksmps;
-                  }
-
-               for (i=start; i < n; i+=incr, ip->spin+=incr, ip->spout+=incr) {
-                  opstart = (OPDS*) ip;
-                  while ((opstart = opstart->nxtp) != NULL && ip->actflg) {
-                    opstart->insdshead->pds = opstart;
-                    (*opstart->opadr)(csound, opstart); /* run each opcode */
-                    opstart = opstart->insdshead->pds;
-                  }
-                  ip->kcounter++;
-                }
-            }
-          }
-          /*else csound->Message(csound, "time %f \n",
-                                 csound->kcounter/csound->ekr);*/
-          ip->ksmps_offset = 0; /* reset sample-accuracy offset */
-          ip->ksmps_no_end = 0; /* reset end of loop samples */
+          if (done == 1)                    /* if init-pass has been done */
+            ip->perfadr(csound, ip);
           ip = nxt; /* but this does not allow for all deletions */
         }
       }
@@ -1874,8 +1920,12 @@ PUBLIC int csoundReadScore(CSOUND *csound, const char *str)
     corfile_flush(csound->scorestr);
     /* copy sorted score name */
     csoundLockMutex(csound->API_lock);
-    if(csound->scstr == NULL && (csound->engineStatus & CS_STATE_COMP) == 0) {
-      scsortstr(csound, csound->scorestr);
+    if(csound->scstr == NULL && csound->scbin == NULL &&
+       (csound->engineStatus & CS_STATE_COMP) == 0) {
+      if (!csound->keep_tmp && csound->xfilename == NULL && !O->usingcscore)
+        scsortbin(csound, csound->scorestr);
+      else
+        scsortstr(csound, csound->scorestr);
       O->playscore = csound->scstr;
     }
     else {
@@ -2398,6 +2448,10 @@ PUBLIC int csoundScoreEvent(CSOUND *csound, char type,
     EVTBLK  evt;
     int     i;
     int ret;
+
+    if (event_queue_push(csound, type, pfields, numFields,
+                         csound->icurTime) == 0)
+      return 0;
     memset(&evt, 0, sizeof(EVTBLK));
 
     evt.strarg = NULL; evt.scnt = 0;
@@ -2407,6 +2461,7 @@ PUBLIC int csoundScoreEvent(CSOUND *csound, char type,
       evt.p[i + 1] = pfields[i];
     //memcpy(&evt.p[1],pfields, numFields*sizeof(MYFLT));
     csoundLockMutex(csound->API_lock);
+    event_queue_drain(csound);
     ret = insert_score_event_at_sample(csound, &evt, csound->icurTime);
     csoundUnlockMutex(csound->API_lock);
     return ret;
@@ -2419,6 +2474,11 @@ PUBLIC int csoundScoreEventAbsolute(CSOUND *csound, char type,
     EVTBLK  evt;
     int     i;
     int     ret;
+
+    /* the ring keeps the offset in samples, as insert_score_event() */
+    if (event_queue_push(csound, type, pfields, numFields,
+                         (int64_t) (time_ofs * csound->esr)) == 0)
+      return 0;
     memset(&evt, 0, sizeof(EVTBLK));
 
     evt.strarg = NULL; evt.scnt = 0;
@@ -2427,6 +2487,7 @@ PUBLIC int csoundScoreEventAbsolute(CSOUND *csound, char type,
     for (i = 0; i < (int) numFields; i++)
       evt.p[i + 1] = pfields[i];
    csoundLockMutex(csound->API_lock);
+    event_queue_drain(csound);
     ret = insert_score_event(csound, &evt, time_ofs);
    csoundUnlockMutex(csound->API_lock);
     return ret;
@@ -2964,6 +3025,7 @@ static void reset(CSOUND *csound)
     /* delete temporary files created by this Csound instance */
     remove_tmpfiles(csound);
     rlsmemfiles(csound);
+    dag_ws_free(csound);
 
      memRESET(csound);
 
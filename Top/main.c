@@ -276,7 +276,12 @@ PUBLIC int csoundCompileArgs(CSOUND *csound, int argc, char **argv)
           csoundDie(csound, Str("cannot open scorefile %s"), csound->scorename);
       }
       csound->Message(csound, Str("sorting score ...\n"));
-      scsortstr(csound, csound->scorestr);
+      /* the sorted text is only kept for score.srt, extract and cscore */
+      if (!csound->keep_tmp && csound->xfilename == NULL &&
+          !O->usingcscore && csound->scstr == NULL && csound->scbin == NULL)
+        scsortbin(csound, csound->scorestr);
+      else
+        scsortstr(csound, csound->scorestr);
       if (csound->keep_tmp) {
         FILE *ff = fopen("score.srt", "w");
         fputs(corfile_body(csound->scstr), ff);
@@ -474,6 +479,7 @@ PUBLIC int csoundStart(CSOUND *csound) // DEBUG
 
       csound->WaitBarrier(csound->barrier2);
     }
+    event_queue_create(csound);
     csound->engineStatus |= CS_STATE_COMP;
     if(csound->oparms->daemon > 1)
         UDPServerStart(csound,csound->oparms->daemon);
@@ -21,6 +21,7 @@
 
 #include "csoundCore.h"
 #include <stdlib.h>
+#include <stddef.h>
 
 #ifdef USE_DOUBLE
 #  define MYFLT_INT_TYPE int64_t
@@ -32,8 +33,216 @@ extern void csoundInputMessageInternal(CSOUND *csound, const char *message);
 extern void set_channel_data_ptr(CSOUND *csound, const char *name,
                                  void *ptr, int newSize);
 
+/* Score events sent from host threads with csoundScoreEvent() and
+   friends are put on a bounded multi-producer/single-consumer ring,
+   so that the sending thread does not wait for API_lock, which the
+   performance thread holds for a whole k-cycle.  The ring is drained
+   by sensevents() at the start of each k-cycle.  Events that do not
+   fit in a slot, or that arrive when the ring is full, go through the
+   locked path instead (after draining the ring, to keep their order).
+   Line events from csoundInputMessage() share the ring as a copy of
+   their text, which is handed to the line event parser when drained.
+   The ring is a bounded MPMC queue after D. Vyukov: each slot carries
+   a sequence number telling producers and the consumer whose turn it
+   is. */
+
+#define EVTQ_SIZE       1024            /* must be a power of two */
+#define EVTQ_PFIELDS    16
+
+typedef struct {
+    volatile uint64_t seq;
+    int64_t     time_ofs;               /* in samples */
+    char        *msg;                   /* line event text, or NULL */
+    char        opcod;
+    int16       pcnt;
+    MYFLT       p[EVTQ_PFIELDS];
+} EVTQ_SLOT;
+
+typedef struct {
+    volatile uint64_t head;             /* next slot to fill */
+    char        pad1[64 - sizeof(uint64_t)];
+    volatile uint64_t tail;             /* next slot to drain */
+    char        pad2[64 - sizeof(uint64_t)];
+    EVTQ_SLOT   slots[EVTQ_SIZE];
+} EVTQ;
+
+void event_queue_create(CSOUND *csound)
+{
+#ifdef HAVE_ATOMIC_BUILTIN
+    EVTQ    *q;
+    int     i;
+
+    if (csound->evt_queue != NULL)
+      return;
+    q = (EVTQ*) csound->Calloc(csound, sizeof(EVTQ));
+    for (i = 0; i < EVTQ_SIZE; i++)
+      q->slots[i].seq = (uint64_t) i;
+    __sync_synchronize();
+    csound->evt_queue = (void*) q;
+#else
+    IGN(csound);
+#endif
+}
+
+#ifdef HAVE_ATOMIC_BUILTIN
+/* claims the next free slot, or returns NULL if the ring is full */
+
+static EVTQ_SLOT *event_queue_claim(EVTQ *q, uint64_t *ppos)
+{
+    EVTQ_SLOT *slot;
+    uint64_t  pos = q->head;
+    int64_t   dif;
+
+    for (;;) {
+      slot = &q->slots[pos & (EVTQ_SIZE - 1)];
+      dif = (int64_t) (__sync_fetch_and_add(&slot->seq, 0) - pos);
+      if (dif == 0) {
+        if (__sync_bool_compare_and_swap(&q->head, pos, pos + 1))
+          break;
+      }
+      else if (dif < 0)
+        return NULL;
+      pos = q->head;
+    }
+    *ppos = pos;
+    return slot;
+}
+#endif
+
+/* returns 0 if the event was queued */
+
+int event_queue_push(CSOUND *csound, char opcod, const MYFLT *pfields,
+                     long numFields, int64_t time_ofs)
+{
+#ifdef HAVE_ATOMIC_BUILTIN
+    EVTQ      *q = (EVTQ*) csound->evt_queue;
+    EVTQ_SLOT *slot;
+    uint64_t  pos;
+
+    if (q == NULL || numFields < 0 || numFields > EVTQ_PFIELDS)
+      return -1;
+    if ((slot = event_queue_claim(q, &pos)) == NULL)
+      return -1;
+    slot->msg = NULL;
+    slot->opcod = opcod;
+    slot->pcnt = (int16) numFields;
+    slot->time_ofs = time_ofs;
+    memcpy(slot->p, pfields, numFields * sizeof(MYFLT));
+    __sync_synchronize();
+    slot->seq = pos + 1;
+    csound->oparms->RTevents = 1;
+    return 0;
+#else
+    IGN(csound); IGN(opcod); IGN(pfields); IGN(numFields); IGN(time_ofs);
+    return -1;
+#endif
+}
+
+/* queues a copy of a line event; returns 0 on success */
+
+static int event_queue_push_message(CSOUND *csound, const char *message)
+{
+#ifdef HAVE_ATOMIC_BUILTIN
+    EVTQ      *q = (EVTQ*) csound->evt_queue;
+    EVTQ_SLOT *slot;
+    uint64_t  pos;
+    size_t    n;
+
+    if (q == NULL || (slot = event_queue_claim(q, &pos)) == NULL)
+      return -1;
+    n = strlen(message) + 1;
+    slot->msg = (char*) memcpy(csound->Malloc(csound, n), message, n);
+    slot->pcnt = 0;
+    __sync_synchronize();
+    slot->seq = pos + 1;
+    return 0;
+#else
+    IGN(csound); IGN(message);
+    return -1;
+#endif
+}
+
+/* called by the performance thread, or with API_lock held */
+
+void event_queue_drain(CSOUND *csound)
+{
+#ifdef HAVE_ATOMIC_BUILTIN
+    EVTQ      *q = (EVTQ*) csound->evt_queue;
+    EVTQ_SLOT *slot;
+    EVTBLK    evt;
+    uint64_t  pos;
+    int       i, err;
+
+    if (q == NULL)
+      return;
+    pos = q->tail;
+    for (;;) {
+      slot = &q->slots[pos & (EVTQ_SIZE - 1)];
+      if (__sync_fetch_and_add(&slot->seq, 0) != pos + 1)
+        break;
+      if (slot->msg != NULL) {
+        csoundInputMessageInternal(csound, slot->msg);
+        csound->Free(csound, slot->msg);
+        slot->msg = NULL;
+      }
+      else {
+        memset(&evt, 0, offsetof(EVTBLK, p));
+        evt.opcod = slot->opcod;
+        evt.pcnt = slot->pcnt;
+        for (i = 0; i < slot->pcnt; i++)
+          evt.p[i + 1] = slot->p[i];
+        /* the sender has already been told the event was accepted */
+        if (UNLIKELY((err = insert_score_event_at_sample(csound, &evt,
+                                                         slot->time_ofs))))
+          csound->Warning(csound,
+                          Str("queued score event '%c' could not be "
+                              "inserted (error %d)"), evt.opcod, err);
+      }
+      __sync_synchronize();
+      slot->seq = pos + EVTQ_SIZE;
+      pos++;
+    }
+    q->tail = pos;
+#else
+    IGN(csound);
+#endif
+}
+
+PUBLIC int csoundScoreEventBatch(CSOUND *csound,
+                                 const scoreEvent_t *events, int numEvents)
+{
+    int     i, ret = 0, err;
+    int64_t now = csound->icurTime;
+
+    for (i = 0; i < numEvents; i++) {
+      const scoreEvent_t *e = &events[i];
+      if (event_queue_push(csound, e->type, e->pFields, e->numFields, now) == 0)
+        continue;
+      /* does not fit in the ring: insert it and the rest directly */
+      csoundLockMutex(csound->API_lock);
+      event_queue_drain(csound);
+      for ( ; i < numEvents; i++) {
+        EVTBLK  evt;
+        int     j;
+        e = &events[i];
+        memset(&evt, 0, sizeof(EVTBLK));
+        evt.opcod = e->type;
+        evt.pcnt = (int16) e->numFields;
+        for (j = 0; j < e->numFields; j++)
+          evt.p[j + 1] = e->pFields[j];
+        if ((err = insert_score_event_at_sample(csound, &evt, now)) != 0)
+          ret = err;
+      }
+      csoundUnlockMutex(csound->API_lock);
+    }
+    return ret;
+}
+
 void csoundInputMessage(CSOUND *csound, const char *message){
+    if (event_queue_push_message(csound, message) == 0)
+      return;
     csoundLockMutex(csound->API_lock);
+    event_queue_drain(csound);
     csoundInputMessageInternal(csound, message);
     csoundUnlockMutex(csound->API_lock);
 }
@@ -24,6 +24,7 @@ $(CSOUND_SRC_ROOT)/Engine/insert.c \
 $(CSOUND_SRC_ROOT)/Engine/linevent.c \
 $(CSOUND_SRC_ROOT)/Engine/memalloc.c \
 $(CSOUND_SRC_ROOT)/Engine/memfiles.c \
+$(CSOUND_SRC_ROOT)/Engine/sndcache.c \
 $(CSOUND_SRC_ROOT)/Engine/musmon.c \
 $(CSOUND_SRC_ROOT)/Engine/namedins.c \
 $(CSOUND_SRC_ROOT)/Engine/rdscor.c \
@@ -48,12 +49,14 @@ $(CSOUND_SRC_ROOT)/InOut/window.c \
 $(CSOUND_SRC_ROOT)/InOut/winEPS.c \
 $(CSOUND_SRC_ROOT)/InOut/circularbuffer.c \
 $(CSOUND_SRC_ROOT)/OOps/aops.c \
+$(CSOUND_SRC_ROOT)/OOps/aops_simd.c \
 $(CSOUND_SRC_ROOT)/OOps/bus.c \
 $(CSOUND_SRC_ROOT)/OOps/cmath.c \
 $(CSOUND_SRC_ROOT)/OOps/diskin2.c \
 $(CSOUND_SRC_ROOT)/OOps/disprep.c \
 $(CSOUND_SRC_ROOT)/OOps/dumpf.c \
 $(CSOUND_SRC_ROOT)/OOps/fftlib.c \
+$(CSOUND_SRC_ROOT)/OOps/fftplan.c \
 $(CSOUND_SRC_ROOT)/OOps/goto_ops.c \
 $(CSOUND_SRC_ROOT)/OOps/midiinterop.c \
 $(CSOUND_SRC_ROOT)/OOps/midiops.c \
@@ -152,6 +155,7 @@ $(CSOUND_SRC_ROOT)/Top/server.c \
 $(CSOUND_SRC_ROOT)/Top/threadsafe.c \
 $(CSOUND_SRC_ROOT)/Opcodes/ambicode.c       \
 $(CSOUND_SRC_ROOT)/Opcodes/afilters.c       \
+$(CSOUND_SRC_ROOT)/Opcodes/cpuadsyn.c       \
 $(CSOUND_SRC_ROOT)/Opcodes/bbcut.c          \
 $(CSOUND_SRC_ROOT)/Opcodes/biquad.c \
 $(CSOUND_SRC_ROOT)/Opcodes/butter.c         \
@@ -315,7 +315,8 @@ int main(int argc, char **argv)
     /*  One complete performance cycle. */
     result = csoundCompile(csound, argc, argv);
 
-     if(!result) csoundPerform(csound);
+    /* a negative result is an error, e.g. exitnow with a non-zero code */
+     if(!result) result = csoundPerform(csound);
 
     /* delete Csound instance */
      csoundDestroy(csound);
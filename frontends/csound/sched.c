@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <ctype.h>
 #include <unistd.h>
 #include <errno.h>
 #include <time.h>
@@ -74,6 +75,8 @@ static int parse_sched_opt(const char *s, int *priority, int *cpuMax, int *secs)
     if (strncmp(s, "--sched=", 8) == 0) {
       int   cnt;
       s += 8;
+      if (isalpha((unsigned char) *s))  /* --sched=worksteal etc., */
+        return 0;                       /* handled by the library   */
       cnt = parse_number(s, priority);
       if (cnt < 1)
         goto fmt_err;
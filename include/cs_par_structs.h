@@ -46,4 +46,19 @@ typedef struct _watchList {
   struct _watchList *next;
 } watchList;
 
+/* A run of consecutive tasks that are instances of the same instrument.
+   Dependencies are held between groups, as they only depend on which
+   globals the two instruments use. */
+typedef struct dag_group {
+  taskID  first, last;              /* tasks first .. last-1 */
+  struct instr_semantics_t *sem;
+  int     self;                     /* instances must run in chain order */
+  int     deps, ndeps;              /* earlier conflicting groups, as an
+                                       offset/count into dag_grp_deps */
+} DAG_GROUP;
+
+/* Task dispatch policies, selected with --sched= */
+#define DAG_SCHED_SCAN       0   /* threads scan the status array */
+#define DAG_SCHED_WORKSTEAL  1   /* per-thread deques with stealing */
+
 #endif
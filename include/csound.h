@@ -549,6 +549,23 @@ extern "C" {
         controlChannelHints_t    hints;
     } controlChannelInfo_t;
 
+/**
+ * A score event for csoundScoreEventBatch()
+ */
+    typedef struct scoreEvent_s {
+        /** event type: 'a', 'i', 'q', 'f' or 'e' */
+        char    type;
+        /** number of p-fields in pFields */
+        int     numFields;
+        /** p-fields, starting with p1 */
+        const MYFLT *pFields;
+    } scoreEvent_t;
+
+/**
+ * Opaque handle to a bus channel, see csoundGetChannelHandle()
+ */
+    typedef struct channelEntry_s *CSOUND_CHANNEL_HANDLE;
+
     typedef void (*channelCallback_t)(CSOUND *csound,
             const char *channelName,
             void *channelValuePtr,
@@ -1408,6 +1425,34 @@ extern "C" {
     PUBLIC int csoundGetChannelPtr(CSOUND *,
             MYFLT **p, const char *name, int type);
 
+    /**
+     * Returns a handle to the channel called 'name', creating it if
+     * it does not exist yet (see csoundGetChannelPtr() for 'type').
+     * The handle is resolved once and stays valid until csoundReset(),
+     * so hosts that access many channels every k-cycle can avoid the
+     * name lookup of the functions below. Returns NULL if the channel
+     * could not be created or exists with an incompatible type.
+     */
+    PUBLIC CSOUND_CHANNEL_HANDLE csoundGetChannelHandle(CSOUND *,
+            const char *name, int type);
+
+    /**
+     * Writes values[i] to the control channel handles[i], for n channels,
+     * followed by a single memory barrier. Returns CSOUND_SUCCESS, or
+     * CSOUND_ERROR if any handle is NULL or not a control channel (those
+     * are skipped).
+     */
+    PUBLIC int csoundSetControlChannels(CSOUND *,
+            const CSOUND_CHANNEL_HANDLE *handles, const MYFLT *values, int n);
+
+    /**
+     * Reads the control channels handles[0..n-1] into values, after a
+     * single memory barrier. Returns CSOUND_SUCCESS, or CSOUND_ERROR if
+     * any handle is NULL or not a control channel (its value is set to 0).
+     */
+    PUBLIC int csoundGetControlChannels(CSOUND *,
+            const CSOUND_CHANNEL_HANDLE *handles, MYFLT *values, int n);
+
     /**
      * Returns a list of allocated channels in *lst. A controlChannelInfo_t
      * structure contains the channel characteristics.
@@ -1547,6 +1592,11 @@ extern "C" {
      * 'numFields' is the size of the pFields array.  'pFields' is an array of
      * floats with all the pfields for this event, starting with the p1 value
      * specified in pFields[0].
+     * Once performance has started, short events are queued for the
+     * performance thread without taking the API lock (see
+     * csoundScoreEventBatch()).  A queued event returns zero as soon as
+     * it is queued: errors found when it is inserted are only reported
+     * as warnings, not returned to the caller.
      */
     PUBLIC int csoundScoreEvent(CSOUND *,
             char type, const MYFLT *pFields, long numFields);
@@ -1554,14 +1604,30 @@ extern "C" {
     /**
      * Like csoundScoreEvent(), this function inserts a score event, but
      * at absolute time with respect to the start of performance, or from an
-     * offset set with time_ofs
+     * offset set with time_ofs.  It is queued in the same way, and a queued
+     * event also returns zero and only warns on errors.
      */
     PUBLIC int csoundScoreEventAbsolute(CSOUND *,
             char type, const MYFLT *pfields, long numFields, double time_ofs);
 
+    /**
+     * Send several score events at once, with their times relative to the
+     * current performance time as for csoundScoreEvent().
+     * Events are passed to the performance thread without taking the API
+     * lock when possible, and take effect at the start of the next
+     * control period; errors in events sent this way are reported as
+     * messages when they are inserted.
+     * Returns zero on success.
+     */
+    PUBLIC int csoundScoreEventBatch(CSOUND *,
+            const scoreEvent_t *events, int numEvents);
+
     /**
      * Input a NULL-terminated string (as if from a console),
      * used for line events.
+     * Once performance has started, the text is queued for the
+     * performance thread without taking the API lock, and is parsed at
+     * the start of the next control period.
      */
     PUBLIC void csoundInputMessage(CSOUND *, const char *message);
 
@@ -179,6 +179,19 @@ typedef struct {
     unsigned int     p;
   } CORFIL;
 
+  /* sorted score as binary events, written by swritebin() and read by
+     rdscor() in place of the text of swritestr() */
+  typedef struct SCOREBIN {
+    char    *body;              /* records, see corfile.h */
+    size_t  len, size;          /* bytes used and allocated */
+    size_t  p;                  /* read position */
+    MYFLT   *vals;              /* event being written */
+    char    *strs;
+    int     nvals, valsize, slen, strsize, nstrs;
+    char    opcod;
+    void    *stream;            /* sections still to sort, see scsort.c */
+  } SCOREBIN;
+
   typedef struct {
     int     odebug;
     int     sfread, sfwrite, sfheader, filetyp;
@@ -305,6 +318,9 @@ typedef struct {
     int     instcnt;                /* Count number of instances ever */
     int     isNew;                  /* is this a new definition */
     int     nocheckpcnt;            /* Control checks on pcnt */
+    struct memzone_s *zone;         /* Zone that instances are carved from */
+    void    *free_blocks;           /* Released instance blocks for reuse */
+    size_t  blocksize;              /* Size of each instance block */
   } INSTRTXT;
 
   typedef struct namedInstr {
@@ -513,6 +529,14 @@ typedef struct {
     MYFLT  retval;
     MYFLT  *lclbas;  /* base for variable memory pool */
     char   *strarg;       /* string argument */
+    /* New fields go here, so that the ones above keep their offsets;
+       p0-p3 must stay last, as the remaining p-fields follow them. */
+    struct insds *nxtinit; /* next instance waiting for the init-pass thread */
+    int    init_queued;
+    /* performs one k-cycle of this instance; set by insert() and setksmps */
+    void   (*perfadr)(CSOUND *, struct insds *);
+    /* the perf chain as a NULL-terminated array, in chain order */
+    struct opds **perfops;
     /* Copy of required p-field values for quick access */
     CS_VAR_MEM  p0;
     CS_VAR_MEM  p1;
@@ -708,6 +732,12 @@ typedef struct {
     MYFLT       srate;
   } PVOCEX_MEMFILE;
 
+  /** opaque real FFT plan, see RealFFTSetup() */
+  typedef struct CSOUND_FFT_SETUP_ CSOUND_FFT_SETUP;
+
+#define FFT_FWD   0
+#define FFT_INV   1
+
 #ifdef __BUILDING_LIBCSOUND
 
 #define INSTR   1
@@ -767,6 +797,7 @@ typedef struct {
   typedef struct eventnode {
     struct eventnode  *nxt;
     uint32     start_kcnt;
+    uint64_t   seq;                 /* submission order, breaks ties */
     EVTBLK            evt;
   } EVTNODE;
 
@@ -1270,10 +1301,16 @@ typedef struct NAME__ {
     void (*RewindScore)(CSOUND *);
     void (*InputMessage)(CSOUND *, const char *message__);
        /**@}*/
+    /** @name Planned FFT
+        Taken from the placeholders below; see csoundRealFFTSetup(). */
+    /**@{ */
+    CSOUND_FFT_SETUP *(*RealFFTSetup)(CSOUND *, int FFTsize, int direction);
+    void (*RealFFTExecute)(CSOUND *, CSOUND_FFT_SETUP *setup, MYFLT *buf);
+    /**@}*/
     /** @name Placeholders
         To allow the API to grow while maintining backward binary compatibility. */
     /**@{ */
-    SUBR dummyfn_2[43];
+    SUBR dummyfn_2[41];
     /**@}*/
 #ifdef __BUILDING_LIBCSOUND
     /* ------- private data (not to be used by hosts or externals) ------- */
@@ -1374,6 +1411,7 @@ typedef struct NAME__ {
     void          *csoundCallbacks_;
     FILE*         scfp;
     CORFIL        *scstr;
+    SCOREBIN      *scbin;
     FILE*         oscfp;
     MYFLT         maxamp[MAXCHNLS];
     MYFLT         smaxamp[MAXCHNLS];
@@ -1423,7 +1461,10 @@ typedef struct NAME__ {
     int32         rngcnt[MAXCHNLS];
     int16         rngflg, multichan;
     void          *evtFuncChain;
-    EVTNODE       *OrcTrigEvts;             /* List of events to be started */
+    EVTNODE       **OrcTrigEvts;            /* Heap of events to be started */
+    int           OrcTrigEvtsCnt, OrcTrigEvtsMax;
+    uint64_t      OrcTrigEvtsSeq;
+    void          *evt_queue;               /* Events sent from host threads */
     EVTNODE       *freeEvtNodes;
     int           csoundIsScorePending_;
     int64_t       advanceCnt;
@@ -1443,6 +1484,10 @@ typedef struct NAME__ {
     int64_t       cyclesRemaining;
     EVTBLK        evt;
     void          *memalloc_db;
+    void          *memzone_db;      /* all zones, freed by memRESET() */
+    struct memzone_s *engine_zone;  /* allocations that last until reset */
+    struct memzone_s *compile_zone; /* orchestra compiler temporaries */
+    struct memzone_s *perf_zone;    /* reset by csoundCleanup()       */
     MGLOBAL       *midiGlobals;
     CS_HASH_TABLE *envVarDB;
     MEMFIL        *memfiles;
@@ -1450,6 +1495,7 @@ typedef struct NAME__ {
     int           FFT_max_size;
     void          *FFT_table_1;
     void          *FFT_table_2;
+    void          *FFT_plans;       /* CSOUND_FFT_SETUP list */
     /* statics from twarp.c should be TSEG* */
     void          *tseg, *tpsave, *tplim;
     /* Statics from express.c */
@@ -1462,6 +1508,9 @@ typedef struct NAME__ {
     pthread_t    init_pass_thread;
     int          init_pass_loop;
     void         *init_pass_threadlock;
+    void         *init_pass_signal;    /* wakes the init-pass thread */
+    void         *init_queue_lock;
+    INSDS        *init_queue_head, *init_queue_tail;
     void         *API_lock;
     #if defined(HAVE_PTHREAD_SPIN_LOCK)
     pthread_spinlock_t spoutlock, spinlock;
@@ -1509,6 +1558,12 @@ typedef struct NAME__ {
       int32   repeat_point;
       int     repeat_inc /* = 1 */;
       S_MACRO   *repeat_mm;
+      int     randSeed;               /* seed of ~ in a streamed score     */
+      int     ownSeed;                /*   used in place of randSeed1      */
+#define SCORE_SEED(csound) ((csound)->sreadStatics.ownSeed ?            \
+                            &((csound)->sreadStatics.randSeed) :        \
+                            &((csound)->randSeed1))
+      jmp_buf *errjmp;                /* score errors longjmp here if set  */
     } sreadStatics;
     struct onefileStatics__ {
       NAMELST *toremove;
@@ -1552,6 +1607,8 @@ typedef struct NAME__ {
       uint32        nframes               /* = 1UL */;
       FILE          *pin, *pout;
       int           dither;
+      void          *writer;              /* writer thread, see libsnd.c  */
+      double        hdrtime;              /* real time of last rewrite    */
     } libsndStatics;
 
     int           warped;               /* rdscor.c */
@@ -1574,6 +1631,7 @@ typedef struct NAME__ {
     void          *open_files;          /* fileopen.c */
     void          *searchPathCache;
     CS_HASH_TABLE *sndmemfiles;
+    void          *sndcache;        /* sample cache mappings */
     void          *reset_list;
     void          *pvFileTable;         /* pvfileio.c */
     int           pvNumFiles;
@@ -1642,14 +1700,24 @@ typedef struct NAME__ {
     struct instr_semantics_t *instCurr;
     struct instr_semantics_t *instRoot;
     int           inInstr;
+    CS_HASH_TABLE *globalIds;    /* global name -> dense id (+1) */
+    char          **globalNames; /* dense id -> global name */
+    int           globalCount;
+    int           globalNamesMax;
     int           dag_changed;
     int           dag_num_active;
     INSDS         **dag_task_map;
     volatile enum state    *dag_task_status;
     watchList     * volatile *dag_task_watch;
     watchList     *dag_wlmm;
-    char          **dag_task_dep;
+    int           *dag_task_grp; /* group of each task */
     int           dag_task_max_size;
+    DAG_GROUP     *dag_groups;
+    int           dag_num_groups;
+    int           dag_groups_max;
+    int           *dag_grp_deps; /* dependency lists of all groups */
+    int           dag_grp_deps_max;
+    struct dag_sched_t *dag_sched; /* work-stealing deques, --sched=worksteal */
     uint32_t      tempStatus;    /* keeps track of which files are temps */
     int           orcLineOffset; /* 1 less than 1st orch line in the CSD */
     int           scoLineOffset; /* 1 less than 1st score line in the CSD */
@@ -1676,6 +1744,18 @@ typedef struct NAME__ {
     int (*kperf)(CSOUND *); /* kperf function pointer, to switch between debug
                                and nodebug function */
     int           score_parser;
+    /* Options added since OPARMS was last extended; they are kept here
+       because csoundGetOParms() copies sizeof(OPARMS) into the caller's
+       buffer, which hosts built against older headers allocate. */
+    struct {
+      int     dagScheduler;   /* DAG_SCHED_SCAN or DAG_SCHED_WORKSTEAL */
+      int     prefaultInstances; /* instance blocks to reserve per instr */
+      int     optLevel;       /* orchestra optimisation, 0 = none */
+      char    *sampleCache;   /* decoded sample cache directory, or NULL */
+      int     scoreStream;    /* sort the score a section at a time */
+      double  rewrtInterval;  /* least seconds between header rewrites */
+      int     sfWriterBuffers; /* buffers for a writer thread, 0 = none */
+    } oparmsExt;
     /*struct CSOUND_ **self;*/
     /**@}*/
 #endif  /* __BUILDING_LIBCSOUND */
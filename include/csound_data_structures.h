@@ -28,7 +28,8 @@
 extern "C" {
 #endif
 
-#define HASH_SIZE 4099
+/* initial number of slots in a CS_HASH_TABLE; always a power of two */
+#define HASH_SIZE 16
 
 typedef struct _cons {
     void* value; // should be car, but using value
@@ -36,14 +37,22 @@ typedef struct _cons {
     // linked list conventions
 } CONS_CELL;
 
+/* a slot of the table; key is NULL if the slot is empty */
 typedef struct _cs_hash_bucket_item {
     char* key;
     void* value;
-    struct _cs_hash_bucket_item* next;
+    uint32_t hash;
 } CS_HASH_TABLE_ITEM;
 
+/* open-addressing table with linear probing, grown by doubling when
+   it is three quarters full */
 typedef struct _cs_hash_table {
-    CS_HASH_TABLE_ITEM* buckets[HASH_SIZE];
+    CS_HASH_TABLE_ITEM* items;
+    uint32_t size;      /* number of slots */
+    uint32_t count;     /* number of entries */
+    int interned;       /* keys are compared by pointer, not copied */
+    CONS_CELL* retired; /* slot arrays replaced by growing, freed with
+                           the table as lookups may still be reading them */
 } CS_HASH_TABLE;
 
 /* FUNCTIONS FOR CONS CELL */
@@ -73,6 +82,12 @@ PUBLIC void cs_cons_free_complete(CSOUND* csound, CONS_CELL* head);
 /** Create CS_HASH_TABLE */
 PUBLIC CS_HASH_TABLE* cs_hash_table_create(CSOUND* csound);
 
+/** Create CS_HASH_TABLE for interned keys: keys are neither copied
+    nor freed, and are hashed and compared by pointer, so every key
+    passed to get/put/remove must be the canonical copy of the string
+    (e.g. as returned by cs_hash_table_put_key() on another table). */
+PUBLIC CS_HASH_TABLE* cs_hash_table_create_interned(CSOUND* csound);
+
 /** Retreive void* value for given char* key.  Returns NULL if no
     items founds for key. */
 PUBLIC void* cs_hash_table_get(CSOUND* csound,
@@ -96,8 +111,8 @@ PUBLIC char* cs_hash_table_put_key(CSOUND* csound,
                                    CS_HASH_TABLE* hashTable, char* key);
 
 /** Removes an entry from the hashtable using the given key.  If no
- entry found for key, simply returns. Calls mfree on the table
- item. */
+ entry found for key, simply returns. Calls mfree on the table's
+ copy of the key, unless the table is interned. */
 PUBLIC void cs_hash_table_remove(CSOUND* csound,
                                  CS_HASH_TABLE* hashTable, char* key);
 
@@ -119,6 +119,9 @@ extern "C" {
                                                    const char* name);
     PUBLIC int csoundAddVariable(CSOUND* csound, CS_VAR_POOL* pool,
                                  CS_VARIABLE* var);
+    /* Unlinks var from pool and frees it; returns -1 if not in pool */
+    PUBLIC int csoundRemoveVariable(CSOUND* csound, CS_VAR_POOL* pool,
+                                    CS_VARIABLE* var);
     PUBLIC void recalculateVarPoolMemory(void* csound, CS_VAR_POOL* pool);
     PUBLIC void reallocateVarPoolMemory(void* csound, CS_VAR_POOL* pool);
     PUBLIC void initializeVarPool(MYFLT* memBlock, CS_VAR_POOL* pool);
@@ -27,6 +27,7 @@
 #include "csound.hpp"
 #include "csPerfThread.hpp"
 #include <sndfile.h>
+#include <stdint.h>
 
 // ----------------------------------------------------------------------------
 
@@ -64,12 +65,10 @@ class CsoundPerformanceThreadMessage {
     }
 
  public:
-    CsoundPerformanceThreadMessage *nxt;
     virtual int run() = 0;
     CsoundPerformanceThreadMessage(CsoundPerformanceThread *pt)
     {
       pt_ = pt;
-      nxt = (CsoundPerformanceThreadMessage*) 0;
     }
     virtual ~CsoundPerformanceThreadMessage() {}
 };
@@ -385,6 +384,187 @@ public:
 
 // ----------------------------------------------------------------------------
 
+/**
+ * Message rings.
+ *
+ * Messages are created by the sending thread and passed to the
+ * performance thread on a bounded multi-producer/single-consumer ring
+ * of pointers (a bounded queue after D. Vyukov, as for csoundScoreEvent()
+ * in Top/threadsafe.c: each slot carries a sequence number telling the
+ * producers and the consumer whose turn it is).  Once run, a message is
+ * passed back on a second ring and deleted by the next sender, so the
+ * performance thread does not call the allocator, and only takes a lock
+ * to sleep while paused or to wake a thread in FlushMessageQueue().
+ * At most PT_QUEUE_SIZE messages exist at once (nMessages), so neither
+ * ring can be full when a message is pushed.
+ */
+
+#define PT_QUEUE_SIZE   1024            /* must be a power of two */
+
+typedef struct {
+    volatile uint64_t seq;
+    CsoundPerformanceThreadMessage *msg;
+} PT_SLOT;
+
+typedef struct {
+    volatile uint64_t head;             /* next slot to fill */
+    char        pad1[64 - sizeof(uint64_t)];
+    volatile uint64_t tail;             /* next slot to take */
+    char        pad2[64 - sizeof(uint64_t)];
+    PT_SLOT     slots[PT_QUEUE_SIZE];
+} PT_RING;
+
+#ifdef HAVE_ATOMIC_BUILTIN
+template<typename T> static inline T pt_add(volatile T *x, T n)
+{
+    return __sync_add_and_fetch(x, n);
+}
+template<typename T> static inline bool pt_cas(volatile T *x, T o, T n)
+{
+    return __sync_bool_compare_and_swap(x, o, n);
+}
+static inline void pt_barrier()
+{
+    __sync_synchronize();
+}
+/* earlier loads and stores are seen before *x = v */
+template<typename T> static inline void pt_store(volatile T *x, T v)
+{
+    __atomic_store_n(x, v, __ATOMIC_RELEASE);
+}
+#else
+/* no atomic builtins: the same operations under one mutex */
+static pthread_mutex_t pt_atomic_lock = PTHREAD_MUTEX_INITIALIZER;
+template<typename T> static inline T pt_add(volatile T *x, T n)
+{
+    pthread_mutex_lock(&pt_atomic_lock);
+    T r = (*x += n);
+    pthread_mutex_unlock(&pt_atomic_lock);
+    return r;
+}
+template<typename T> static inline bool pt_cas(volatile T *x, T o, T n)
+{
+    pthread_mutex_lock(&pt_atomic_lock);
+    bool r = (*x == o);
+    if (r)
+      *x = n;
+    pthread_mutex_unlock(&pt_atomic_lock);
+    return r;
+}
+static inline void pt_barrier()
+{
+    pthread_mutex_lock(&pt_atomic_lock);
+    pthread_mutex_unlock(&pt_atomic_lock);
+}
+template<typename T> static inline void pt_store(volatile T *x, T v)
+{
+    pthread_mutex_lock(&pt_atomic_lock);
+    *x = v;
+    pthread_mutex_unlock(&pt_atomic_lock);
+}
+#endif
+
+static PT_RING *pt_ring_create()
+{
+    PT_RING *q = new PT_RING;
+
+    q->head = q->tail = 0;
+    for (int i = 0; i < PT_QUEUE_SIZE; i++) {
+      q->slots[i].seq = (uint64_t) i;
+      q->slots[i].msg = (CsoundPerformanceThreadMessage*) 0;
+    }
+    pt_barrier();
+    return q;
+}
+
+/* returns false if the ring is full; any thread */
+
+static bool pt_ring_push(void *ring, CsoundPerformanceThreadMessage *msg)
+{
+    PT_RING *q = (PT_RING*) ring;
+    PT_SLOT *slot;
+    uint64_t pos = q->head;
+
+    for (;;) {
+      slot = &q->slots[pos & (PT_QUEUE_SIZE - 1)];
+      int64_t dif = (int64_t) (pt_add(&slot->seq, (uint64_t) 0) - pos);
+      if (dif == 0) {
+        if (pt_cas(&q->head, pos, pos + 1))
+          break;
+      }
+      else if (dif < 0)
+        return false;
+      pos = q->head;
+    }
+    slot->msg = msg;
+    pt_store(&slot->seq, pos + 1);
+    return true;
+}
+
+/* returns the oldest message, or NULL if the ring is empty; one thread
+   at a time */
+
+static CsoundPerformanceThreadMessage *pt_ring_pop(void *ring)
+{
+    PT_RING *q = (PT_RING*) ring;
+    uint64_t pos = q->tail;
+    PT_SLOT *slot = &q->slots[pos & (PT_QUEUE_SIZE - 1)];
+    CsoundPerformanceThreadMessage *msg;
+
+    if (pt_add(&slot->seq, (uint64_t) 0) != pos + 1)
+      return (CsoundPerformanceThreadMessage*) 0;
+    msg = slot->msg;
+    pt_store(&slot->seq, pos + PT_QUEUE_SIZE);
+    q->tail = pos + 1;
+    return msg;
+}
+
+static bool pt_ring_empty(void *ring)
+{
+    PT_RING *q = (PT_RING*) ring;
+    PT_SLOT *slot = &q->slots[q->tail & (PT_QUEUE_SIZE - 1)];
+
+    return (pt_add(&slot->seq, (uint64_t) 0) != q->tail + 1);
+}
+
+/**
+ * Passes a message that has been run (or dropped) back to the senders;
+ * called by the performance thread.
+ */
+
+void CsoundPerformanceThread::RetireMessage(CsoundPerformanceThreadMessage *msg)
+{
+    if (!pt_ring_push(msgRetired, msg)) {
+      delete msg;                       // cannot happen, see nMessages
+      pt_add(&nMessages, -1L);
+    }
+    pt_add(&nProcessed, 1UL);
+}
+
+/**
+ * Deletes the messages passed back by the performance thread, and
+ * returns their number.  Only one thread reclaims at a time; others
+ * return 0 at once.
+ */
+
+int CsoundPerformanceThread::ReclaimMessages()
+{
+    CsoundPerformanceThreadMessage *msg;
+    int     n = 0;
+
+    if (!msgRetired || !pt_cas(&reclaiming, 0, 1))
+      return 0;
+    while ((msg = pt_ring_pop(msgRetired)) != 0) {
+      delete msg;
+      n++;
+    }
+    pt_add(&nMessages, (long) -n);
+    pt_store(&reclaiming, 0);
+    return n;
+}
+
+// ----------------------------------------------------------------------------
+
 /**
  * Performs the score until end of score, error, or receiving a stop event.
  * Returns a negative value on error.
@@ -394,36 +574,26 @@ int CsoundPerformanceThread::Perform()
 {
     int retval = 0;
     do {
-      while (firstMessage) {
-        csoundLockMutex(queueLock);
-        do {
-          CsoundPerformanceThreadMessage *msg;
-          // get oldest message
-          msg = (CsoundPerformanceThreadMessage*) firstMessage;
-          if (!msg)
-            break;
-          // unlink from FIFO
-          firstMessage = msg->nxt;
-          if (!msg->nxt)
-            lastMessage = (CsoundPerformanceThreadMessage*) 0;
-          // process and destroy message
-          retval = msg->run();
-          delete msg; // TODO: This should be moved out of the Perform function
-        } while (!retval);
-        if (paused)
-          csoundWaitThreadLock(pauseLock, (size_t) 0);
-        // mark queue as empty
-        csoundNotifyThreadLock(flushLock);
-        csoundUnlockMutex(queueLock);
+      CsoundPerformanceThreadMessage *msg;
+      // run the queued messages in order
+      while ((msg = pt_ring_pop(msgQueue)) != 0) {
+        retval = msg->run();
+        RetireMessage(msg);
         // if error or end of score, return now
         if (retval)
           goto endOfPerf;
-        // if paused, wait until a new message is received, then loop back
-        if (!paused)
-          break;
-        // VL: if this is paused, then it will double lock.
-        csoundWaitThreadLockNoTimeout(pauseLock);
-        csoundNotifyThreadLock(pauseLock);
+      }
+      // wake up FlushMessageQueue()
+      if (pt_add(&flushWaiters, 0L) > 0)
+        csoundNotifyThreadLock(flushLock);
+      // if paused, wait until a new message is received, then loop back;
+      // a wakeup left from an earlier message is cleared first, and the
+      // queue checked again, so that none is missed
+      if (paused) {
+        csoundWaitThreadLock(pauseLock, (size_t) 0);
+        if (pt_ring_empty(msgQueue))
+          csoundWaitThreadLockNoTimeout(pauseLock);
+        continue;
       }
       if(processcallback != NULL)
            processcallback(cdata);
@@ -449,21 +619,13 @@ int CsoundPerformanceThread::Perform()
  endOfPerf:
     status = retval;
     csoundCleanup(csound);
-    // delete any pending messages
-    csoundLockMutex(queueLock);
+    // drop any pending messages
     {
       CsoundPerformanceThreadMessage *msg;
-      msg = (CsoundPerformanceThreadMessage*) firstMessage;
-      firstMessage = (CsoundPerformanceThreadMessage*) 0;
-      lastMessage = (CsoundPerformanceThreadMessage*) 0;
-      while (msg) {
-        CsoundPerformanceThreadMessage *nxt = msg->nxt;
-        delete msg;
-        msg = nxt;
-      }
+      while ((msg = pt_ring_pop(msgQueue)) != 0)
+        RetireMessage(msg);
     }
     csoundNotifyThreadLock(flushLock);
-    csoundUnlockMutex(queueLock);
     running = 1;
     return retval;
 }
@@ -499,9 +661,12 @@ extern "C" {
 void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
 {
     csound = csound_;
-    firstMessage = (CsoundPerformanceThreadMessage*) 0;
-    lastMessage = (CsoundPerformanceThreadMessage*) 0;
-    queueLock = (void*) 0;
+    msgQueue = (void*) 0;
+    msgRetired = (void*) 0;
+    nMessages = 0;
+    nQueued = nProcessed = 0;
+    flushWaiters = 0;
+    pt_store(&reclaiming, 0);
     pauseLock = (void*) 0;
     flushLock = (void*) 0;
     recordLock = (void *) 0;
@@ -511,9 +676,6 @@ void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
     cdata = 0;
     processcallback = 0;
     running = 0;
-    queueLock = csoundCreateMutex(0);
-    if (!queueLock)
-      return;
     pauseLock = csoundCreateThreadLock();
     if (!pauseLock)
       return;
@@ -524,12 +686,15 @@ void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
     if (!recordLock)
       return;
     try {
-      lastMessage = new CsPerfThreadMsg_Pause(this);
+      msgQueue = (void*) pt_ring_create();
+      msgRetired = (void*) pt_ring_create();
+      pt_ring_push(msgQueue, new CsPerfThreadMsg_Pause(this));
     }
     catch (std::bad_alloc&) {
       return;
     }
-    firstMessage = lastMessage;
+    nMessages = 1;
+    nQueued = 1;
     recordData.cbuf = NULL;
     recordData.sfile = NULL;
     recordData.thread = NULL;
@@ -585,18 +750,24 @@ void CsoundPerformanceThread::QueueMessage(CsoundPerformanceThreadMessage *msg)
       delete msg;
       return;
     }
-    csoundLockMutex(queueLock);
-    // link message into FIFO
-    if (!lastMessage)
-      firstMessage = msg;
-    else
-      lastMessage->nxt = msg;
-    lastMessage = msg;
-    // mark queue as non-empty
-    csoundWaitThreadLock(flushLock, (size_t) 0);
+    // every message is queued, being run, or waiting to be deleted;
+    // keeping their number within the ring size keeps both rings from
+    // filling up
+    while (pt_add(&nMessages, 1L) > (long) PT_QUEUE_SIZE) {
+      pt_add(&nMessages, -1L);
+      if (!ReclaimMessages()) {
+        if (status) {
+          delete msg;
+          return;
+        }
+        csoundSleep(1);
+      }
+    }
+    ReclaimMessages();
+    pt_ring_push(msgQueue, msg);
+    pt_add(&nQueued, 1UL);
     // wake up from pause
     csoundNotifyThreadLock(pauseLock);
-    csoundUnlockMutex(queueLock);
 }
 
 void CsoundPerformanceThread::Play()
@@ -660,23 +831,22 @@ int CsoundPerformanceThread::Join()
       perfThread = (void*) 0;
     }
 
-    // delete any pending messages
-    {
+    // delete any pending messages, and the rings
+    if (msgQueue) {
       CsoundPerformanceThreadMessage *msg;
-      msg = (CsoundPerformanceThreadMessage*) firstMessage;
-      firstMessage = (CsoundPerformanceThreadMessage*) 0;
-      lastMessage = (CsoundPerformanceThreadMessage*) 0;
-      while (msg) {
-        CsoundPerformanceThreadMessage *nxt = msg->nxt;
+      while ((msg = pt_ring_pop(msgQueue)) != 0) {
         delete msg;
-        msg = nxt;
+        pt_add(&nMessages, -1L);
       }
+      ReclaimMessages();
+      delete (PT_RING*) msgQueue;
+      msgQueue = (void*) 0;
     }
-    // delete all thread locks
-    if (queueLock) {
-      csoundDestroyMutex(queueLock);
-      queueLock = (void*) 0;
+    if (msgRetired) {
+      delete (PT_RING*) msgRetired;
+      msgRetired = (void*) 0;
     }
+    // delete all thread locks
     if (pauseLock) {
       csoundNotifyThreadLock(pauseLock);
       csoundDestroyThreadLock(pauseLock);
@@ -698,8 +868,23 @@ int CsoundPerformanceThread::Join()
 
 void CsoundPerformanceThread::FlushMessageQueue()
 {
-    if (firstMessage) {
-      csoundWaitThreadLockNoTimeout(flushLock);
-      csoundNotifyThreadLock(flushLock);
+    unsigned long n;
+
+    if (!perfThread || !flushLock)
+      return;
+    n = pt_add(&nQueued, 0UL);
+    if ((long) (pt_add(&nProcessed, 0UL) - n) < 0) {
+      pt_add(&flushWaiters, 1L);
+      for (;;) {
+        // clear an old wakeup before checking, as in Perform()
+        csoundWaitThreadLock(flushLock, (size_t) 0);
+        if ((long) (pt_add(&nProcessed, 0UL) - n) >= 0 || status)
+          break;
+        csoundWaitThreadLockNoTimeout(flushLock);
+      }
+      // pass the wakeup on to any other thread waiting here
+      if (pt_add(&flushWaiters, -1L) > 0)
+        csoundNotifyThreadLock(flushLock);
     }
+    ReclaimMessages();
 }
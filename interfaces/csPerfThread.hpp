@@ -102,9 +102,12 @@ typedef struct {
 class PUBLIC CsoundPerformanceThread {
  private:
     CSOUND  *csound;
-    volatile CsoundPerformanceThreadMessage *firstMessage;
-    CsoundPerformanceThreadMessage *lastMessage;
-    void    *queueLock;         // this is actually a mutex
+    void    *msgQueue;          // ring of messages to the perf. thread
+    void    *msgRetired;        // ring of messages run, to be deleted
+    volatile long nMessages;    // messages not deleted yet
+    volatile unsigned long nQueued, nProcessed;
+    volatile long flushWaiters;
+    volatile int  reclaiming;
     void    *pauseLock;
     void    *flushLock;
     void    *recordLock;
@@ -118,6 +121,8 @@ class PUBLIC CsoundPerformanceThread {
     int  Perform();
     void csPerfThread_constructor(CSOUND *);
     void QueueMessage(CsoundPerformanceThreadMessage *);
+    void RetireMessage(CsoundPerformanceThreadMessage *);
+    int  ReclaimMessages();
  public:
 #ifdef SWIGPYTHON
   PyThreadState *_tstate;
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <CUnit/Basic.h>
+#include "csoundCore.h"
+#include "aops_simd.h"
+
+#define BENCH_KSMPS 64
+#define BENCH_BLOCKS 200000
+
+static MYFLT a[BENCH_KSMPS + 8], b[BENCH_KSMPS + 8];
+
+static const char *op_names[AOPS_NOPS] = { "add", "sub", "mul", "div" };
+
+int init_suite1(void)
+{
+    int i;
+
+    srand(4321);
+    for (i = 0; i < BENCH_KSMPS + 8; i++) {
+      a[i] = (MYFLT) (rand() - RAND_MAX / 2) / (MYFLT) 1000.25;
+      b[i] = (MYFLT) (rand() % 20001 - 10000) / (MYFLT) 77.5 + FL(0.5);
+    }
+    a[3] = FL(-0.5);
+    a[4] = (MYFLT) 1.0e30;
+    a[5] = (MYFLT) INFINITY;
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+/* every table must give the scalar results, at any length and alignment */
+void test_kernels_match_scalar(void)
+{
+    const AOPS_KERNELS *s = aops_simd_table(0), *k;
+    MYFLT   r0[BENCH_KSMPS + 8], r1[BENCH_KSMPS + 8];
+    int     t, op;
+    uint32_t n;
+
+    CU_ASSERT_PTR_NOT_NULL(s);
+    CU_ASSERT_PTR_NOT_NULL(aops_kernels);
+    for (t = 1; (k = aops_simd_table(t)) != NULL; t++) {
+      for (n = 0; n <= BENCH_KSMPS; n++) {
+        for (op = 0; op < AOPS_NOPS; op++) {
+          s->vv[op](r0, a + 1, b + 3, n);
+          k->vv[op](r1, a + 1, b + 3, n);
+          CU_ASSERT(memcmp(r0, r1, n * sizeof(MYFLT)) == 0);
+          s->sv[op](r0, a[7], b + 3, n);
+          k->sv[op](r1, a[7], b + 3, n);
+          CU_ASSERT(memcmp(r0, r1, n * sizeof(MYFLT)) == 0);
+          s->vs[op](r0, a + 1, b[2], n);
+          k->vs[op](r1, a + 1, b[2], n);
+          CU_ASSERT(memcmp(r0, r1, n * sizeof(MYFLT)) == 0);
+        }
+        s->trunc(r0, a + 1, n);
+        k->trunc(r1, a + 1, n);
+        CU_ASSERT(memcmp(r0, r1, n * sizeof(MYFLT)) == 0);
+        /* output is one of the inputs, as in a1 = a1 + a2 */
+        memcpy(r1, a, sizeof(r1));
+        s->vv[AOPS_MUL](r0, a, b, n);
+        k->vv[AOPS_MUL](r1, r1, b, n);
+        CU_ASSERT(memcmp(r0, r1, n * sizeof(MYFLT)) == 0);
+      }
+    }
+}
+
+/* the peak kernel gives the scalar peaks, frames and counts for any
+   number of channels, starting from earlier peaks */
+void test_peak_matches_scalar(void)
+{
+    const AOPS_KERNELS *s = aops_simd_table(0), *k;
+    MYFLT   m0[40], p0[40], o0[40], m1[40], p1[40], o1[40];
+    MYFLT   x[40 * 16];
+    uint32_t nchnls, i;
+    int     t;
+
+    for (i = 0; i < 40 * 16; i++)
+      x[i] = a[i % (BENCH_KSMPS + 8)] * (MYFLT) ((i % 5) + 1) / FL(64.0);
+    x[7] = (MYFLT) -INFINITY;
+    x[9] = (MYFLT) NAN;
+    x[11] = FL(-0.0);
+    for (t = 1; (k = aops_simd_table(t)) != NULL; t++) {
+      for (nchnls = 1; nchnls <= 40; nchnls++) {
+        for (i = 0; i < nchnls; i++) {
+          m0[i] = m1[i] = (i & 1) ? FL(0.0) : FL(0.25);
+          p0[i] = p1[i] = FL(-1.0);
+          o0[i] = o1[i] = FL(0.0);
+        }
+        s->peak(m0, p0, o0, x, nchnls, 16, FL(1.0));
+        k->peak(m1, p1, o1, x, nchnls, 16, FL(1.0));
+        CU_ASSERT(memcmp(m0, m1, nchnls * sizeof(MYFLT)) == 0);
+        CU_ASSERT(memcmp(p0, p1, nchnls * sizeof(MYFLT)) == 0);
+        CU_ASSERT(memcmp(o0, o1, nchnls * sizeof(MYFLT)) == 0);
+      }
+    }
+}
+
+/* the dither loops of libsnd.c before aops_dither_add(), one sample at
+   a time */
+static void dither_ref(MYFLT *buf, int m, int tpdf, MYFLT scale, int *seed)
+{
+    int     n;
+
+    for (n = 0; n < m; n++) {
+      int   tmp = ((*seed * 15625) + 1) & 0xFFFF, rnd = tmp;
+      MYFLT result;
+      if (tpdf) {
+        rnd = ((tmp * 15625) + 1) & 0xFFFF;
+        *seed = rnd;
+        rnd = (rnd + tmp) >> 1;           /* triangular distribution */
+      }
+      else *seed = rnd;
+      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
+      result /= scale;
+      buf[n] += result;
+    }
+}
+
+/* aops_dither_add() with each table adds the noise of the scalar loops,
+   for both noise types and both scales, over runs of buffers whose
+   lengths are not multiples of the 8 lanes or the 512 sample block */
+void test_dither_matches_scalar(void)
+{
+    static const int len[] = { 1, 7, 8, 9, 15, 100, 511, 512, 513, 1029 };
+    static MYFLT r0[1029], r1[1029];
+    const AOPS_KERNELS *selected = aops_kernels, *k;
+    MYFLT   scale;
+    int     t, tpdf, i, j, seed0, seed1;
+
+    for (t = 0; (k = aops_simd_table(t)) != NULL; t++) {
+      aops_kernels = k;
+      for (tpdf = 0; tpdf <= 1; tpdf++) {
+        for (scale = (MYFLT) 0x7f; scale <= (MYFLT) 0x7fff;
+             scale = scale * 256 + 255) {
+          seed0 = seed1 = 12345;
+          for (i = 0; i < (int) (sizeof(len) / sizeof(len[0])); i++) {
+            for (j = 0; j < len[i]; j++)
+              r0[j] = r1[j] = a[j % (BENCH_KSMPS + 8)] / FL(1000.0);
+            dither_ref(r0, len[i], tpdf, scale, &seed0);
+            aops_dither_add(r1, (uint32_t) len[i], tpdf, scale, &seed1);
+            CU_ASSERT(memcmp(r0, r1, len[i] * sizeof(MYFLT)) == 0);
+            CU_ASSERT_EQUAL(seed0, seed1);
+          }
+        }
+      }
+    }
+    aops_kernels = selected;
+}
+
+static double ns_per_sample(clock_t t0, clock_t t1)
+{
+    return (double) (t1 - t0) * 1.0e9 / CLOCKS_PER_SEC
+      / ((double) BENCH_BLOCKS * BENCH_KSMPS);
+}
+
+/* report ns/sample of each opcode's kernel at ksmps = 64 */
+void test_benchmark_kernels(void)
+{
+    const AOPS_KERNELS *k;
+    MYFLT   r[BENCH_KSMPS];
+    clock_t t0, t1;
+    int     t, op, i;
+
+    printf("\n%-8s %-6s %8s %8s %8s\n", "isa", "op", "aa", "ka", "ak");
+    for (t = 0; (k = aops_simd_table(t)) != NULL; t++) {
+      for (op = 0; op < AOPS_NOPS; op++) {
+        double vv, sv, vs;
+        t0 = clock();
+        for (i = 0; i < BENCH_BLOCKS; i++)
+          k->vv[op](r, a, b, BENCH_KSMPS);
+        t1 = clock();
+        vv = ns_per_sample(t0, t1);
+        t0 = clock();
+        for (i = 0; i < BENCH_BLOCKS; i++)
+          k->sv[op](r, a[i & 7], b, BENCH_KSMPS);
+        t1 = clock();
+        sv = ns_per_sample(t0, t1);
+        t0 = clock();
+        for (i = 0; i < BENCH_BLOCKS; i++)
+          k->vs[op](r, a, b[i & 7], BENCH_KSMPS);
+        t1 = clock();
+        vs = ns_per_sample(t0, t1);
+        printf("%-8s %-6s %8.3f %8.3f %8.3f\n", k->name, op_names[op],
+               vv, sv, vs);
+      }
+      t0 = clock();
+      for (i = 0; i < BENCH_BLOCKS; i++)
+        k->trunc(r, a, BENCH_KSMPS);
+      t1 = clock();
+      printf("%-8s %-6s %8.3f\n", k->name, "int", ns_per_sample(t0, t1));
+    }
+    printf("selected: %s\n", aops_kernels->name);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("A-rate SIMD kernel tests",
+                          init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Kernels match scalar",
+                             test_kernels_match_scalar))
+        || (NULL == CU_add_test(pSuite, "Peak kernel matches scalar",
+                                test_peak_matches_scalar))
+        || (NULL == CU_add_test(pSuite, "Dither matches scalar",
+                                test_dither_matches_scalar))
+        /* timing only: run it with CSOUND_BENCHMARK set */
+        || (getenv("CSOUND_BENCHMARK") != NULL &&
+            NULL == CU_add_test(pSuite, "Benchmark kernels",
+                                test_benchmark_kernels))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -356,6 +356,58 @@ void test_string_channel(void)
     csoundDestroy(csound);
 }
 
+const char orc7[] = "chn_k \"in\", 1\n"
+        "chn_k \"out\", 2\n"
+        "instr 1\n"
+        "kval chnget \"in\"\n"
+        "chnset kval*2, \"out\"\n"
+        "endin\n";
+
+void test_channel_handles(void)
+{
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=null");
+    csoundCompileOrc(csound, orc7);
+    int err = csoundStart(csound);
+    CU_ASSERT(err == CSOUND_SUCCESS);
+
+    CSOUND_CHANNEL_HANDLE h[3];
+    MYFLT vals[3] = { 3.0, 4.0, 5.0 };
+    h[0] = csoundGetChannelHandle(csound, "in",
+                                  CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
+    h[1] = csoundGetChannelHandle(csound, "extra",
+                                  CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
+    h[2] = csoundGetChannelHandle(csound, "out",
+                                  CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+    CU_ASSERT_PTR_NOT_NULL(h[0]);
+    CU_ASSERT_PTR_NOT_NULL(h[1]);
+    CU_ASSERT_PTR_NOT_NULL(h[2]);
+    CU_ASSERT_PTR_NULL(csoundGetChannelHandle(csound, "in",
+                                              CSOUND_AUDIO_CHANNEL |
+                                              CSOUND_INPUT_CHANNEL));
+    CU_ASSERT(csoundSetControlChannels(csound, h, vals, 2) == CSOUND_SUCCESS);
+    CU_ASSERT_EQUAL(4.0, csoundGetControlChannel(csound, "extra", NULL));
+
+    MYFLT pFields[] = {1.0, 0.0, 1.0};
+    err = csoundScoreEvent(csound, 'i', pFields, 3);
+    err = csoundPerformKsmps(csound);
+    CU_ASSERT(err == CSOUND_SUCCESS);
+    CU_ASSERT(csoundGetControlChannels(csound, h, vals, 3) == CSOUND_SUCCESS);
+    CU_ASSERT_EQUAL(3.0, vals[0]);
+    CU_ASSERT_EQUAL(4.0, vals[1]);
+    CU_ASSERT_EQUAL(6.0, vals[2]);
+
+    h[1] = NULL;
+    CU_ASSERT(csoundGetControlChannels(csound, h, vals, 3) == CSOUND_ERROR);
+    CU_ASSERT_EQUAL(0.0, vals[1]);
+
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
 
 int main()
 {
@@ -382,6 +434,7 @@ int main()
            || (NULL == CU_add_test(pSuite, "Invalid channels", test_invalid_channel))
            || (NULL == CU_add_test(pSuite, "Channel hints", test_chn_hints))
            || (NULL == CU_add_test(pSuite, "String channel", test_string_channel))
+           || (NULL == CU_add_test(pSuite, "Channel handles", test_channel_handles))
        )
    {
       CU_cleanup_registry();
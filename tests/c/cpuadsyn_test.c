@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <CUnit/Basic.h>
+#include "csoundCore.h"
+#include "cpuadsyn.h"
+
+#define TEST_BINS   1000
+#define TEST_VSAMPS 256
+#define TEST_HOPS   16
+#define TEST_SR     44100.0f
+#define BENCH_HOPS  200
+
+#define NPARTS ((TEST_BINS + CPUADSYN_LANES - 1) & ~(CPUADSYN_LANES - 1))
+
+static float frames[TEST_HOPS][2 * TEST_BINS];
+
+int init_suite1(void)
+{
+    int i, h;
+
+    srand(2718);
+    for (i = 0; i < TEST_HOPS; i++)
+      for (h = 0; h < TEST_BINS; h++) {
+        frames[i][2*h] = (float) (rand() % 1000) / 1000.0f / TEST_BINS;
+        /* bin centre plus some deviation, a few negative */
+        frames[i][2*h+1] = h * TEST_SR / 2048.0f
+          + (float) (rand() % 2001 - 1000) / 50.0f;
+      }
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+/* one hop of the cladsynth "sample" and "update" kernels, with the
+   sine computed exactly.  "update" recomputes the increment with the
+   factors in another order, which can round differently and make the
+   phase jump at the hop; like the commented-out update in cudasynth's
+   "sample", the reference advances by the increment it synthesised. */
+static void gpu_reference(double *out, int64_t *ph, float *amps,
+                          const float *frame, float pitch)
+{
+    float fscal = pitch * CPUADSYN_FMAXLEN / TEST_SR;
+    int   h, n;
+
+    memset(out, 0, TEST_VSAMPS * sizeof(double));
+    for (h = 0; h < TEST_BINS; h++) {
+      int k = h << 1;
+      int64_t d = (int64_t) roundf(frame[k+1] * fscal);
+      for (n = 0; n < TEST_VSAMPS; n++) {
+        int64_t lph = (ph[h] + n * d) & CPUADSYN_PHMASK;
+        float   a = amps[h], ascl = ((float) n) / TEST_VSAMPS;
+        a += ascl * (frame[k] - a);
+        out[n] += a * sin(TWOPI * lph / CPUADSYN_FMAXLEN);
+      }
+      ph[h] = (ph[h] + TEST_VSAMPS * d) & CPUADSYN_PHMASK;
+      amps[h] = frame[k];
+    }
+}
+
+static CPUADSYN_BANK *new_bank(void)
+{
+    CPUADSYN_BANK *b = (CPUADSYN_BANK *) calloc(1, sizeof(CPUADSYN_BANK));
+    b->ph = (uint32_t *) calloc(NPARTS, sizeof(uint32_t));
+    b->incr = (uint32_t *) calloc(NPARTS, sizeof(uint32_t));
+    b->amp = (float *) calloc(NPARTS, sizeof(float));
+    b->amp1 = (float *) calloc(NPARTS, sizeof(float));
+    return b;
+}
+
+static void free_bank(CPUADSYN_BANK *b)
+{
+    free(b->ph); free(b->incr); free(b->amp); free(b->amp1);
+    free(b);
+}
+
+/* every kernel must follow the GPU reference over a run of frames */
+void test_kernels_match_gpu(void)
+{
+    static float  tab[CPUADSYN_TABLEN + 1];
+    static float  out[TEST_VSAMPS], acc[TEST_VSAMPS * CPUADSYN_LANES];
+    static double ref[TEST_VSAMPS];
+    const CPUADSYN_KERNEL *k;
+    int   t, i, n;
+
+    cpuadsyn_table(tab);
+    for (t = 0; (k = cpuadsyn_kernel(t)) != NULL; t++) {
+      CPUADSYN_BANK *b = new_bank();
+      int64_t ph[TEST_BINS];
+      float   amps[TEST_BINS];
+      double  maxerr = 0.0;
+      memset(ph, 0, sizeof(ph));
+      memset(amps, 0, sizeof(amps));
+      for (i = 0; i < TEST_HOPS; i++) {
+        float pitch = i < TEST_HOPS / 2 ? 1.0f : 0.75f;
+        float fscal = pitch * CPUADSYN_FMAXLEN / TEST_SR;
+        gpu_reference(ref, ph, amps, frames[i], pitch);
+        cpuadsyn_load(b, frames[i], TEST_BINS, fscal, 0, NPARTS);
+        k->render(out, acc, b, tab, 0, NPARTS, TEST_VSAMPS);
+        cpuadsyn_advance(b, 0, NPARTS, TEST_VSAMPS);
+        for (n = 0; n < TEST_VSAMPS; n++)
+          if (fabs(out[n] - ref[n]) > maxerr) maxerr = fabs(out[n] - ref[n]);
+      }
+      /* the sum of amplitudes is about 0.5 */
+      printf("\n%s: max error %g\n", k->name, maxerr);
+      CU_ASSERT(maxerr < 1.0e-5);
+      /* phases are bit-identical to the GPU ones */
+      for (i = 0; i < TEST_BINS; i++)
+        CU_ASSERT_EQUAL(b->ph[i], (uint32_t) ph[i]);
+      free_bank(b);
+    }
+}
+
+/* report ns per partial-sample of each kernel */
+void test_benchmark_kernels(void)
+{
+    static float tab[CPUADSYN_TABLEN + 1];
+    static float out[TEST_VSAMPS], acc[TEST_VSAMPS * CPUADSYN_LANES];
+    const CPUADSYN_KERNEL *k;
+    clock_t t0, t1;
+    int     t, i;
+
+    cpuadsyn_table(tab);
+    for (t = 0; (k = cpuadsyn_kernel(t)) != NULL; t++) {
+      CPUADSYN_BANK *b = new_bank();
+      cpuadsyn_load(b, frames[0], TEST_BINS, CPUADSYN_FMAXLEN / TEST_SR,
+                    0, NPARTS);
+      cpuadsyn_advance(b, 0, NPARTS, TEST_VSAMPS);
+      t0 = clock();
+      for (i = 0; i < BENCH_HOPS; i++)
+        k->render(out, acc, b, tab, 0, NPARTS, TEST_VSAMPS);
+      t1 = clock();
+      printf("\n%s: %.3f ns/partial-sample\n", k->name,
+             (double) (t1 - t0) * 1.0e9 / CLOCKS_PER_SEC
+             / ((double) BENCH_HOPS * TEST_VSAMPS * TEST_BINS));
+      free_bank(b);
+    }
+}
+
+const char orc1[] =
+  "ksmps = 64\n"
+  "nchnls = 2\n"
+  "0dbfs = 1\n"
+  "  instr 1\n"
+  "asrc = oscili(0.3, 220) + oscili(0.2, 1330)\n"
+  "fs pvsanal asrc, 2048, 256, 2048, 1\n"
+  "a1 cpuadsynth fs, 1, 1, 0, 1\n"
+  "a2 cpuadsynth fs, 1, 1, 0, 4\n"
+  "  outs a1, a2\n"
+  "  endin\n";
+
+/* a bank split across worker threads gives the single-thread output */
+void test_worker_pool(void)
+{
+    CSOUND *csound;
+    MYFLT  *spout, maxdiff = 0, peak = 0;
+    int    i, n, nsmps;
+
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "--logfile=null");
+    CU_ASSERT(csoundCompileOrc(csound, orc1) == 0);
+    csoundReadScore(csound, "i1 0 1\n");
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+    nsmps = csoundGetKsmps(csound);
+    spout = csoundGetSpout(csound);
+    for (i = 0; i < 500; i++) {
+      csoundPerformKsmps(csound);
+      for (n = 0; n < nsmps; n++) {
+        MYFLT d = FABS(spout[2*n] - spout[2*n+1]);
+        if (d > maxdiff) maxdiff = d;
+        if (FABS(spout[2*n]) > peak) peak = FABS(spout[2*n]);
+      }
+    }
+    CU_ASSERT(peak > FL(0.1));
+    CU_ASSERT(maxdiff < FL(1.0e-5));
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("CPU additive synthesis tests",
+                          init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Kernels match GPU reference",
+                             test_kernels_match_gpu))
+        /* timing only: run it with CSOUND_BENCHMARK set */
+        || (getenv("CSOUND_BENCHMARK") != NULL &&
+            NULL == CU_add_test(pSuite, "Benchmark kernels",
+                                test_benchmark_kernels))
+        || (NULL == CU_add_test(pSuite, "Worker pool", test_worker_pool))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -10,6 +10,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include "csoundCore.h"
 #include "CUnit/Basic.h"
 
@@ -147,6 +148,143 @@ void test_cs_hash_table_get_put_key(void) {
     csoundDestroy(csound);
 }
 
+void test_cs_hash_table_interned(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    CS_HASH_TABLE* strings = cs_hash_table_create(csound);
+    CS_HASH_TABLE* hashTable = cs_hash_table_create_interned(csound);
+    char *a = cs_hash_table_put_key(csound, strings, "alpha");
+    char *b = cs_hash_table_put_key(csound, strings, "beta");
+    char key[] = "alpha";
+
+    cs_hash_table_put(csound, hashTable, a, "1");
+    cs_hash_table_put(csound, hashTable, b, "2");
+
+    CU_ASSERT_PTR_EQUAL(cs_hash_table_get_key(csound, hashTable, a), a);
+    CU_ASSERT_STRING_EQUAL((char*)cs_hash_table_get(csound, hashTable, a), "1");
+    CU_ASSERT_STRING_EQUAL((char*)cs_hash_table_get(csound, hashTable, b), "2");
+    /* keys compare by pointer: an equal string is a different key */
+    CU_ASSERT_PTR_NULL(cs_hash_table_get(csound, hashTable, key));
+
+    cs_hash_table_remove(csound, hashTable, a);
+    CU_ASSERT_PTR_NULL(cs_hash_table_get(csound, hashTable, a));
+    CU_ASSERT_STRING_EQUAL(a, "alpha");
+
+    cs_hash_table_free(csound, hashTable);
+    cs_hash_table_free(csound, strings);
+    csoundDestroy(csound);
+}
+
+#define BENCH_KEYS 100000
+
+/* grows the table from empty to BENCH_KEYS entries, looks every key up,
+   then removes half of them and checks the rest are still found */
+void test_cs_hash_table_grow(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    CS_HASH_TABLE* hashTable = cs_hash_table_create(csound);
+    char buf[32];
+    int i, missing = 0;
+
+    for (i = 0; i < BENCH_KEYS; i++) {
+        sprintf(buf, "opcode_%d", i);
+        cs_hash_table_put(csound, hashTable, buf, (void*)(intptr_t)(i + 1));
+    }
+    for (i = 0; i < BENCH_KEYS; i++) {
+        sprintf(buf, "opcode_%d", i);
+        if (cs_hash_table_get(csound, hashTable, buf) != (void*)(intptr_t)(i + 1))
+            missing++;
+    }
+    CU_ASSERT_EQUAL(missing, 0);
+    CU_ASSERT_EQUAL(hashTable->count, BENCH_KEYS);
+
+    for (i = 0; i < BENCH_KEYS; i += 2) {
+        sprintf(buf, "opcode_%d", i);
+        cs_hash_table_remove(csound, hashTable, buf);
+    }
+    for (i = 0; i < BENCH_KEYS; i++) {
+        void* value;
+        sprintf(buf, "opcode_%d", i);
+        value = cs_hash_table_get(csound, hashTable, buf);
+        if (i & 1 ? value != (void*)(intptr_t)(i + 1) : value != NULL)
+            missing++;
+    }
+    CU_ASSERT_EQUAL(missing, 0);
+    CU_ASSERT_EQUAL(hashTable->count, BENCH_KEYS / 2);
+    cs_hash_table_free(csound, hashTable);
+    csoundDestroy(csound);
+}
+
+/* timing only: prints the insert and lookup times for BENCH_KEYS keys */
+void test_cs_hash_table_benchmark(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    CS_HASH_TABLE* hashTable = cs_hash_table_create(csound);
+    char buf[32];
+    clock_t t0, t1, t2;
+    int i;
+
+    t0 = clock();
+    for (i = 0; i < BENCH_KEYS; i++) {
+        sprintf(buf, "opcode_%d", i);
+        cs_hash_table_put(csound, hashTable, buf, (void*)(intptr_t)(i + 1));
+    }
+    t1 = clock();
+    for (i = 0; i < BENCH_KEYS; i++) {
+        sprintf(buf, "opcode_%d", i);
+        cs_hash_table_get(csound, hashTable, buf);
+    }
+    t2 = clock();
+    printf("\n%d keys: insert %.3f s, lookup %.3f s\n", BENCH_KEYS,
+           (double) (t1 - t0) / CLOCKS_PER_SEC,
+           (double) (t2 - t1) / CLOCKS_PER_SEC);
+    cs_hash_table_free(csound, hashTable);
+    csoundDestroy(csound);
+}
+
+typedef struct {
+    CSOUND* csound;
+    CS_HASH_TABLE* hashTable;
+    volatile int done;
+    int missing;
+} READER_ARGS;
+
+static uintptr_t hash_table_reader(void* data) {
+    READER_ARGS* args = (READER_ARGS*) data;
+
+    while (!args->done) {
+        if (cs_hash_table_get(args->csound, args->hashTable,
+                              "stable") != (void*) 1)
+            args->missing++;
+    }
+    return 0;
+}
+
+/* a lookup on another thread must keep finding an existing key, and
+   must not touch freed memory, while the table grows under it */
+void test_cs_hash_table_grow_concurrent(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    CS_HASH_TABLE* hashTable = cs_hash_table_create(csound);
+    READER_ARGS args;
+    void* thread;
+    char buf[32];
+    int i;
+
+    cs_hash_table_put(csound, hashTable, "stable", (void*) 1);
+    args.csound = csound;
+    args.hashTable = hashTable;
+    args.done = 0;
+    args.missing = 0;
+    thread = csoundCreateThread(hash_table_reader, &args);
+    for (i = 0; i < BENCH_KEYS; i++) {
+        sprintf(buf, "opcode_%d", i);
+        cs_hash_table_put(csound, hashTable, buf, (void*)(intptr_t)(i + 2));
+    }
+    args.done = 1;
+    csoundJoinThread(thread);
+    CU_ASSERT_EQUAL(args.missing, 0);
+    CU_ASSERT_EQUAL(hashTable->count, BENCH_KEYS + 1);
+    cs_hash_table_free(csound, hashTable);
+    csoundDestroy(csound);
+}
+
 
 int main() {
     CU_pSuite pSuite = NULL;
@@ -167,7 +305,13 @@ int main() {
         (NULL == CU_add_test(pSuite, "Test cs_cons_append()", test_cs_cons_append)) ||
         (NULL == CU_add_test(pSuite, "Test cs_hash_table()", test_cs_hash_table)) ||
         (NULL == CU_add_test(pSuite, "Test cs_hash_table_merge()", test_cs_hash_table_merge)) ||
-        (NULL == CU_add_test(pSuite, "Test cs_hash_table_get_put_key()", test_cs_hash_table_get_put_key))) {
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table_get_put_key()", test_cs_hash_table_get_put_key)) ||
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table_create_interned()", test_cs_hash_table_interned)) ||
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table grow with a reader", test_cs_hash_table_grow_concurrent)) ||
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table grow and remove", test_cs_hash_table_grow)) ||
+        /* timing only: run it with CSOUND_BENCHMARK set */
+        (getenv("CSOUND_BENCHMARK") != NULL &&
+         NULL == CU_add_test(pSuite, "Benchmark cs_hash_table", test_cs_hash_table_benchmark))) {
         
         CU_cleanup_registry();
         return CU_get_error();
@@ -0,0 +1,100 @@
+#include "csound.h"
+#include <stdio.h>
+#include <CUnit/Basic.h>
+
+/* diskin2 reads through the refill pool when real-time audio is on;
+   the null rtaudio module gives that without a device */
+
+static const char *orc =
+    "sr = 44100\n"
+    "ksmps = 32\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "kcnt init 0\n"
+    "kcnt = kcnt + 1\n"
+    /* restart all three readers every 20 cycles */
+    "if kcnt % 20 == 0 then\n"
+    "  reinit again\n"
+    "endif\n"
+    "again:\n"
+    "aasync diskin2 \"../soak/flute.aiff\", 1, 0, 0, 0, 1, 0, 0, 0\n"
+    "aarr[] diskin2 \"../soak/flute.aiff\", 1, 0, 0, 0, 1, 0, 0, 0\n"
+    "async diskin2 \"../soak/flute.aiff\", 1, 0, 0, 0, 1, 0, 0, 1\n"
+    "rireturn\n"
+    "kd1 peak aasync - async\n"
+    "kd2 peak aarr[0] - async\n"
+    "kpk peak async\n"
+    "chnset kd1, \"diff\"\n"
+    "chnset kd2, \"diffarr\"\n"
+    "chnset kpk, \"peak\"\n"
+    "endin\n";
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+/* the streamed readers match the synchronous one across reinits, and
+   the pool is gone once the note has ended, so each reinit freed the
+   refill request of the file it closed */
+void test_async_matches_sync(void)
+{
+    CSOUND  *csound = csoundCreate(NULL);
+    int     err;
+
+    csoundSetOption(csound, "-odac");
+    csoundSetOption(csound, "-+rtaudio=null");
+    csoundSetOption(csound, "--realtime");
+    csoundSetOption(csound, "-m0");
+    err = csoundCompileOrc(csound, orc);
+    CU_ASSERT_EQUAL(err, 0);
+    csoundReadScore(csound, "i1 0 0.5\ne 1\n");
+    err = csoundStart(csound);
+    CU_ASSERT_EQUAL(err, 0);
+    while (csoundGetScoreTime(csound) < 0.6 &&
+           csoundPerformKsmps(csound) == 0)
+      ;
+    CU_ASSERT(csoundGetControlChannel(csound, "peak", NULL) > 0.01);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "diff", NULL), 0.0);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "diffarr", NULL), 0.0);
+    CU_ASSERT_PTR_NULL(csoundQueryGlobalVariable(csound, "DISKIN_POOL"));
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("diskin2 refill pool tests", init_suite1,
+                          clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Async matches sync across reinit",
+                             test_async_matches_sync))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <CUnit/Basic.h>
+#include "csound.h"
+
+#define BENCH_EVENTS 1000000
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+const char orc1[] =
+  "ksmps = 64\n"
+  "giorder init 0\n"
+  "  instr 1\n"
+  "giorder = giorder*10 + p4\n"
+  "chnset giorder, \"order\"\n"
+  "  endin\n"
+  "  instr 2\n"
+  "  endin\n";
+
+static CSOUND *create_csound(void)
+{
+    CSOUND *csound;
+
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "--logfile=null");
+    csoundCompileOrc(csound, orc1);
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+    return csound;
+}
+
+static void destroy_csound(CSOUND *csound)
+{
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+/* events due in the same k-cycle must start in submission order */
+void test_same_kcycle_order(void)
+{
+    CSOUND *csound = create_csound();
+    MYFLT  p[4] = { 1, 0.01, 0.01, 0 };
+    int    i;
+
+    for (i = 1; i <= 3; i++) {
+      p[3] = i;
+      CU_ASSERT(csoundScoreEvent(csound, 'i', p, 4) == 0);
+    }
+    p[1] = 0.005;                       /* earlier, submitted last */
+    p[3] = 4;
+    CU_ASSERT(csoundScoreEvent(csound, 'i', p, 4) == 0);
+    for (i = 0; i < 20; i++)
+      csoundPerformKsmps(csound);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "order", NULL),
+                           4123.0, 0.0001);
+    destroy_csound(csound);
+}
+
+/* line events sent during performance go through the queue too */
+void test_input_message(void)
+{
+    CSOUND *csound = create_csound();
+    int    i;
+
+    csoundPerformKsmps(csound);
+    csoundInputMessage(csound, "i 1 0 0.01 1\ni 1 0.005 0.01 2");
+    for (i = 0; i < 20; i++)
+      csoundPerformKsmps(csound);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "order", NULL),
+                           12.0, 0.0001);
+    destroy_csound(csound);
+}
+
+/* absolute events are queued with their own offset, not the current time */
+void test_absolute_event(void)
+{
+    CSOUND *csound = create_csound();
+    MYFLT  p[4] = { 1, 0.01, 0.01, 2 };
+    int    i;
+
+    for (i = 0; i < 10; i++)            /* about 0.0145 s */
+      csoundPerformKsmps(csound);
+    CU_ASSERT(csoundScoreEvent(csound, 'i', p, 4) == 0);
+    p[1] = 0;                           /* at 0.02 s, before the one above */
+    p[3] = 1;
+    CU_ASSERT(csoundScoreEventAbsolute(csound, 'i', p, 4, 0.02) == 0);
+    for (i = 0; i < 20; i++)
+      csoundPerformKsmps(csound);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "order", NULL),
+                           12.0, 0.0001);
+    destroy_csound(csound);
+}
+
+/* schedule 1M events at pseudo-random times and drain the queue */
+void test_schedule_1M_events(void)
+{
+    CSOUND  *csound = create_csound();
+    MYFLT   p[3] = { 2, 0, 0.001 };
+    clock_t t0, t1, t2;
+    int     i, err = 0;
+
+    srand(1234);
+    t0 = clock();
+    for (i = 0; i < BENCH_EVENTS; i++) {
+      p[1] = (MYFLT) (rand() % 100000) * 0.0001;
+      err |= csoundScoreEvent(csound, 'i', p, 3);
+    }
+    t1 = clock();
+    CU_ASSERT(err == 0);
+    while (csoundGetScoreTime(csound) < 10.1)
+      csoundPerformKsmps(csound);
+    t2 = clock();
+    printf("\n%d events: schedule %.3f s, perform %.3f s\n", BENCH_EVENTS,
+           (double) (t1 - t0) / CLOCKS_PER_SEC,
+           (double) (t2 - t1) / CLOCKS_PER_SEC);
+    destroy_csound(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("Realtime event queue tests",
+                          init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Same k-cycle order",
+                             test_same_kcycle_order))
+        || (NULL == CU_add_test(pSuite, "Input message",
+                                test_input_message))
+        || (NULL == CU_add_test(pSuite, "Absolute event",
+                                test_absolute_event))
+        /* timing only: run it with CSOUND_BENCHMARK set */
+        || (getenv("CSOUND_BENCHMARK") != NULL &&
+            NULL == CU_add_test(pSuite, "Schedule 1M events",
+                                test_schedule_1M_events))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
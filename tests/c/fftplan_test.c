@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <CUnit/Basic.h>
+#include "csoundCore.h"
+
+#define MAXSIZE     8192
+#define BENCH_WORK  20000000
+
+static CSOUND *csound;
+static MYFLT  x[MAXSIZE + 2], y[MAXSIZE + 2];
+
+/* powers of two, and mixed sizes with factors 3 and 5 */
+static const int sizes[] = {
+    2, 4, 6, 8, 10, 12, 30, 60, 64, 90, 96, 120, 240, 256, 480, 500,
+    1000, 1024, 1536, 2000, 4096, 6000, 8192
+};
+#define NSIZES ((int) (sizeof(sizes) / sizeof(sizes[0])))
+
+int init_suite1(void)
+{
+    int i;
+
+    csound = csoundCreate(0);
+    srand(1618);
+    for (i = 0; i < MAXSIZE; i++)
+      x[i] = (MYFLT) (rand() % 20001 - 10000) / FL(10000.0);
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    csoundDestroy(csound);
+    return 0;
+}
+
+/* forward plans give the DFT in the csoundRealFFT() layout, and inverse
+   plans undo them */
+void test_plans_match_dft(void)
+{
+    int     t, i, k;
+
+    for (t = 0; t < NSIZES; t++) {
+      int     N = sizes[t];
+      CSOUND_FFT_SETUP *f = csound->RealFFTSetup(csound, N, FFT_FWD);
+      CSOUND_FFT_SETUP *g = csound->RealFFTSetup(csound, N, FFT_INV);
+      double  maxerr = 0.0, peak = 0.0;
+
+      CU_ASSERT_PTR_NOT_NULL(f);
+      CU_ASSERT_PTR_NOT_NULL(g);
+      if (f == NULL || g == NULL) continue;
+      CU_ASSERT(csound->RealFFTSetup(csound, N, FFT_FWD) == f);
+      memcpy(y, x, N * sizeof(MYFLT));
+      csound->RealFFTExecute(csound, f, y);
+      for (k = 0; k <= N / 2; k++) {
+        double re = 0.0, im = 0.0, dre, dim;
+        for (i = 0; i < N; i++) {
+          double a = TWOPI * (double) ((long) k * i % N) / N;
+          re += x[i] * cos(a);
+          im -= x[i] * sin(a);
+        }
+        if (k == 0)
+          dre = y[0] - re, dim = 0.0;
+        else if (k == N / 2)
+          dre = y[1] - re, dim = 0.0;
+        else
+          dre = y[2 * k] - re, dim = y[2 * k + 1] - im;
+        if (fabs(dre) > maxerr) maxerr = fabs(dre);
+        if (fabs(dim) > maxerr) maxerr = fabs(dim);
+        if (fabs(re) > peak) peak = fabs(re);
+      }
+      CU_ASSERT(maxerr <= 1.0e-5 * peak);
+      csound->RealFFTExecute(csound, g, y);
+      maxerr = 0.0;
+      for (i = 0; i < N; i++)
+        if (fabs(y[i] - x[i]) > maxerr) maxerr = fabs(y[i] - x[i]);
+      CU_ASSERT(maxerr < 1.0e-5);
+    }
+}
+
+/* odd sizes, and halves with other prime factors, have no plan */
+void test_unsupported_sizes(void)
+{
+    CU_ASSERT_PTR_NULL(csound->RealFFTSetup(csound, 0, FFT_FWD));
+    CU_ASSERT_PTR_NULL(csound->RealFFTSetup(csound, 15, FFT_FWD));
+    CU_ASSERT_PTR_NULL(csound->RealFFTSetup(csound, 14, FFT_INV));
+    CU_ASSERT_PTR_NULL(csound->RealFFTSetup(csound, 2 * 1021, FFT_FWD));
+}
+
+#define NTHREADS    4
+
+static CSOUND *shared;
+
+/* threads that set up and run the same sizes at once, on an instance
+   with no plans yet, each get the round trip right */
+static uintptr_t plan_thread(void *data)
+{
+    MYFLT   a[MAXSIZE + 2];
+    int     it, i, *errors = (int*) data;
+
+    for (it = 0; it < 200; it++) {
+      int     N = sizes[NSIZES - 1 - it % 6];
+      CSOUND_FFT_SETUP *f = shared->RealFFTSetup(shared, N, FFT_FWD);
+      CSOUND_FFT_SETUP *g = shared->RealFFTSetup(shared, N, FFT_INV);
+
+      memcpy(a, x, N * sizeof(MYFLT));
+      shared->RealFFTExecute(shared, f, a);
+      shared->RealFFTExecute(shared, g, a);
+      for (i = 0; i < N; i++)
+        if (fabs(a[i] - x[i]) > 1.0e-4) {
+          (*errors)++;
+          break;
+        }
+    }
+    return 0;
+}
+
+void test_concurrent_plans(void)
+{
+    void    *thread[NTHREADS];
+    int     errors[NTHREADS] = { 0 }, i;
+
+    shared = csoundCreate(0);
+    for (i = 0; i < NTHREADS; i++)
+      thread[i] = csoundCreateThread(plan_thread, &errors[i]);
+    for (i = 0; i < NTHREADS; i++) {
+      csoundJoinThread(thread[i]);
+      CU_ASSERT_EQUAL(errors[i], 0);
+    }
+    csoundDestroy(shared);
+}
+
+static double ns_per_fft(clock_t t0, clock_t t1, int reps)
+{
+    return (double) (t1 - t0) * 1.0e9 / CLOCKS_PER_SEC / reps;
+}
+
+/* report ns per forward + inverse pair against the existing non power
+   of two code (mxfft.c), which uses a different layout; powers of two
+   are left out, as csoundRealFFT() runs them with plans */
+void test_benchmark(void)
+{
+    clock_t t0, t1;
+    int     t, i;
+
+    printf("\n%6s %12s %12s\n", "size", "plan", "np2");
+    for (t = 0; t < NSIZES; t++) {
+      int     N = sizes[t], reps = BENCH_WORK / N;
+      CSOUND_FFT_SETUP *f = csound->RealFFTSetup(csound, N, FFT_FWD);
+      CSOUND_FFT_SETUP *g = csound->RealFFTSetup(csound, N, FFT_INV);
+      double  tp, tn;
+
+      if (N < 64 || !(N & (N - 1))) continue;
+      memcpy(y, x, N * sizeof(MYFLT));
+      t0 = clock();
+      for (i = 0; i < reps; i++) {
+        csound->RealFFTExecute(csound, f, y);
+        csound->RealFFTExecute(csound, g, y);
+      }
+      t1 = clock();
+      tp = ns_per_fft(t0, t1, reps);
+      memcpy(y, x, N * sizeof(MYFLT));
+      y[N] = y[N + 1] = FL(0.0);
+      t0 = clock();
+      for (i = 0; i < reps; i++) {
+        csound->RealFFTnp2(csound, y, N);
+        csound->InverseRealFFTnp2(csound, y, N);
+      }
+      t1 = clock();
+      tn = ns_per_fft(t0, t1, reps);
+      printf("%6d %12.0f %12.0f\n", N, tp, tn);
+    }
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("Planned FFT tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Plans match DFT",
+                             test_plans_match_dft))
+        || (NULL == CU_add_test(pSuite, "Unsupported sizes",
+                                test_unsupported_sizes))
+        || (NULL == CU_add_test(pSuite, "Concurrent plans",
+                                test_concurrent_plans))
+        /* timing only: run it with CSOUND_BENCHMARK set */
+        || (getenv("CSOUND_BENCHMARK") != NULL &&
+            NULL == CU_add_test(pSuite, "Benchmark", test_benchmark))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
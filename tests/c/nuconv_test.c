@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <CUnit/Basic.h>
+#include "csound.h"
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+/* a 3 s random impulse response, convolved both ways */
+const char orc1[] =
+  "sr = 44100\n"
+  "ksmps = 64\n"
+  "nchnls = 2\n"
+  "0dbfs = 1\n"
+  "gir ftgen 1, 0, 131072, -21, 1, 0.01\n"
+  "  instr 1\n"
+  "ain rand 0.5\n"
+  "a1 ftconv ain, 1, 64\n"
+  "a2 nuconv ain, 1, 64\n"
+  "  outs a1, a2\n"
+  "  endin\n";
+
+/* nuconv must give ftconv's output, with the same latency */
+void test_nuconv_matches_ftconv(void)
+{
+    CSOUND  *csound;
+    MYFLT   *spout, maxdiff = 0, peak = 0;
+    int     i, n, nsmps;
+
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "--logfile=null");
+    CU_ASSERT(csoundCompileOrc(csound, orc1) == 0);
+    csoundReadScore(csound, "i1 0 10\n");
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+    nsmps = csoundGetKsmps(csound);
+    spout = csoundGetSpout(csound);
+    /* long enough for every level of the impulse response */
+    for (i = 0; i < 4000; i++) {
+      csoundPerformKsmps(csound);
+      for (n = 0; n < nsmps; n++) {
+        MYFLT d = spout[2*n] - spout[2*n+1];
+        if (d < 0) d = -d;
+        if (d > maxdiff) maxdiff = d;
+        if (spout[2*n] > peak) peak = spout[2*n];
+      }
+    }
+    CU_ASSERT(peak > 0.01);
+    CU_ASSERT(maxdiff < peak * 1.0e-5);
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("Non-uniform convolution tests",
+                          init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "nuconv matches ftconv",
+                             test_nuconv_matches_ftconv))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -79,6 +79,54 @@ void test_record(void)
     csound.Reset();
 }
 
+static void *send_events(void *pt)
+{
+    CsoundPerformanceThread *performanceThread = (CsoundPerformanceThread *) pt;
+    MYFLT p[3] = { 2, 0, 0.01 };
+
+    for (int i = 0; i < 2000; i++) {
+        performanceThread->ScoreEvent(0, 'i', 3, p);
+        if (i % 500 == 0)
+            performanceThread->FlushMessageQueue();
+    }
+    return NULL;
+}
+
+void test_message_burst(void)
+{
+    const char  *instrument =
+            "gicount init 0\n"
+            "instr 2 \n"
+            "gicount = gicount + 1\n"
+            "chnset gicount, \"count\"\n"
+            "endin \n";
+
+    Csound csound;
+    pthread_t threads[2];
+    csound.SetOption((char*)"-n");
+    csound.CompileOrc(instrument);
+    csound.ReadScore((char*)"f 0 36000\n");
+    csound.Start();
+    CsoundPerformanceThread performanceThread1(csound.GetCsound());
+    performanceThread1.Play();
+    // more events than the message ring holds, from two threads at once
+    for (int i = 0; i < 2; i++)
+        pthread_create(&threads[i], NULL, send_events, &performanceThread1);
+    for (int i = 0; i < 2; i++)
+        pthread_join(threads[i], NULL);
+    performanceThread1.FlushMessageQueue();
+#if !defined(__WINNT__)
+    sleep(1);
+#else
+    Sleep(1000);
+#endif
+    CU_ASSERT_EQUAL(csound.GetChannel("count"), 4000);
+    performanceThread1.Stop();
+    performanceThread1.Join();
+    csound.Cleanup();
+    csound.Reset();
+}
+
 int main()
 {
     CU_pSuite pSuite = NULL;
@@ -97,6 +145,7 @@ int main()
     /* add the tests to the suite */
     if ((NULL == CU_add_test(pSuite, "Test Record", test_record))
             || (NULL == CU_add_test(pSuite, "Test Performance Thread", test_perfthread))
+            || (NULL == CU_add_test(pSuite, "Test message burst", test_message_burst))
         )
     {
         CU_cleanup_registry();
@@ -0,0 +1,150 @@
+#include "csound.h"
+#include <stdio.h>
+#include <CUnit/Basic.h>
+
+#define NNOTES  6
+#define NCYCLES 300                     /* 3 seconds, all notes played */
+
+static const char *orc =
+    "sr = 1000\n"
+    "ksmps = 10\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "it times\n"
+    "chnset p4, sprintf(\"v%d\", p5)\n"
+    "chnset it, sprintf(\"t%d\", p5)\n"
+    "endin\n";
+
+/* three sections, the notes of each out of order, one of them warped;
+   p4 is random and p5 the number of the note */
+static const char *sco =
+    "i1 0.5 0.1 [~] 1\n"
+    "i1 0 0.1 [~] 0\n"
+    "s\n"
+    "t 0 120\n"
+    "i1 1 0.1 [~] 3\n"
+    "i1 0.5 0.1 [~] 2\n"
+    "s\n"
+    "i1 0.2 0.1 [~] 5\n"
+    "i1 0 0.1 [~] 4\n"
+    "f0 2\n"
+    "e\n";
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+static CSOUND *score_instance(int stream)
+{
+    CSOUND  *csound = csoundCreate(NULL);
+
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-m0");
+    if (stream)
+      csoundSetOption(csound, "--score-stream");
+    CU_ASSERT_EQUAL(csoundCompileOrc(csound, orc), 0);
+    CU_ASSERT_EQUAL(csoundReadScore(csound, sco), 0);
+    CU_ASSERT_EQUAL(csoundStart(csound), 0);
+    return csound;
+}
+
+/* play the score, and read back p4 and the start time of each note */
+static void play(CSOUND *csound, MYFLT *v, MYFLT *t)
+{
+    char    name[16];
+    int     i;
+
+    for (i = 0; i < NNOTES; i++) {
+      snprintf(name, sizeof(name), "v%d", i);
+      csoundSetControlChannel(csound, name, -1.0);
+      snprintf(name, sizeof(name), "t%d", i);
+      csoundSetControlChannel(csound, name, -1.0);
+    }
+    for (i = 0; i < NCYCLES && csoundPerformKsmps(csound) == 0; i++)
+      ;
+    for (i = 0; i < NNOTES; i++) {
+      snprintf(name, sizeof(name), "v%d", i);
+      v[i] = csoundGetControlChannel(csound, name, NULL);
+      snprintf(name, sizeof(name), "t%d", i);
+      t[i] = csoundGetControlChannel(csound, name, NULL);
+    }
+}
+
+/* a streamed score plays the same events, at the same times, as one
+   sorted whole */
+void test_stream_matches_whole(void)
+{
+    CSOUND  *whole = score_instance(0), *stream = score_instance(1);
+    MYFLT   v0[NNOTES], t0[NNOTES], v1[NNOTES], t1[NNOTES];
+    int     i;
+
+    play(whole, v0, t0);
+    play(stream, v1, t1);
+    for (i = 0; i < NNOTES; i++) {
+      CU_ASSERT(v0[i] >= 0.0 && v0[i] < 1.0);
+      CU_ASSERT_EQUAL(v1[i], v0[i]);
+      CU_ASSERT_EQUAL(t1[i], t0[i]);
+      if (i > 0)
+        CU_ASSERT(t0[i] > t0[i - 1]);
+    }
+    csoundDestroy(whole);
+    csoundDestroy(stream);
+}
+
+/* a rewound stream sorts its sections again with the same ~ values */
+void test_stream_rewind(void)
+{
+    CSOUND  *csound = score_instance(1);
+    MYFLT   v0[NNOTES], t0[NNOTES], v1[NNOTES], t1[NNOTES];
+    int     i;
+
+    play(csound, v0, t0);
+    csoundRewindScore(csound);
+    play(csound, v1, t1);
+    for (i = 0; i < NNOTES; i++) {
+      CU_ASSERT(v0[i] >= 0.0 && v0[i] < 1.0);
+      CU_ASSERT_EQUAL(v1[i], v0[i]);
+      CU_ASSERT_EQUAL(t1[i], t0[i]);
+    }
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("Score stream tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Stream matches whole score",
+                             test_stream_matches_whole))
+        || (NULL == CU_add_test(pSuite, "Rewind replays the stream",
+                                test_stream_rewind))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sndfile.h>
+#include <CUnit/Basic.h>
+#include "csound.h"
+
+#define NFRAMES 4000                    /* 0.5 seconds */
+
+static const char *orc =
+    "sr = 8000\n"
+    "ksmps = 16\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "a1 oscili 0.5, 441\n"
+    "out a1\n"
+    "endin\n";
+
+static char   dir[] = "/tmp/csound_sfwriter_XXXXXX";
+static char   plain[64], threaded[64];
+
+int init_suite1(void)
+{
+    if (mkdtemp(dir) == NULL)
+      return -1;
+    snprintf(plain, sizeof(plain), "%s/plain.wav", dir);
+    snprintf(threaded, sizeof(threaded), "%s/threaded.wav", dir);
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    unlink(plain);
+    unlink(threaded);
+    rmdir(dir);
+    return 0;
+}
+
+/* an instance with its messages kept, and options opt[] */
+static CSOUND *writer_instance(char **opt)
+{
+    CSOUND  *csound = csoundCreate(NULL);
+
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-m0");
+    csoundSetOption(csound, "-b64");
+    csoundSetOption(csound, "-B256");
+    while (*opt != NULL)
+      csoundSetOption(csound, *opt++);
+    CU_ASSERT_EQUAL(csoundCompileOrc(csound, orc), 0);
+    csoundReadScore(csound, "i1 0 0.5\n");
+    CU_ASSERT_EQUAL(csoundStart(csound), 0);
+    return csound;
+}
+
+/* drop the messages so far; 1 if one of them starts with s */
+static int find_message(CSOUND *csound, const char *s)
+{
+    int     found = 0;
+
+    while (csoundGetMessageCnt(csound) > 0) {
+      if (strncmp(csoundGetFirstMessage(csound), s, strlen(s)) == 0)
+        found = 1;
+      csoundPopFirstMessage(csound);
+    }
+    return found;
+}
+
+/* a write that fails on the writer thread is reported by sndwrterr() on
+   the performance thread, after the writer thread has been joined */
+void test_short_write(void)
+{
+    char    *opt[] = { "-o/dev/full", "-h", "--sf-writer=4", NULL };
+    CSOUND  *csound;
+    int     i, result = 0, joined = 0, reported = 0;
+
+    if (access("/dev/full", W_OK) != 0)
+      return;
+    csound = writer_instance(opt);
+    for (i = 0; i < NFRAMES / 16 && result == 0; i++) {
+      result = csoundPerformKsmps(csound);
+      while (csoundGetMessageCnt(csound) > 0) {
+        const char *m = csoundGetFirstMessage(csound);
+        if (strncmp(m, "writer thread:", 14) == 0)
+          joined = 1;
+        else if (strncmp(m, "soundfile write returned", 24) == 0)
+          reported = joined ? 1 : -1;
+        csoundPopFirstMessage(csound);
+      }
+    }
+    CU_ASSERT(result != 0);             /* ended by the error */
+    CU_ASSERT_EQUAL(joined, 1);
+    CU_ASSERT_EQUAL(reported, 1);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+/* render with opt[] to name, and return its frames in buf */
+static int render(char **opt, int threaded, const char *name,
+                  float *buf)
+{
+    CSOUND  *csound = writer_instance(opt);
+    SF_INFO info;
+    SNDFILE *sf;
+    int     n;
+
+    while (csoundPerformKsmps(csound) == 0)
+      ;
+    csoundCleanup(csound);
+    CU_ASSERT_EQUAL(find_message(csound, "writer thread:"), threaded);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+    memset(&info, 0, sizeof(SF_INFO));
+    if ((sf = sf_open(name, SFM_READ, &info)) == NULL)
+      return -1;
+    n = (int) sf_readf_float(sf, buf, NFRAMES + 1);
+    sf_close(sf);
+    return n;
+}
+
+/* with a writer thread and header rewrites at most every 50 ms, the
+   file has the same frames, and a header that counts them all */
+void test_rewrite_interval(void)
+{
+    static float a[NFRAMES + 1], b[NFRAMES + 1];
+    char    oplain[80], othreaded[80];
+    char    *opt1[] = { "-W", "-f", oplain, NULL };
+    char    *opt2[] = { "-W", "-f", othreaded, "--sf-writer=3",
+                        "--rewrite-interval=0.05", NULL };
+
+    snprintf(oplain, sizeof(oplain), "-o%s", plain);
+    snprintf(othreaded, sizeof(othreaded), "-o%s", threaded);
+    CU_ASSERT_EQUAL(render(opt1, 0, plain, a), NFRAMES);
+    CU_ASSERT_EQUAL(render(opt2, 1, threaded, b), NFRAMES);
+    CU_ASSERT_EQUAL(memcmp(a, b, NFRAMES * sizeof(float)), 0);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("Sound file writer thread tests", init_suite1,
+                          clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Short write", test_short_write))
+        || (NULL == CU_add_test(pSuite, "Rewrite interval",
+                                test_rewrite_interval))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sndfile.h>
+#include <CUnit/Basic.h>
+#include "csoundCore.h"
+
+#define NFRAMES     50000           /* more than one decoding chunk */
+#define NCHANNELS   2
+#define NTHREADS    4
+
+static char   dir[] = "/tmp/csound_sndcache_XXXXXX";
+static char   cachedir[64], wavname[64];
+static short  frames[NFRAMES * NCHANNELS];
+
+int init_suite1(void)
+{
+    SF_INFO info;
+    SNDFILE *sf;
+    int     i;
+
+    if (mkdtemp(dir) == NULL)
+      return -1;
+    snprintf(cachedir, sizeof(cachedir), "%s/cache", dir);
+    snprintf(wavname, sizeof(wavname), "%s/in.wav", dir);
+    for (i = 0; i < NFRAMES * NCHANNELS; i++)
+      frames[i] = (short) ((i * 7919) % 65536 - 32768);
+    memset(&info, 0, sizeof(SF_INFO));
+    info.samplerate = 44100;
+    info.channels = NCHANNELS;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+    if ((sf = sf_open(wavname, SFM_WRITE, &info)) == NULL)
+      return -1;
+    i = (sf_writef_short(sf, frames, NFRAMES) != NFRAMES);
+    sf_close(sf);
+    return i;
+}
+
+static void remove_dir(const char *name)
+{
+    char    path[512];
+    struct dirent *e;
+    DIR     *d = opendir(name);
+
+    if (d == NULL)
+      return;
+    while ((e = readdir(d)) != NULL) {
+      if (e->d_name[0] == '.')
+        continue;
+      snprintf(path, sizeof(path), "%s/%s", name, e->d_name);
+      unlink(path);
+    }
+    closedir(d);
+    rmdir(name);
+}
+
+int clean_suite1(void)
+{
+    remove_dir(cachedir);
+    unlink(wavname);
+    rmdir(dir);
+    return 0;
+}
+
+/* number of complete entries in the cache directory; a temporary file
+   left behind makes it -1 */
+static int count_entries(void)
+{
+    struct dirent *e;
+    DIR     *d = opendir(cachedir);
+    int     n = 0;
+
+    if (d == NULL)
+      return 0;
+    while ((e = readdir(d)) != NULL) {
+      const char *ext = strrchr(e->d_name, '.');
+      if (e->d_name[0] == '.')
+        continue;
+      if (ext == NULL || strcmp(ext, ".cssmp") != 0) {
+        n = -1;
+        break;
+      }
+      n++;
+    }
+    closedir(d);
+    return n;
+}
+
+static CSOUND *cache_instance(void)
+{
+    CSOUND  *csound = csoundCreate(0);
+    char    opt[96];
+
+    snprintf(opt, sizeof(opt), "--sample-cache=%s", cachedir);
+    csoundSetOption(csound, "-m0");
+    csoundSetOption(csound, opt);
+    return csound;
+}
+
+/* the frames of in.wav, loaded through the cache; 0 if they match */
+static int load_and_check(CSOUND *csound)
+{
+    SF_INFO info;
+    SNDMEMFILE *p;
+    int     i;
+
+    memset(&info, 0, sizeof(SF_INFO));
+    p = csound->LoadSoundFile(csound, wavname, &info);
+    if (p == NULL || p->nFrames != NFRAMES || p->nChannels != NCHANNELS)
+      return -1;
+    for (i = 0; i < NFRAMES * NCHANNELS; i++)
+      if (p->data[i] != (float) frames[i] / 32768.0f)
+        return -1;
+    return p->data[NFRAMES * NCHANNELS] == 0.0f ? 0 : -1;
+}
+
+/* the first instance builds the entry and the second maps it */
+void test_build_and_read_back(void)
+{
+    CSOUND  *a = cache_instance(), *b = cache_instance();
+
+    CU_ASSERT_EQUAL(load_and_check(a), 0);
+    CU_ASSERT_EQUAL(count_entries(), 1);
+    CU_ASSERT_EQUAL(load_and_check(b), 0);
+    CU_ASSERT_EQUAL(count_entries(), 1);
+    csoundDestroy(a);
+    csoundDestroy(b);
+}
+
+typedef struct {
+    CSOUND  *csound;
+    int     result;
+} LOAD_ARG;
+
+static uintptr_t load_thread(void *data)
+{
+    LOAD_ARG *arg = (LOAD_ARG*) data;
+
+    arg->result = load_and_check(arg->csound);
+    return 0;
+}
+
+/* instances of one process that miss at once each write a temporary
+   file of their own */
+void test_concurrent_build(void)
+{
+    CSOUND  *cs[NTHREADS];
+    void    *thread[NTHREADS];
+    LOAD_ARG arg[NTHREADS];
+    int     i;
+
+    remove_dir(cachedir);
+    for (i = 0; i < NTHREADS; i++) {
+      arg[i].result = -1;
+      arg[i].csound = cs[i] = cache_instance();
+    }
+    for (i = 0; i < NTHREADS; i++)
+      thread[i] = csoundCreateThread(load_thread, &arg[i]);
+    for (i = 0; i < NTHREADS; i++) {
+      csoundJoinThread(thread[i]);
+      CU_ASSERT_EQUAL(arg[i].result, 0);
+      csoundDestroy(cs[i]);
+    }
+    CU_ASSERT_EQUAL(count_entries(), 1);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("Sample cache tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Build and read back",
+                             test_build_and_read_back))
+        || (NULL == CU_add_test(pSuite, "Concurrent build",
+                                test_concurrent_build))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -134,6 +134,13 @@ def runTest():
 	["test_udo_2d_array.csd", "test udo with 2d-array"],
         ["test_udo_string_array_join.csd", "test udo with S[] arg returning S"],
         ["test_array_function_call.csd", "test synthesizing an array arg from a function-call"],
+        ["test_fused_expressions.csd", "test fused a-rate arithmetic against one op per statement"],
+        ["test_optimiser.csd", "test constant folding, common subexpressions and init-time hoisting"],
+        ["test_optimiser_reinit.csd", "test that reinit stops init-time hoisting"],
+        ["test_optimiser_loop.csd", "test that loop_lt stops init-time hoisting"],
+        ["test_aops_arate.csd", "test a-rate + - * / and int() against the same operators at k-rate"],
+        ["test_score_binary.csd", "test carry, ramps, +/^+, p references, strings and sections through the binary sorted score"],
+        ["test_score_text.csd", "test the same score through the text sorted score (--keep-sorted-score)"],
     ]
 
     arrayTests = [["arrays/arrays_i_local.csd", "local i[]"],